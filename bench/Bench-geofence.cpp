@@ -0,0 +1,397 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020  Christian Berger
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "geofence.hpp"
+#include "geofence-mapped-file.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Star-shaped ring with a wavy boundary, i.e., a typical mid-size fence.
+static std::vector<std::array<double,2>> makeFence(std::size_t vertices) {
+  std::vector<std::array<double,2>> polygon;
+  const double PI{3.14159265358979323846};
+  for(std::size_t i{0}; i < vertices; i++) {
+    const double phi{2.0 * PI * static_cast<double>(i) / static_cast<double>(vertices)};
+    const double r{10.0 + 2.0 * std::sin(7.0 * phi) + 0.5 * std::cos(31.0 * phi)};
+    polygon.push_back(std::array<double,2>{{r * std::cos(phi), r * std::sin(phi)}});
+  }
+  return polygon;
+}
+
+static double measure(const std::vector<std::array<double,2>> &points, const std::function<bool(const std::array<double,2>&)> &query) {
+  std::size_t hits{0};
+  const auto start = std::chrono::steady_clock::now();
+  for(const auto &p : points) {
+    hits += query(p) ? 1 : 0;
+  }
+  const auto stop = std::chrono::steady_clock::now();
+  const double ns{static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count())};
+  if (0 == hits) {
+    std::printf("(no hits)\n");
+  }
+  return ns / static_cast<double>(points.size());
+}
+
+int main() {
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<double> coordinate(-13.0, 13.0);
+  std::vector<std::array<double,2>> points(200000);
+  for(auto &p : points) {
+    p = std::array<double,2>{{coordinate(rng), coordinate(rng)}};
+  }
+
+  std::printf("%10s %18s %18s %18s\n", "vertices", "isIn [ns/query]", "chains [ns/query]", "triangles [ns/query]");
+  for(std::size_t vertices : {16, 64, 256, 1024, 5000}) {
+    auto polygon = makeFence(vertices);
+    geofence::MonotoneChainIndex<double> chains(polygon);
+    geofence::TriangleIndex<double> triangles(polygon);
+
+    const double crossing{measure(points, [&polygon](const std::array<double,2> &p) {
+      std::array<double,2> q{p};
+      return geofence::isIn<double>(polygon, q);
+    })};
+    const double chain{measure(points, [&chains](const std::array<double,2> &p) {
+      return chains.isIn(p);
+    })};
+    const double triangle{measure(points, [&triangles](const std::array<double,2> &p) {
+      return triangles.isIn(p);
+    })};
+    std::printf("%10zu %18.1f %18.1f %18.1f\n", vertices, crossing, chain, triangle);
+  }
+
+  // Random-order versus Hilbert-ordered batch against a large partition of zones.
+  std::vector<std::vector<std::array<double,2>>> zones;
+  const int ZONES{300};
+  for(int y{0}; y < ZONES; y++) {
+    for(int x{0}; x < ZONES; x++) {
+      const double x0{-13.0 + 26.0 * x / ZONES};
+      const double y0{-13.0 + 26.0 * y / ZONES};
+      const double size{26.0 / ZONES};
+      zones.push_back(std::vector<std::array<double,2>>{{{x0, y0}}, {{x0 + size, y0}}, {{x0 + size, y0 + size}}, {{x0, y0 + size}}});
+    }
+  }
+  geofence::PartitionIndex<double> partition(zones);
+  std::vector<std::array<double,2>> batch(2000000);
+  for(auto &p : batch) {
+    p = std::array<double,2>{{coordinate(rng), coordinate(rng)}};
+  }
+  std::vector<int32_t> results(batch.size());
+  const auto start = std::chrono::steady_clock::now();
+  for(std::size_t i{0}; i < batch.size(); i++) {
+    results[i] = partition.zone(batch[i]);
+  }
+  const auto middle = std::chrono::steady_clock::now();
+  geofence::queryBatch(batch, [&partition](const std::array<double,2> &p) {
+    return partition.zone(p);
+  }, results);
+  const auto stop = std::chrono::steady_clock::now();
+  std::printf("\n%d zones, %zu points: random order %.1f ns/query, Hilbert order %.1f ns/query\n", ZONES * ZONES, batch.size(),
+              static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(middle - start).count()) / static_cast<double>(batch.size()),
+              static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - middle).count()) / static_cast<double>(batch.size()));
+
+  // Plane sweep versus per-point chain lookups for one huge fence.
+  const auto huge = makeFence(1000000);
+  geofence::MonotoneChainIndex<double> hugeChains(huge);
+  const double chain{measure(batch, [&hugeChains](const std::array<double,2> &p) {
+    return hugeChains.isIn(p);
+  })};
+  geofence::SweepClassifier<double> sweep(huge);
+  std::vector<bool> inside;
+  const auto sweepStart = std::chrono::steady_clock::now();
+  sweep.classify(batch, inside);
+  const auto sweepStop = std::chrono::steady_clock::now();
+  std::printf("%zu vertices, %zu points: chains %.1f ns/query, sweep %.1f ns/query\n", huge.size(), batch.size(), chain,
+              static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(sweepStop - sweepStart).count()) / static_cast<double>(batch.size()));
+
+  // Parallel batch on all hardware threads.
+  geofence::ThreadPool pool;
+  std::vector<uint8_t> flags;
+  const auto parallelStart = std::chrono::steady_clock::now();
+  geofence::queryBatch(pool, batch, [&hugeChains](const std::array<double,2> &p) {
+    return hugeChains.isIn(p);
+  }, flags);
+  const auto parallelStop = std::chrono::steady_clock::now();
+  std::printf("%zu threads: chains %.1f ns/query\n", pool.size(),
+              static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(parallelStop - parallelStart).count()) / static_cast<double>(batch.size()));
+
+  // Tiled spatial join of the batch against many small fences.
+  std::vector<std::vector<std::array<double,2>>> fences;
+  std::uniform_real_distribution<double> radius(0.05, 0.5);
+  for(int f{0}; f < 10000; f++) {
+    const std::array<double,2> center{{coordinate(rng), coordinate(rng)}};
+    auto fence = makeFence(32);
+    const double scale{radius(rng) / 10.0};
+    for(auto &v : fence) {
+      v = std::array<double,2>{{center[0] + v[0] * scale, center[1] + v[1] * scale}};
+    }
+    fences.push_back(fence);
+  }
+  using Join = geofence::SpatialJoin<double>;
+  const std::pair<Join::Engine, const char*> engines[]{{Join::Engine::BOXES, "boxes"}, {Join::Engine::TREE, "tree"}, {Join::Engine::SWEEP, "sweep"}};
+  for(const auto &engine : engines) {
+    Join join(fences, engine.first);
+    geofence::JoinPairs pairs;
+    const auto joinStart = std::chrono::steady_clock::now();
+    join.join(pool, batch, pairs);
+    const auto joinStop = std::chrono::steady_clock::now();
+    std::printf("%zu fences, %zu points, %s: %zu pairs, %.1f ns/point\n", fences.size(), batch.size(), engine.second, pairs.size(),
+                static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(joinStop - joinStart).count()) / static_cast<double>(batch.size()));
+  }
+  Join counting(fences, Join::Engine::SWEEP);
+  std::vector<uint64_t> counts;
+  const auto countStart = std::chrono::steady_clock::now();
+  counting.count(pool, batch, counts);
+  const auto countStop = std::chrono::steady_clock::now();
+  std::printf("%zu fences, %zu points, sweep, counting only: %.1f ns/point\n", fences.size(), batch.size(),
+              static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(countStop - countStart).count()) / static_cast<double>(batch.size()));
+
+  // Fences inserted one at a time versus the same fences bulk-loaded into one tree.
+  geofence::DynamicFenceIndex<double> dynamic;
+  const auto insertStart = std::chrono::steady_clock::now();
+  for(const auto &fence : fences) {
+    dynamic.insert(fence);
+  }
+  const auto insertStop = std::chrono::steady_clock::now();
+  geofence::SpatialJoin<double> bulk(fences, Join::Engine::TREE, 1);
+  std::vector<std::array<double,2>> probes(batch.begin(), batch.begin() + 200000);
+  const double incremental{measure(probes, [&dynamic](const std::array<double,2> &p) {
+    return !dynamic.query(p).empty();
+  })};
+  geofence::ThreadPool single(1);
+  geofence::JoinPairs bulkPairs;
+  const auto bulkStart = std::chrono::steady_clock::now();
+  bulk.join(single, probes, bulkPairs);
+  const auto bulkStop = std::chrono::steady_clock::now();
+  std::printf("%zu fences inserted in %.1f us/fence in %zu levels: %.1f ns/query, bulk-loaded tree %.1f ns/query\n", fences.size(),
+              static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(insertStop - insertStart).count()) / 1000.0 / static_cast<double>(fences.size()),
+              dynamic.levels(), incremental,
+              static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(bulkStop - bulkStart).count()) / static_cast<double>(probes.size()));
+
+  // Startup from a memory-mapped fence store versus building the index.
+  const std::vector<uint8_t> stored{geofence::FenceStore::build(fences)};
+  const std::string path{"geofence-bench.bin"};
+  {
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(stored.data()), static_cast<std::streamsize>(stored.size()));
+  }
+  const auto mapStart = std::chrono::steady_clock::now();
+  geofence::MappedFile mapped(path);
+  const geofence::FenceStore store(mapped.data(), mapped.size());
+  const auto mapStop = std::chrono::steady_clock::now();
+  const double inPlace{measure(probes, [&store](const std::array<double,2> &p) {
+    return !store.query(p).empty();
+  })};
+  std::printf("%zu fences, %zu bytes: mapped in %.1f us, %.1f ns/query\n", store.size(), mapped.size(),
+              static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(mapStop - mapStart).count()) / 1000.0, inPlace);
+  std::remove(path.c_str());
+
+  // GeoJSON ingestion into a reused arena; coordinates as written by GIS tools.
+  std::string json{"{\"type\": \"FeatureCollection\", \"features\": [\n"};
+  for(std::size_t i{0}; i < fences.size(); i++) {
+    json += (0 == i) ? "" : ",\n";
+    json += "{\"type\": \"Feature\", \"properties\": {\"name\": \"fence " + std::to_string(i) + "\", \"tags\": [1, 2, 3]}, ";
+    json += "\"geometry\": {\"type\": \"Polygon\", \"coordinates\": [[";
+    for(std::size_t k{0}; k <= fences[i].size(); k++) {
+      char position[64];
+      const auto &v = fences[i][k % fences[i].size()];
+      std::snprintf(position, sizeof(position), "%s[%.7f, %.7f]", (0 == k) ? "" : ", ", v[0], v[1]);
+      json += position;
+    }
+    json += "]]}}";
+  }
+  json += "\n]}\n";
+  geofence::RingArena<double> arena;
+  std::size_t polygons{0};
+  const auto readStart = std::chrono::steady_clock::now();
+  for(uint32_t repetition{0}; repetition < 10; repetition++) {
+    geofence::readGeoJson(json.data(), json.size(), arena, [&polygons](geofence::RingArena<double> &a) {
+      polygons += a.polygons();
+      a.clear();
+    });
+  }
+  const auto readStop = std::chrono::steady_clock::now();
+  std::printf("GeoJSON, %zu bytes, %zu polygons: %.0f MB/s\n", json.size(), polygons / 10,
+              10.0 * static_cast<double>(json.size()) / static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(readStop - readStart).count()));
+
+  // WKB fences as views over the buffer versus copied into vectors.
+  std::vector<geofence::Polygon> exported(fences.size());
+  for(std::size_t i{0}; i < fences.size(); i++) {
+    exported[i].outer = fences[i];
+  }
+  const std::vector<uint8_t> wkb{geofence::writeWkb(exported)};
+  const auto viewStart = std::chrono::steady_clock::now();
+  const std::vector<geofence::WkbPolygon> views{geofence::readWkb(wkb.data(), wkb.size())};
+  const auto viewStop = std::chrono::steady_clock::now();
+  std::vector<std::vector<std::array<double,2>>> copies;
+  for(const auto &view : views) {
+    copies.push_back(view.rings[0].copy());
+  }
+  const auto copyStop = std::chrono::steady_clock::now();
+  const double viewed{measure(probes, [&views](const std::array<double,2> &p) {
+    return geofence::isIn(views[0], p);
+  })};
+  const double copied{measure(probes, [&copies](const std::array<double,2> &p) {
+    std::array<double,2> q{p};
+    return geofence::isIn<double>(copies[0], q);
+  })};
+  std::printf("WKB, %zu bytes: views in %.1f ms, copies in %.1f ms more; %.1f ns/query on a view, %.1f ns/query on a copy\n", wkb.size(),
+              static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(viewStop - viewStart).count()) / 1000.0,
+              static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(copyStop - viewStop).count()) / 1000.0, viewed, copied);
+
+  // 200k small fences, each in its own heap block versus packed into one arena.
+  const std::size_t SMALL{200000};
+  auto elapsed = [](std::chrono::steady_clock::time_point from) {
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - from).count()) / 1000.0;
+  };
+  std::array<std::array<double,2>,16> circle;
+  for(uint32_t k{0}; k < 16; k++) {
+    circle[k] = {std::cos(static_cast<double>(k) * 0.3926990817), std::sin(static_cast<double>(k) * 0.3926990817)};
+  }
+  auto fill = [&circle](std::size_t f, geofence::ArenaRing<double> &ring) {
+    ring.reserve(circle.size());
+    for(const auto &c : circle) {
+      ring.push_back({static_cast<double>(f % 1000) + c[0], static_cast<double>(f / 1000) + c[1]});
+    }
+  };
+  double loadTimes[2];
+  double freeTimes[2];
+  double scanTimes[2];
+  for(uint32_t packed{0}; packed < 2; packed++) {
+    geofence::MonotonicArena fenceArena(1 << 20);
+    const auto loadStart = std::chrono::steady_clock::now();
+    std::vector<geofence::ArenaRing<double>> small;
+    small.reserve(SMALL);
+    for(std::size_t f{0}; f < SMALL; f++) {
+      small.emplace_back(1 == packed ? static_cast<geofence::MemoryResource*>(&fenceArena) : geofence::newDeleteResource());
+      fill(f, small.back());
+    }
+    loadTimes[packed] = elapsed(loadStart);
+    const auto scanStart = std::chrono::steady_clock::now();
+    std::size_t hits{0};
+    for(uint32_t repetition{0}; repetition < 10; repetition++) {
+      std::array<double,2> p{{500.1 + repetition, 100.2}};
+      for(auto &ring : small) {
+        hits += geofence::isIn<double>(ring, p) ? 1 : 0;
+      }
+    }
+    scanTimes[packed] = elapsed(scanStart) / 10.0;
+    const auto freeStart = std::chrono::steady_clock::now();
+    small.clear();
+    fenceArena.release();
+    freeTimes[packed] = elapsed(freeStart);
+    if (10 != hits) {
+      std::printf("unexpected hits: %zu\n", hits);
+    }
+  }
+  std::printf("%zu fences, heap: load %.1f ms, scan %.1f ms, free %.1f ms; arena: load %.1f ms, scan %.1f ms, free %.1f ms\n", SMALL,
+              loadTimes[0], scanTimes[0], freeTimes[0], loadTimes[1], scanTimes[1], freeTimes[1]);
+
+  // Full scans of the huge fence, uncompressed versus bit-packed on a grid.
+  std::vector<std::array<double,2>> few(batch.begin(), batch.begin() + 500);
+  std::vector<std::array<double,2>> hugeCopy{huge};
+  const double plain{measure(few, [&hugeCopy](const std::array<double,2> &p) {
+    std::array<double,2> q{p};
+    return geofence::isIn<double>(hugeCopy, q);
+  })};
+  for(uint32_t bits : {16u, 24u}) {
+    const geofence::CompressedPolygon<double> packed(huge, bits);
+    const double compressedTime{measure(few, [&packed](const std::array<double,2> &p) {
+      return packed.isIn(p);
+    })};
+    std::printf("%zu vertices, %u bits: %.1fx smaller, %.1f us/query versus %.1f us/query uncompressed\n", huge.size(), bits,
+                static_cast<double>(huge.size() * sizeof(std::array<double,2>)) / static_cast<double>(packed.bytes()), compressedTime / 1000.0, plain / 1000.0);
+  }
+
+  // Raster with exact fallback on boundary pixels versus chain lookups for the huge fence.
+  const auto rasterStart = std::chrono::steady_clock::now();
+  const geofence::RasterIndex<double> raster(huge, 12, 2);
+  const double rasterBuild{elapsed(rasterStart)};
+  std::size_t resolved{0};
+  for(const auto &p : batch) {
+    resolved += raster.isResolved(p) ? 1 : 0;
+  }
+  const double rasterTime{measure(batch, [&raster](const std::array<double,2> &p) {
+    return raster.isIn(p);
+  })};
+  std::printf("%zu vertices, raster: %.1f ns/query versus chains %.1f ns/query, %.2f%% single loads, %.1f MB, %zu tiles, built in %.0f ms\n", huge.size(),
+              rasterTime, chain, 100.0 * static_cast<double>(resolved) / static_cast<double>(batch.size()),
+              static_cast<double>(raster.bytes()) / (1024.0 * 1024.0), raster.tiles(), rasterBuild);
+
+  // Cell covering with quantized boundary edges: query time and storage per cell.
+  for(std::size_t vertices : {5000, 50000}) {
+    const geofence::CellCovering<double> covering(makeFence(vertices));
+    const double coveringTime{measure(points, [&covering](const std::array<double,2> &p) {
+      return covering.isIn(p);
+    })};
+    std::printf("%zu vertices, cell covering: %.1f ns/query, %zu cells (%zu boundary, %zu quantized), %.1f bytes/cell\n", vertices, coveringTime,
+                covering.size(), covering.boundaryCells(), covering.quantizedCells(),
+                static_cast<double>(covering.bytes()) / static_cast<double>(covering.size()));
+  }
+
+  // Inside test plus a separate nearest-edge pass versus the fused, batched, and chain-indexed signed distances.
+  auto fence = makeFence(5000);
+  std::vector<double> xs;
+  std::vector<double> ys;
+  for(std::size_t i{0}; i < 20000; i++) {
+    xs.push_back(points[i][0]);
+    ys.push_back(points[i][1]);
+  }
+  std::vector<double> distances(xs.size());
+  const auto twoPassStart = std::chrono::steady_clock::now();
+  for(std::size_t i{0}; i < xs.size(); i++) {
+    std::array<double,2> p{{xs[i], ys[i]}};
+    double nearest{std::numeric_limits<double>::infinity()};
+    for(std::size_t k{0}; k < fence.size(); k++) {
+      nearest = (std::min)(nearest, std::sqrt(geofence::detail::squaredDistance(p, fence[k], fence[(k + 1) % fence.size()])));
+    }
+    distances[i] = geofence::isIn<double>(fence, p) ? -nearest : nearest;
+  }
+  const double twoPass{elapsed(twoPassStart) * 1e6 / static_cast<double>(xs.size())};
+  const auto fusedStart = std::chrono::steady_clock::now();
+  for(std::size_t i{0}; i < xs.size(); i++) {
+    distances[i] = geofence::signedDistance(fence, std::array<double,2>{{xs[i], ys[i]}});
+  }
+  const double fused{elapsed(fusedStart) * 1e6 / static_cast<double>(xs.size())};
+  const auto batchStart = std::chrono::steady_clock::now();
+  geofence::signedDistances(fence, xs.data(), ys.data(), xs.size(), distances.data());
+  const double batched{elapsed(batchStart) * 1e6 / static_cast<double>(xs.size())};
+  const geofence::MonotoneChainIndex<double> fenceChains(fence);
+  const auto indexedStart = std::chrono::steady_clock::now();
+  for(std::size_t i{0}; i < xs.size(); i++) {
+    distances[i] = fenceChains.signedDistance(std::array<double,2>{{xs[i], ys[i]}});
+  }
+  const double indexed{elapsed(indexedStart) * 1e6 / static_cast<double>(xs.size())};
+  std::printf("%zu vertices, signed distance: two passes %.0f ns/query, fused %.0f ns/query, batch %.0f ns/query, chains %.0f ns/query\n",
+              fence.size(), twoPass, fused, batched, indexed);
+  return 0;
+}
@@ -0,0 +1,124 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020  Christian Berger
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Optional companion of geofence.hpp to load a FenceStore from a file. It is
+// kept apart so that geofence.hpp itself depends on the C++ standard library
+// only.
+
+#ifndef GEOFENCE_MAPPED_FILE_HPP
+#define GEOFENCE_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace geofence {
+
+/**
+ * Read-only view of a whole file, e.g., a fence store shared by several
+ * processes through the page cache. The file is memory-mapped on POSIX
+ * systems and read into memory elsewhere; the interface is the same.
+ */
+class MappedFile {
+ public:
+  /**
+   * @param path of the file to map
+   * @throws std::runtime_error if the file cannot be opened or mapped
+   */
+  explicit MappedFile(const std::string &path)
+    : m_data{nullptr}
+    , m_size{0}
+    , m_copy{} {
+#if defined(__unix__) || defined(__APPLE__)
+    const int fd{::open(path.c_str(), O_RDONLY)};
+    if (fd < 0) {
+      throw std::runtime_error("geofence::MappedFile: cannot open " + path);
+    }
+    struct stat status;
+    if ((0 != ::fstat(fd, &status)) || (status.st_size <= 0)) {
+      ::close(fd);
+      throw std::runtime_error("geofence::MappedFile: cannot stat " + path);
+    }
+    m_size = static_cast<std::size_t>(status.st_size);
+    void *data{::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0)};
+    ::close(fd);
+    if (MAP_FAILED == data) {
+      throw std::runtime_error("geofence::MappedFile: cannot map " + path);
+    }
+    m_data = data;
+#else
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+      throw std::runtime_error("geofence::MappedFile: cannot open " + path);
+    }
+    const std::streamoff size{file.tellg()};
+    if (size <= 0) {
+      throw std::runtime_error("geofence::MappedFile: cannot stat " + path);
+    }
+    // 64-bit words keep the copy aligned for FenceStore.
+    m_copy.resize((static_cast<std::size_t>(size) + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(m_copy.data()), size)) {
+      throw std::runtime_error("geofence::MappedFile: cannot read " + path);
+    }
+    m_data = m_copy.data();
+    m_size = static_cast<std::size_t>(size);
+#endif
+  }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  ~MappedFile() {
+#if defined(__unix__) || defined(__APPLE__)
+    ::munmap(const_cast<void*>(m_data), m_size);
+#endif
+  }
+
+  const void *data() const {
+    return m_data;
+  }
+
+  std::size_t size() const {
+    return m_size;
+  }
+
+ private:
+  const void *m_data;
+  std::size_t m_size;
+  std::vector<uint64_t> m_copy; // file contents where memory mapping is unavailable
+};
+
+}
+#endif
@@ -25,14 +25,41 @@
 #ifndef GEOFENCE_HPP
 #define GEOFENCE_HPP
 
+#include <cctype>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
 #include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
 #include <type_traits>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+// std::array is only usable in constant expressions since C++14.
+#if (__cplusplus >= 201402L) || (defined(_MSVC_LANG) && _MSVC_LANG >= 201402L)
+#define GEOFENCE_CONSTEXPR constexpr
+#else
+#define GEOFENCE_CONSTEXPR inline
+#endif
+
 namespace geofence {
 
 /**
@@ -53,13 +80,228 @@ inline bool isEqual(T a, T b) {
 #pragma GCC diagnostic pop
 }
 
+/**
+ * Source of memory for PolymorphicAllocator, modeled after C++17's
+ * std::pmr::memory_resource for use with C++11.
+ */
+class MemoryResource {
+ public:
+  virtual ~MemoryResource() = default;
+
+  /**
+   * @param bytes number of bytes to allocate
+   * @param alignment power of two
+   * @return memory for bytes
+   * @throws std::bad_alloc if no memory is available
+   */
+  void *allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t)) {
+    return doAllocate(bytes, alignment);
+  }
+
+  void deallocate(void *p, std::size_t bytes, std::size_t alignment = alignof(std::max_align_t)) {
+    doDeallocate(p, bytes, alignment);
+  }
+
+  /**
+   * @return true if memory allocated from this can be deallocated through other and vice versa
+   */
+  bool isEqual(const MemoryResource &other) const {
+    return (this == &other) || doIsEqual(other);
+  }
+
+ private:
+  virtual void *doAllocate(std::size_t bytes, std::size_t alignment) = 0;
+  virtual void doDeallocate(void *p, std::size_t bytes, std::size_t alignment) = 0;
+  virtual bool doIsEqual(const MemoryResource &other) const = 0;
+};
+
+namespace detail {
+
+class NewDeleteResource : public MemoryResource {
+ private:
+  void *doAllocate(std::size_t bytes, std::size_t alignment) override {
+    if (alignof(std::max_align_t) < alignment) {
+      throw std::bad_alloc();
+    }
+    return ::operator new(bytes);
+  }
+
+  void doDeallocate(void *p, std::size_t, std::size_t) override {
+    ::operator delete(p);
+  }
+
+  bool doIsEqual(const MemoryResource &other) const override {
+    return nullptr != dynamic_cast<const NewDeleteResource*>(&other);
+  }
+};
+
+}
+
+/**
+ * @return resource using global operator new and delete; used by default
+ */
+inline MemoryResource *newDeleteResource() {
+  static detail::NewDeleteResource resource;
+  return &resource;
+}
+
+/**
+ * Resource that hands out memory from large chunks by advancing a pointer and
+ * frees everything at once in release() or on destruction; deallocate() is a
+ * no-op. Allocating all rings of a fence set from one arena packs their
+ * vertices next to each other and makes dropping the set a handful of frees.
+ * Not thread-safe.
+ */
+class MonotonicArena : public MemoryResource {
+ public:
+  /**
+   * @param chunk size of the first chunk in bytes; later chunks double in size
+   * @param upstream resource providing the chunks
+   */
+  explicit MonotonicArena(std::size_t chunk = 64 * 1024, MemoryResource *upstream = newDeleteResource())
+    : m_upstream{upstream}
+    , m_chunks{}
+    , m_current{nullptr}
+    , m_remaining{0}
+    , m_next{(std::max)(chunk, std::size_t{64})}
+    , m_used{0} {
+  }
+
+  MonotonicArena(const MonotonicArena &) = delete;
+  MonotonicArena &operator=(const MonotonicArena &) = delete;
+
+  ~MonotonicArena() override {
+    release();
+  }
+
+  /**
+   * Returns all chunks to the upstream resource; memory handed out before becomes invalid.
+   */
+  void release() {
+    for(const auto &chunk : m_chunks) {
+      m_upstream->deallocate(chunk.first, chunk.second);
+    }
+    m_chunks.clear();
+    m_current = nullptr;
+    m_remaining = 0;
+    m_used = 0;
+  }
+
+  /**
+   * @return number of bytes handed out since construction or release()
+   */
+  std::size_t used() const {
+    return m_used;
+  }
+
+  /**
+   * @return number of chunks obtained from the upstream resource
+   */
+  std::size_t chunks() const {
+    return m_chunks.size();
+  }
+
+ private:
+  void *doAllocate(std::size_t bytes, std::size_t alignment) override {
+    std::size_t padding{(alignment - reinterpret_cast<std::uintptr_t>(m_current) % alignment) % alignment};
+    if (m_remaining < bytes || m_remaining - bytes < padding) {
+      const std::size_t size{(std::max)(m_next, bytes + alignment)};
+      m_current = static_cast<uint8_t*>(m_upstream->allocate(size));
+      m_chunks.push_back(std::make_pair(static_cast<void*>(m_current), size));
+      m_remaining = size;
+      m_next = size * 2;
+      padding = (alignment - reinterpret_cast<std::uintptr_t>(m_current) % alignment) % alignment;
+    }
+    uint8_t *p{m_current + padding};
+    m_current = p + bytes;
+    m_remaining -= padding + bytes;
+    m_used += bytes;
+    return p;
+  }
+
+  void doDeallocate(void *, std::size_t, std::size_t) override {
+  }
+
+  bool doIsEqual(const MemoryResource &) const override {
+    return false;
+  }
+
+ private:
+  MemoryResource *m_upstream;
+  std::vector<std::pair<void*, std::size_t>> m_chunks;
+  uint8_t *m_current;
+  std::size_t m_remaining;
+  std::size_t m_next;
+  std::size_t m_used;
+};
+
+/**
+ * Allocator drawing from a MemoryResource, modeled after C++17's
+ * std::pmr::polymorphic_allocator; containers using it have the same type
+ * whatever resource they use. Copies of a container keep the resource.
+ */
+template <typename T>
+class PolymorphicAllocator {
+ public:
+  using value_type = T;
+
+  PolymorphicAllocator() noexcept
+    : m_resource{newDeleteResource()} {
+  }
+
+  PolymorphicAllocator(MemoryResource *resource) noexcept
+    : m_resource{resource} {
+  }
+
+  template <typename U>
+  PolymorphicAllocator(const PolymorphicAllocator<U> &other) noexcept
+    : m_resource{other.resource()} {
+  }
+
+  T *allocate(std::size_t n) {
+    if ((std::numeric_limits<std::size_t>::max)() / sizeof(T) < n) {
+      throw std::bad_alloc();
+    }
+    return static_cast<T*>(m_resource->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T *p, std::size_t n) {
+    m_resource->deallocate(p, n * sizeof(T), alignof(T));
+  }
+
+  MemoryResource *resource() const {
+    return m_resource;
+  }
+
+ private:
+  MemoryResource *m_resource;
+};
+
+template <typename T, typename U>
+inline bool operator==(const PolymorphicAllocator<T> &a, const PolymorphicAllocator<U> &b) {
+  return a.resource()->isEqual(*b.resource());
+}
+
+template <typename T, typename U>
+inline bool operator!=(const PolymorphicAllocator<T> &a, const PolymorphicAllocator<U> &b) {
+  return !(a == b);
+}
+
+/**
+ * Ring whose vertices live in a MemoryResource, e.g., a MonotonicArena shared
+ * by a whole fence set; usable with isIn and getConvexHull.
+ */
+template <typename T>
+using ArenaRing = std::vector<std::array<T,2>, PolymorphicAllocator<std::array<T,2>>>;
+
 /**
  * Compute convex hull using Andrew's monotone chain algorithm.
  * @param polygon
- * @return convex hull
+ * @param temporaries resource for the sorted copy and the half hulls, e.g., a MonotonicArena reused across calls; nullptr for new and delete
+ * @return convex hull, using the polygon's allocator
  */
-template <typename T>
-inline std::vector<std::array<T,2>> getConvexHull(const std::vector<std::array<T,2>> &polygon) {
+template <typename T, typename Allocator = std::allocator<std::array<T,2>>>
+inline std::vector<std::array<T,2>, Allocator> getConvexHull(const std::vector<std::array<T,2>, Allocator> &polygon, MemoryResource *temporaries = nullptr) {
   static_assert(std::is_arithmetic<T>::value, "T must be an arithmetic type");
 
   // Inspired by: https://en.wikibooks.org/wiki/Algorithm_Implementation/Geometry/Convex_hull/Monotone_chain#C++ 
@@ -76,11 +318,14 @@ inline std::vector<std::array<T,2>> getConvexHull(const std::vector<std::array<T
 	  return (b[X] - a[X]) * (c[Y] - a[Y]) - (b[Y] - a[Y]) * (c[X] - a[X]);
   };
 
-  auto sortedPolygon{polygon};
+  using Temporary = std::vector<std::array<T,2>, PolymorphicAllocator<std::array<T,2>>>;
+  const PolymorphicAllocator<std::array<T,2>> allocator{(nullptr != temporaries) ? temporaries : newDeleteResource()};
+  Temporary sortedPolygon(polygon.begin(), polygon.end(), allocator);
   std::sort(sortedPolygon.begin(), sortedPolygon.end(), isLeft);
 
   // Construct lower half of convex hull.
-  std::vector<std::array<T,2>> lowerHalf;
+  Temporary lowerHalf(allocator);
+  lowerHalf.reserve(sortedPolygon.size());
   for(auto it{sortedPolygon.begin()}; it != sortedPolygon.end(); ++it) {
     while(lowerHalf.size() >= 2 && !(ccw(*(lowerHalf.rbegin()+1), *(lowerHalf.rbegin()), *it) < 0)) {
       lowerHalf.pop_back();
@@ -89,7 +334,8 @@ inline std::vector<std::array<T,2>> getConvexHull(const std::vector<std::array<T
   }
 
   // Construct upper half of convex hull.
-  std::vector<std::array<T,2>> upperHalf;
+  Temporary upperHalf(allocator);
+  upperHalf.reserve(sortedPolygon.size());
   for(auto it{sortedPolygon.rbegin()}; it != sortedPolygon.rend(); ++it) {
     while(upperHalf.size() >= 2 && !(ccw(*(upperHalf.rbegin()+1), *(upperHalf.rbegin()), *it) < 0)) {
       upperHalf.pop_back();
@@ -97,42 +343,6521 @@ inline std::vector<std::array<T,2>> getConvexHull(const std::vector<std::array<T
     upperHalf.push_back(*it);
   }
 
-  std::vector<std::array<T,2>> convexHull;
+  std::vector<std::array<T,2>, Allocator> convexHull(polygon.get_allocator());
 	convexHull.insert(convexHull.end(), lowerHalf.begin(), lowerHalf.end());
 	convexHull.insert(convexHull.end(), upperHalf.begin() + 1, upperHalf.end() - 1);
   return convexHull;
 }
 
+namespace detail {
+
+/**
+ * Type to evaluate products of coordinates without overflow.
+ */
+template <typename T>
+struct Wide {
+  using type = typename std::conditional<std::is_floating_point<T>::value, typename std::common_type<T, double>::type, int64_t>::type;
+};
+
+/**
+ * @param a
+ * @param b
+ * @param p
+ * @return positive if p is left of the directed line from a to b, negative if right, and zero if on it
+ */
+template <typename T>
+GEOFENCE_CONSTEXPR typename Wide<T>::type orientation(const std::array<T,2> &a, const std::array<T,2> &b, const std::array<T,2> &p) {
+  return (static_cast<typename Wide<T>::type>(b[0]) - static_cast<typename Wide<T>::type>(a[0])) * (static_cast<typename Wide<T>::type>(p[1]) - static_cast<typename Wide<T>::type>(a[1]))
+       - (static_cast<typename Wide<T>::type>(p[0]) - static_cast<typename Wide<T>::type>(a[0])) * (static_cast<typename Wide<T>::type>(b[1]) - static_cast<typename Wide<T>::type>(a[1]));
+}
+
+/**
+ * @param ring vertices of a closed ring
+ * @return twice the signed area of ring, positive if counter-clockwise
+ */
+template <typename T>
+inline double signedArea2(const std::vector<std::array<T,2>> &ring) {
+  constexpr const uint8_t X{0};
+  constexpr const uint8_t Y{1};
+  double area{0};
+  const std::size_t POINTS{ring.size()};
+  for(std::size_t i{0}, j{POINTS - 1}; i < POINTS; j = i++) {
+    area += static_cast<double>(ring[j][X]) * static_cast<double>(ring[i][Y]) - static_cast<double>(ring[i][X]) * static_cast<double>(ring[j][Y]);
+  }
+  return area;
+}
+
+}
+
+/**
+ * Even-odd fill rule (default): p is inside if a ray from p crosses the
+ * boundary an odd number of times; self-overlapping parts become holes.
+ */
+struct EvenOddRule {
+  static constexpr bool ORIENTED{false};
+
+  /**
+   * Accounts for the edge from j to i whose y-range straddles p.
+   * @param counter crossing parity
+   * @param i later vertex of the edge
+   * @param j earlier vertex of the edge
+   * @param p point to test
+   */
+  template <typename T>
+  static void cross(int32_t &counter, const std::array<T,2> &i, const std::array<T,2> &j, const std::array<T,2> &p) {
+    constexpr const uint8_t X{0};
+    constexpr const uint8_t Y{1};
+    // The algorithms is based on W. Randolph Franklin's implementation that can be found here:
+    // https://wrf.ecse.rpi.edu/Research/Short_Notes/pnpoly.html
+    if (p[X] < (j[X]-i[X]) * (p[Y]-i[Y]) / (j[Y]-i[Y]) + i[X]) {
+      counter ^= 1;
+    }
+  }
+
+  /**
+   * Same as cross but also testing whether the edge from j to i straddles p,
+   * usable in constant expressions.
+   * @return updated counter
+   */
+  template <typename T>
+  static GEOFENCE_CONSTEXPR int32_t step(int32_t counter, const std::array<T,2> &i, const std::array<T,2> &j, const std::array<T,2> &p) {
+    return (((i[1] > p[1]) != (j[1] > p[1])) &&
+            (p[0] < (j[0]-i[0]) * (p[1]-i[1]) / (j[1]-i[1]) + i[0])) ? (counter ^ 1) : counter;
+  }
+
+  static constexpr bool isInside(int32_t counter) {
+    return 0 != counter;
+  }
+
+  /**
+   * @param counter
+   * @param delta +1 when crossing an edge from its right to its left side, -1 otherwise
+   * @return counter on the other side of the crossed edge
+   */
+  static constexpr int32_t transit(int32_t counter, int32_t delta) {
+    return counter ^ (delta & 1);
+  }
+};
+
+/**
+ * Nonzero fill rule: p is inside if the boundary winds around p, so that
+ * self-intersecting and overlapping rings are covered without holes. Uses a
+ * division-free orientation test and an integer winding counter.
+ */
+struct NonZeroRule {
+  static constexpr bool ORIENTED{true};
+
+  /**
+   * Accounts for the edge from j to i whose y-range straddles p.
+   * @param counter winding number
+   * @param i later vertex of the edge
+   * @param j earlier vertex of the edge
+   * @param p point to test
+   */
+  template <typename T>
+  static void cross(int32_t &counter, const std::array<T,2> &i, const std::array<T,2> &j, const std::array<T,2> &p) {
+    constexpr const uint8_t Y{1};
+    const auto side = detail::orientation(j, i, p);
+    if (i[Y] > p[Y]) {
+      // Upward edge: p must be left of it.
+      counter += (0 < side) ? 1 : 0;
+    }
+    else {
+      // Downward edge: p must be right of it.
+      counter -= (side < 0) ? 1 : 0;
+    }
+  }
+
+  /**
+   * Same as cross but also testing whether the edge from j to i straddles p,
+   * usable in constant expressions.
+   * @return updated counter
+   */
+  template <typename T>
+  static GEOFENCE_CONSTEXPR int32_t step(int32_t counter, const std::array<T,2> &i, const std::array<T,2> &j, const std::array<T,2> &p) {
+    return ((i[1] > p[1]) == (j[1] > p[1])) ? counter : counter + winding(i[1] > p[1], detail::orientation(j, i, p));
+  }
+
+  static constexpr bool isInside(int32_t counter) {
+    return 0 != counter;
+  }
+
+  /**
+   * @param counter
+   * @param delta +1 when crossing an edge from its right to its left side, -1 otherwise
+   * @return counter on the other side of the crossed edge
+   */
+  static constexpr int32_t transit(int32_t counter, int32_t delta) {
+    return counter + delta;
+  }
+
+ private:
+  template <typename W>
+  static constexpr int32_t winding(bool upward, W side) {
+    return upward ? ((0 < side) ? 1 : 0) : ((side < 0) ? -1 : 0);
+  }
+};
+
+namespace detail {
+
+/**
+ * @param p
+ * @param u
+ * @param v
+ * @return squared distance from p to the edge from u to v
+ */
+template <typename S>
+inline S squaredDistance(const std::array<S,2> &p, const std::array<S,2> &u, const std::array<S,2> &v) {
+  constexpr const uint8_t X{0};
+  constexpr const uint8_t Y{1};
+  const S dx{v[X] - u[X]};
+  const S dy{v[Y] - u[Y]};
+  const S length2{dx * dx + dy * dy};
+  S t{(0 < length2) ? ((p[X] - u[X]) * dx + (p[Y] - u[Y]) * dy) / length2 : 0};
+  t = (std::max)(S(0), (std::min)(S(1), t));
+  const S ex{u[X] + t * dx - p[X]};
+  const S ey{u[Y] + t * dy - p[Y]};
+  return ex * ex + ey * ey;
+}
+
+/**
+ * Single pass over one closed ring as in isIn.
+ * @param ring vertices of the ring
+ * @param size number of vertices in ring
+ * @param p point to test
+ * @param counter accumulated by FillRule for every edge straddling p
+ * @return true if p is any vertex of the ring
+ */
+template <typename FillRule, typename T>
+inline bool walkRing(const std::array<T,2> *ring, std::size_t size, const std::array<T,2> &p, int32_t &counter) {
+  constexpr const uint8_t X{0};
+  constexpr const uint8_t Y{1};
+  std::size_t i{0};
+  std::size_t j{size - 1};
+  for(; i < size ; j = i++) {
+    if ( isEqual(p[X], ring[i][X]) && isEqual(p[Y], ring[i][Y]) ) {
+      return true;
+    }
+    if ((ring[i][Y] > p[Y]) != (ring[j][Y] > p[Y])) {
+      FillRule::cross(counter, ring[i], ring[j], p);
+    }
+  }
+  return false;
+}
+
+}
+
 /**
  * @param polygon describing a geofenced area
  * @param p point to test whether inside or not
- * @return true if p is inside the polygon OR when p is any vertex OR on an edge of the convex hull
+ * @return true if p is inside the polygon according to FillRule OR when p is any vertex OR on an edge of the convex hull
+ */
+template <typename T, typename FillRule = EvenOddRule, typename Allocator = std::allocator<std::array<T,2>>>
+inline bool isIn(std::vector<std::array<T,2>, Allocator> &polygon, std::array<T,2> &p) {
+  static_assert(std::is_arithmetic<T>::value, "T must be an arithmetic type");
+  int32_t counter{0};
+  if (2 < polygon.size()) {
+    if (detail::walkRing<FillRule>(polygon.data(), polygon.size(), p, counter)) {
+      return true;
+    }
+  }
+  return FillRule::isInside(counter);
+}
+
+namespace detail {
+
+/**
+ * As walkRing, but visits every edge to also find the nearest one.
+ * @param distance2 lowered to the squared distance from p to the nearest edge
+ * @return true if p is any vertex of the ring
+ */
+template <typename FillRule, typename T>
+inline bool walkRingDistance(const std::array<T,2> *ring, std::size_t size, const std::array<T,2> &p, int32_t &counter, double &distance2) {
+  constexpr const uint8_t X{0};
+  constexpr const uint8_t Y{1};
+  const std::array<double,2> q{{static_cast<double>(p[X]), static_cast<double>(p[Y])}};
+  bool vertex{false};
+  std::array<double,2> u{{static_cast<double>(ring[size - 1][X]), static_cast<double>(ring[size - 1][Y])}};
+  for(std::size_t i{0}, j{size - 1}; i < size ; j = i++) {
+    const std::array<double,2> v{{static_cast<double>(ring[i][X]), static_cast<double>(ring[i][Y])}};
+    vertex = vertex || (isEqual(p[X], ring[i][X]) && isEqual(p[Y], ring[i][Y]));
+    if ((ring[i][Y] > p[Y]) != (ring[j][Y] > p[Y])) {
+      FillRule::cross(counter, ring[i], ring[j], p);
+    }
+    distance2 = (std::min)(distance2, squaredDistance(q, u, v));
+    u = v;
+  }
+  return vertex;
+}
+
+/**
+ * Same as isEqual but without branches, for loops that should vectorize.
+ */
+template <typename T>
+inline bool isEqualLane(T a, T b) {
+#pragma GCC diagnostic push
+#if defined(__clang__)
+#pragma GCC diagnostic ignored "-Wabsolute-value"
+#endif
+  constexpr auto EPSILON = 1.0e-09f;
+  const auto difference = std::abs(a - b);
+  return (difference <= EPSILON) | (difference <= EPSILON * (std::max)(std::abs(a), std::abs(b)));
+#pragma GCC diagnostic pop
+}
+
+/**
+ * FillRule's counter change for the edge from j to i at p, i.e., step from a
+ * zero counter. The specializations for the built-in rules have no branches so
+ * that loops over many points vectorize.
  */
+template <typename FillRule, typename T>
+struct Crossing {
+  static int32_t delta(T ix, T iy, T jx, T jy, T px, T py) {
+    return FillRule::step(0, std::array<T,2>{{ix, iy}}, std::array<T,2>{{jx, jy}}, std::array<T,2>{{px, py}});
+  }
+};
+
+template <typename T>
+struct Crossing<EvenOddRule, T> {
+  static int32_t delta(T ix, T iy, T jx, T jy, T px, T py) {
+    // Same expression as EvenOddRule::cross; the quotient is discarded for edges not
+    // straddling p, which only need a divisor other than zero.
+    const bool straddles{(iy > py) != (jy > py)};
+    const T dy{jy - iy};
+    const T divisor{static_cast<T>(dy + static_cast<T>(!(dy < 0) & !(0 < dy)))};
+    return static_cast<int32_t>(straddles & (px < (jx - ix) * (py - iy) / divisor + ix));
+  }
+};
+
 template <typename T>
-inline bool isIn(std::vector<std::array<T,2>> &polygon, std::array<T,2> &p) {
+struct Crossing<NonZeroRule, T> {
+  static int32_t delta(T ix, T iy, T jx, T jy, T px, T py) {
+    const bool straddles{(iy > py) != (jy > py)};
+    const bool upward{iy > py};
+    const auto side = orientation(std::array<T,2>{{jx, jy}}, std::array<T,2>{{ix, iy}}, std::array<T,2>{{px, py}});
+    return static_cast<int32_t>(straddles & upward & (0 < side)) - static_cast<int32_t>(straddles & !upward & (side < 0));
+  }
+};
+
+}
+
+/**
+ * Signed distance from p to the boundary of the polygon, computed in the same
+ * pass over the edges as the crossing test of isIn with a single square root.
+ * @param polygon describing a geofenced area
+ * @param p point
+ * @return distance to the nearest edge, negative if p is inside as by isIn; std::signbit tells also points on the boundary apart; infinity for fewer than 3 vertices
+ */
+template <typename T, typename FillRule = EvenOddRule, typename Allocator = std::allocator<std::array<T,2>>>
+inline double signedDistance(const std::vector<std::array<T,2>, Allocator> &polygon, const std::array<T,2> &p) {
   static_assert(std::is_arithmetic<T>::value, "T must be an arithmetic type");
+  int32_t counter{0};
+  double distance2{std::numeric_limits<double>::infinity()};
   bool inside{false};
   if (2 < polygon.size()) {
-    constexpr const uint8_t X{0};
+    inside = detail::walkRingDistance<FillRule>(polygon.data(), polygon.size(), p, counter, distance2);
+  }
+  inside = inside || FillRule::isInside(counter);
+  const double distance{std::sqrt(distance2)};
+  return inside ? -distance : distance;
+}
+
+/**
+ * Signed distances for many points in structure-of-arrays layout. Points are
+ * processed in groups of 16 that visit every edge once; the loop over a
+ * group's points has no branches for the built-in fill rules, so that the
+ * compiler vectorizes it, e.g., GCC with -O3 and AVX2 or newer.
+ * @param polygon describing a geofenced area
+ * @param x x-coordinates of the points
+ * @param y y-coordinates of the points
+ * @param count number of points
+ * @param distances receives the count signed distances, identical to signedDistance
+ */
+template <typename T, typename FillRule = EvenOddRule, typename Allocator = std::allocator<std::array<T,2>>>
+inline void signedDistances(const std::vector<std::array<T,2>, Allocator> &polygon, const T *x, const T *y, std::size_t count, double *distances) {
+  static_assert(std::is_arithmetic<T>::value, "T must be an arithmetic type");
+  constexpr const uint8_t X{0};
+  constexpr const uint8_t Y{1};
+  constexpr const std::size_t LANES{16};
+  const std::size_t size{(2 < polygon.size()) ? polygon.size() : 0};
+  for(std::size_t begin{0}; begin < count; begin += LANES) {
+    const std::size_t lanes{(std::min)(LANES, count - begin)};
+    T px[LANES];
+    T py[LANES];
+    double qx[LANES];
+    double qy[LANES];
+    double distance2[LANES];
+    int32_t counter[LANES];
+    int32_t vertex[LANES];
+    for(std::size_t lane{0}; lane < LANES; lane++) {
+      // Unused lanes repeat the group's first point.
+      px[lane] = x[begin + ((lane < lanes) ? lane : 0)];
+      py[lane] = y[begin + ((lane < lanes) ? lane : 0)];
+      qx[lane] = static_cast<double>(px[lane]);
+      qy[lane] = static_cast<double>(py[lane]);
+      distance2[lane] = std::numeric_limits<double>::infinity();
+      counter[lane] = 0;
+      vertex[lane] = 0;
+    }
+    for(std::size_t i{0}, j{size - 1}; i < size; j = i++) {
+      const T ix{polygon[i][X]};
+      const T iy{polygon[i][Y]};
+      const T jx{polygon[j][X]};
+      const T jy{polygon[j][Y]};
+      const double ux{static_cast<double>(jx)};
+      const double uy{static_cast<double>(jy)};
+      const double dx{static_cast<double>(ix) - ux};
+      const double dy{static_cast<double>(iy) - uy};
+      const double length2{dx * dx + dy * dy};
+      // Same arithmetic as detail::squaredDistance, with its branch on the edge's length hoisted.
+      const double divisor{(0 < length2) ? length2 : 1.0};
+      const double scale{(0 < length2) ? 1.0 : 0.0};
+      for(std::size_t lane{0}; lane < LANES; lane++) {
+        vertex[lane] |= static_cast<int32_t>(detail::isEqualLane(px[lane], ix) & detail::isEqualLane(py[lane], iy));
+        counter[lane] = FillRule::transit(counter[lane], detail::Crossing<FillRule, T>::delta(ix, iy, jx, jy, px[lane], py[lane]));
+        double t{((qx[lane] - ux) * dx + (qy[lane] - uy) * dy) / divisor * scale};
+        t = (std::max)(0.0, (std::min)(1.0, t));
+        const double ex{ux + t * dx - qx[lane]};
+        const double ey{uy + t * dy - qy[lane]};
+        distance2[lane] = (std::min)(distance2[lane], ex * ex + ey * ey);
+      }
+    }
+    for(std::size_t lane{0}; lane < lanes; lane++) {
+      const double distance{std::sqrt(distance2[lane])};
+      distances[begin + lane] = ((0 != vertex[lane]) || FillRule::isInside(counter[lane])) ? -distance : distance;
+    }
+  }
+}
+
+namespace detail {
+
+/**
+ * Tests the single edge of a y-monotone chain that straddles p's y-coordinate
+ * using binary search and checks the chain's vertices close to p's y-coordinate.
+ * @param ring vertices of the polygon
+ * @param size number of vertices in ring
+ * @param first index of the chain's first vertex in ring
+ * @param length number of edges in the chain
+ * @param ascending true if the chain's y-coordinates are non-decreasing
+ * @param p point to test
+ * @param counter accumulated by FillRule for the straddling edge
+ * @return true if p is any vertex of the chain
+ */
+template <typename FillRule, typename T>
+inline bool walkMonotoneChain(const std::array<T,2> *ring, std::size_t size, std::size_t first, std::size_t length, bool ascending, const std::array<T,2> &p, int32_t &counter) {
+  constexpr const uint8_t X{0};
+  constexpr const uint8_t Y{1};
+  auto vertex = [ring, size, first](std::size_t t) -> const std::array<T,2>& {
+    return ring[(first + t) % size];
+  };
+
+  // Find the first position where (vertex(t)[Y] > p[Y]) differs from the chain's start.
+  std::size_t lo{0};
+  std::size_t hi{length + 1};
+  while (lo < hi) {
+    const std::size_t mid{lo + (hi - lo) / 2};
+    if ((vertex(mid)[Y] > p[Y]) == ascending) {
+      hi = mid;
+    }
+    else {
+      lo = mid + 1;
+    }
+  }
+
+  for(std::size_t t{lo}; t > 0 && isEqual(vertex(t - 1)[Y], p[Y]); t--) {
+    if (isEqual(vertex(t - 1)[X], p[X])) {
+      return true;
+    }
+  }
+  for(std::size_t t{lo}; t <= length && isEqual(vertex(t)[Y], p[Y]); t++) {
+    if (isEqual(vertex(t)[X], p[X])) {
+      return true;
+    }
+  }
+
+  if (0 < lo && lo <= length) {
+    // Same orientation as in isIn: i is the later vertex of the edge, j the earlier one.
+    FillRule::cross(counter, vertex(lo), vertex(lo - 1), p);
+  }
+  return false;
+}
+
+}
+
+/**
+ * Prepared polygon that is split into y-monotone chains of edges. A query skips
+ * all chains whose y-range misses the point and binary-searches the remaining
+ * ones for the single edge straddling the point's y-coordinate, which results
+ * in O(k log n) per query for k chains. Results are identical to isIn.
+ */
+template <typename T, typename FillRule = EvenOddRule>
+class MonotoneChainIndex {
+  static_assert(std::is_arithmetic<T>::value, "T must be an arithmetic type");
+
+ public:
+  struct Chain {
+    std::size_t first;   // index of the first vertex in the polygon
+    std::size_t length;  // number of edges
+    bool ascending;      // true if the y-coordinates are non-decreasing
+    std::array<T,2> min; // bounding box of the chain
+    std::array<T,2> max;
+  };
+
+ public:
+  /**
+   * @param polygon describing a geofenced area
+   */
+  explicit MonotoneChainIndex(const std::vector<std::array<T,2>> &polygon)
+    : m_polygon{polygon}
+    , m_chains{} {
+    if (2 < m_polygon.size()) {
+      constexpr const uint8_t X{0};
+      constexpr const uint8_t Y{1};
+      const std::size_t POINTS{m_polygon.size()};
+      for(std::size_t k{0}; k < POINTS; k++) {
+        const std::array<T,2> &a = m_polygon[k];
+        const std::array<T,2> &b = m_polygon[(k + 1) % POINTS];
+        const int direction{(a[Y] < b[Y]) ? 1 : ((b[Y] < a[Y]) ? -1 : 0)};
+
+        // Horizontal edges extend any chain; a change in direction starts a new one.
+        bool extend{!m_chains.empty()};
+        if (extend && (0 != direction)) {
+          Chain &c = m_chains.back();
+          const bool flat{!(c.min[Y] < c.max[Y])};
+          extend = flat || (c.ascending == (0 < direction));
+        }
+        if (!extend) {
+          Chain c{k, 0, true, a, a};
+          m_chains.push_back(c);
+        }
+
+        Chain &c = m_chains.back();
+        if (0 != direction) {
+          c.ascending = (0 < direction);
+        }
+        c.length++;
+        c.min[X] = (std::min)(c.min[X], b[X]);
+        c.min[Y] = (std::min)(c.min[Y], b[Y]);
+        c.max[X] = (std::max)(c.max[X], b[X]);
+        c.max[Y] = (std::max)(c.max[Y], b[Y]);
+      }
+
+      std::sort(m_chains.begin(), m_chains.end(), [](const Chain &lhs, const Chain &rhs) {
+        return lhs.min[Y] < rhs.min[Y];
+      });
+    }
+  }
+
+  /**
+   * @param p point to test whether inside or not
+   * @return true if p is inside the polygon according to FillRule OR when p is any vertex (identical to isIn)
+   */
+  bool isIn(const std::array<T,2> &p) const {
     constexpr const uint8_t Y{1};
-    const std::size_t POINTS{polygon.size()};
-    std::size_t i{0};
-    std::size_t j{POINTS - 1};
-    for(; i < POINTS ; j = i++) {
-      if ( isEqual(p[X], polygon.at(i)[X]) && isEqual(p[Y], polygon.at(i)[Y]) ) {
+    int32_t counter{0};
+    for(const auto &c : m_chains) {
+      if (p[Y] < c.min[Y] && !isEqual(p[Y], c.min[Y])) {
+        // Chains are sorted by their lower y-bound.
+        break;
+      }
+      if (c.max[Y] < p[Y] && !isEqual(p[Y], c.max[Y])) {
+        continue;
+      }
+      if (detail::walkMonotoneChain<FillRule>(m_polygon.data(), m_polygon.size(), c.first, c.length, c.ascending, p, counter)) {
         return true;
       }
+    }
+    return FillRule::isInside(counter);
+  }
+
+  /**
+   * Signed distance to the boundary, with the crossing test of isIn. Chains
+   * whose bounding box is farther than the nearest edge found so far are
+   * skipped, and the others are binary-searched for the run of edges within
+   * that distance of p's y-coordinate.
+   * @param p point
+   * @return as signedDistance
+   */
+  double signedDistance(const std::array<T,2> &p) const {
+    constexpr const uint8_t X{0};
+    constexpr const uint8_t Y{1};
+    const std::array<double,2> q{{static_cast<double>(p[X]), static_cast<double>(p[Y])}};
+    int32_t counter{0};
+    bool vertex{false};
+    for(const auto &c : m_chains) {
+      if (p[Y] < c.min[Y] && !isEqual(p[Y], c.min[Y])) {
+        break;
+      }
+      if (c.max[Y] < p[Y] && !isEqual(p[Y], c.max[Y])) {
+        continue;
+      }
+      vertex = detail::walkMonotoneChain<FillRule>(m_polygon.data(), m_polygon.size(), c.first, c.length, c.ascending, p, counter) || vertex;
+    }
 
-      // The algorithms is based on W. Randolph Franklin's implementation that can be found here:
-      // https://wrf.ecse.rpi.edu/Research/Short_Notes/pnpoly.html
-      if ( ((polygon.at(i)[Y] > p[Y]) != (polygon.at(j)[Y] > p[Y])) &&
-           (p[X] < (polygon.at(j)[X]-polygon.at(i)[X]) * (p[Y]-polygon.at(i)[Y]) / (polygon.at(j)[Y]-polygon.at(i)[Y]) + polygon.at(i)[X]) ) {
-        inside = !inside;
+    // Every chain touches all sides of its box, so its farthest corner bounds the distance.
+    auto squared = [](double a, double b) {
+      return a * a + b * b;
+    };
+    double distance2{std::numeric_limits<double>::infinity()};
+    for(const auto &c : m_chains) {
+      distance2 = (std::min)(distance2, squared((std::max)(std::abs(q[X] - static_cast<double>(c.min[X])), std::abs(q[X] - static_cast<double>(c.max[X]))),
+                                                (std::max)(std::abs(q[Y] - static_cast<double>(c.min[Y])), std::abs(q[Y] - static_cast<double>(c.max[Y])))));
+    }
+    for(const auto &c : m_chains) {
+      const double boxX{(std::max)(0.0, (std::max)(static_cast<double>(c.min[X]) - q[X], q[X] - static_cast<double>(c.max[X])))};
+      const double boxY{(std::max)(0.0, (std::max)(static_cast<double>(c.min[Y]) - q[Y], q[Y] - static_cast<double>(c.max[Y])))};
+      if (squared(boxX, boxY) <= distance2) {
+        distance2 = chainDistance2(c, q, distance2);
       }
     }
+    const double distance{std::sqrt(distance2)};
+    return (vertex || FillRule::isInside(counter)) ? -distance : distance;
   }
-  return inside;
-}
+
+  /**
+   * @return y-monotone chains sorted by their lower y-bound
+   */
+  const std::vector<Chain> &chains() const {
+    return m_chains;
+  }
+
+  /**
+   * @return vertices of the prepared polygon
+   */
+  const std::vector<std::array<T,2>> &polygon() const {
+    return m_polygon;
+  }
+
+ private:
+  // Lowers distance2 to the squared distance from q to the chain's edges within sqrt(distance2) of q's y-coordinate.
+  double chainDistance2(const Chain &c, const std::array<double,2> &q, double distance2) const {
+    constexpr const uint8_t X{0};
+    constexpr const uint8_t Y{1};
+    auto vertex = [this, &c](std::size_t t) {
+      const std::array<T,2> &v = m_polygon[(c.first + t) % m_polygon.size()];
+      return std::array<double,2>{{static_cast<double>(v[X]), static_cast<double>(v[Y])}};
+    };
+    double radius{std::sqrt(distance2)};
+    // Along the chain, y runs from the window's near end towards its far end.
+    const double sign{c.ascending ? 1.0 : -1.0};
+    std::size_t lo{0};
+    std::size_t hi{c.length + 1};
+    while (lo < hi) {
+      const std::size_t mid{lo + (hi - lo) / 2};
+      if (sign * (vertex(mid)[Y] - q[Y]) < -radius) {
+        lo = mid + 1;
+      }
+      else {
+        hi = mid;
+      }
+    }
+    std::array<double,2> u{vertex((0 < lo) ? lo - 1 : 0)};
+    for(std::size_t e{(0 < lo) ? lo - 1 : 0}; (e < c.length) && !(radius < sign * (u[Y] - q[Y])); e++) {
+      const std::array<double,2> v{vertex(e + 1)};
+      const double d2{detail::squaredDistance(q, u, v)};
+      if (d2 < distance2) {
+        distance2 = d2;
+        radius = std::sqrt(distance2);
+      }
+      u = v;
+    }
+    return distance2;
+  }
+
+ private:
+  std::vector<std::array<T,2>> m_polygon;
+  std::vector<Chain> m_chains;
+};
+
+/**
+ * Axis-aligned bounding box.
+ */
+template <typename T>
+struct BoundingBox {
+  std::array<T,2> min;
+  std::array<T,2> max;
+
+  /**
+   * @param polygon
+   * @return bounding box enclosing all vertices of polygon
+   */
+  static BoundingBox of(const std::vector<std::array<T,2>> &polygon) {
+    BoundingBox box{empty()};
+    for(const auto &v : polygon) {
+      box.extend(v);
+    }
+    return box;
+  }
+
+  /**
+   * @return bounding box that contains no point and that the first extend replaces
+   */
+  static BoundingBox empty() {
+    return BoundingBox{{{(std::numeric_limits<T>::max)(), (std::numeric_limits<T>::max)()}},
+                       {{std::numeric_limits<T>::lowest(), std::numeric_limits<T>::lowest()}}};
+  }
+
+  /**
+   * @return true if this bounding box contains no point
+   */
+  bool isEmpty() const {
+    constexpr const uint8_t X{0};
+    constexpr const uint8_t Y{1};
+    return (max[X] < min[X]) || (max[Y] < min[Y]);
+  }
+
+  void extend(const std::array<T,2> &p) {
+    constexpr const uint8_t X{0};
+    constexpr const uint8_t Y{1};
+    min[X] = (std::min)(min[X], p[X]);
+    min[Y] = (std::min)(min[Y], p[Y]);
+    max[X] = (std::max)(max[X], p[X]);
+    max[Y] = (std::max)(max[Y], p[Y]);
+  }
+
+  void extend(const BoundingBox &other) {
+    if (!other.isEmpty()) {
+      extend(other.min);
+      extend(other.max);
+    }
+  }
+
+  /**
+   * @param p
+   * @return true if p is inside or on the border of this bounding box
+   */
+  bool contains(const std::array<T,2> &p) const {
+    constexpr const uint8_t X{0};
+    constexpr const uint8_t Y{1};
+    return !(p[X] < min[X] || max[X] < p[X] || p[Y] < min[Y] || max[Y] < p[Y]);
+  }
+};
+
+namespace detail {
+
+/**
+ * Shallow bounding volume hierarchy that is packed bottom-up: the leaves are
+ * groups of FANOUT consecutive items in Sort-Tile-Recursive order and every
+ * inner level groups FANOUT consecutive nodes of the level below.
+ */
+template <typename S>
+class PackedBoxTree {
+ public:
+  static constexpr std::size_t FANOUT{8};
+
+ public:
+  PackedBoxTree() : m_levels{} {}
+
+  /**
+   * @param boxes bounding boxes of the items to index
+   * @return order of the items that the caller has to use to lay out its leaf groups
+   */
+  std::vector<std::size_t> build(const std::vector<BoundingBox<S>> &boxes) {
+    constexpr const uint8_t X{0};
+    constexpr const uint8_t Y{1};
+    std::vector<std::size_t> order(boxes.size());
+    for(std::size_t i{0}; i < order.size(); i++) {
+      order[i] = i;
+    }
+    auto center = [&boxes](std::size_t i, uint8_t axis) {
+      return boxes[i].min[axis] / 2 + boxes[i].max[axis] / 2;
+    };
+
+    // Sort-Tile-Recursive: vertical slices by x, each slice sorted by y.
+    std::sort(order.begin(), order.end(), [&center](std::size_t a, std::size_t b) {
+      return center(a, X) < center(b, X);
+    });
+    const std::size_t LEAVES{(order.size() + FANOUT - 1) / FANOUT};
+    const std::size_t SLICES{static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(LEAVES))))};
+    const std::size_t PER_SLICE{(0 < SLICES) ? ((LEAVES + SLICES - 1) / SLICES) * FANOUT : 1};
+    for(std::size_t begin{0}; begin < order.size(); begin += PER_SLICE) {
+      const std::size_t end{(std::min)(order.size(), begin + PER_SLICE)};
+      std::sort(order.begin() + static_cast<std::ptrdiff_t>(begin), order.begin() + static_cast<std::ptrdiff_t>(end), [&center](std::size_t a, std::size_t b) {
+        return center(a, Y) < center(b, Y);
+      });
+    }
+
+    m_levels.clear();
+    std::vector<BoundingBox<S>> level;
+    for(std::size_t i{0}; i < order.size(); i++) {
+      if (0 == i % FANOUT) {
+        level.push_back(boxes[order[i]]);
+      }
+      else {
+        level.back().extend(boxes[order[i]]);
+      }
+    }
+    while (!level.empty()) {
+      m_levels.push_back(level);
+      if (1 == level.size()) {
+        break;
+      }
+      std::vector<BoundingBox<S>> parents;
+      for(std::size_t i{0}; i < level.size(); i++) {
+        if (0 == i % FANOUT) {
+          parents.push_back(level[i]);
+        }
+        else {
+          parents.back().extend(level[i]);
+        }
+      }
+      level.swap(parents);
+    }
+    return order;
+  }
+
+  /**
+   * Visits all leaf groups whose bounding box contains p.
+   * @param p
+   * @param visit callable taking the leaf group's index and returning true to stop the traversal
+   * @return true if the traversal was stopped by visit
+   */
+  template <typename Visitor>
+  bool query(const std::array<S,2> &p, Visitor &&visit) const {
+    if (m_levels.empty()) {
+      return false;
+    }
+    return descend(m_levels.size() - 1, 0, p, visit);
+  }
+
+  /**
+   * @return bounding boxes of every level, leaf groups first and the root last
+   */
+  const std::vector<std::vector<BoundingBox<S>>> &levels() const {
+    return m_levels;
+  }
+
+ private:
+  template <typename Visitor>
+  bool descend(std::size_t level, std::size_t node, const std::array<S,2> &p, Visitor &visit) const {
+    if (!m_levels[level][node].contains(p)) {
+      return false;
+    }
+    if (0 == level) {
+      return visit(node);
+    }
+    const std::size_t end{(std::min)(m_levels[level - 1].size(), (node + 1) * FANOUT)};
+    for(std::size_t child{node * FANOUT}; child < end; child++) {
+      if (descend(level - 1, child, p, visit)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  std::vector<std::vector<BoundingBox<S>>> m_levels;
+};
+
+template <typename S>
+constexpr std::size_t PackedBoxTree<S>::FANOUT;
+
+}
+
+/**
+ * Triangulate a simple polygon using ear clipping. Collinear and repeated
+ * vertices are dropped without a triangle.
+ * @param polygon describing a geofenced area
+ * @return triangles as indices into polygon in counter-clockwise order; none if
+ *         the ring is not simple, i.e., it runs out of ears or the triangles do
+ *         not add up to its area
+ */
+template <typename T>
+inline std::vector<std::array<std::size_t,3>> triangulate(const std::vector<std::array<T,2>> &polygon) {
+  static_assert(std::is_arithmetic<T>::value, "T must be an arithmetic type");
+  constexpr const uint8_t X{0};
+  constexpr const uint8_t Y{1};
+  std::vector<std::array<std::size_t,3>> triangles;
+  const std::size_t POINTS{polygon.size()};
+  if (3 > POINTS) {
+    return triangles;
+  }
+
+  auto cross = [&polygon](std::size_t a, std::size_t b, std::size_t c) {
+    return (static_cast<double>(polygon[b][X]) - static_cast<double>(polygon[a][X])) * (static_cast<double>(polygon[c][Y]) - static_cast<double>(polygon[a][Y]))
+         - (static_cast<double>(polygon[b][Y]) - static_cast<double>(polygon[a][Y])) * (static_cast<double>(polygon[c][X]) - static_cast<double>(polygon[a][X]));
+  };
+
+  const double area{detail::signedArea2(polygon)};
+
+  // Doubly-linked list of the remaining vertices in counter-clockwise order.
+  std::vector<std::size_t> next(POINTS);
+  std::vector<std::size_t> prev(POINTS);
+  for(std::size_t i{0}; i < POINTS; i++) {
+    const bool CCW{0 < area};
+    next[i] = CCW ? (i + 1) % POINTS : (i + POINTS - 1) % POINTS;
+    prev[i] = CCW ? (i + POINTS - 1) % POINTS : (i + 1) % POINTS;
+  }
+
+  auto isEar = [&](std::size_t b) {
+    const std::size_t a{prev[b]};
+    const std::size_t c{next[b]};
+    if (!(0 < cross(a, b, c))) {
+      return false;
+    }
+    // Only vertices that are not convex can lie inside a candidate ear.
+    for(std::size_t v{next[c]}; v != a; v = next[v]) {
+      if ( (0 < cross(prev[v], v, next[v])) ||
+           (polygon[v] == polygon[a]) || (polygon[v] == polygon[b]) || (polygon[v] == polygon[c]) ) {
+        continue;
+      }
+      if (!(cross(a, b, v) < 0) && !(cross(b, c, v) < 0) && !(cross(c, a, v) < 0)) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  triangles.reserve(POINTS - 2);
+  std::size_t remaining{POINTS};
+  std::size_t current{0};
+  std::size_t attempts{0};
+  while (3 < remaining) {
+    const double turn{cross(prev[current], current, next[current])};
+    const bool collinear{!(turn < 0) && !(0 < turn)};
+    if (collinear || isEar(current)) {
+      if (!collinear) {
+        triangles.push_back(std::array<std::size_t,3>{{prev[current], current, next[current]}});
+      }
+      next[prev[current]] = next[current];
+      prev[next[current]] = prev[current];
+      current = prev[current];
+      remaining--;
+      attempts = 0;
+    }
+    else if (attempts > remaining) {
+      // Clipping any other vertex would cover area outside the ring.
+      return std::vector<std::array<std::size_t,3>>{};
+    }
+    else {
+      current = next[current];
+      attempts++;
+    }
+  }
+  if (0 < cross(prev[current], current, next[current])) {
+    triangles.push_back(std::array<std::size_t,3>{{prev[current], current, next[current]}});
+  }
+  // Ears of a self-intersecting ring may cover area outside of it.
+  double sum{0};
+  for(const auto &t : triangles) {
+    sum += cross(t[0], t[1], t[2]);
+  }
+  if (1e-9 * sum < std::abs(sum - std::abs(area))) {
+    return std::vector<std::array<std::size_t,3>>{};
+  }
+  return triangles;
+}
+
+/**
+ * Prepared polygon for mid-size fences that is triangulated once by ear
+ * clipping. The triangles are packed into a shallow bounding volume hierarchy
+ * whose leaves hold 8 triangles each in structure-of-arrays layout, so that a
+ * leaf is tested with branch-free edge-function sign checks the compiler can
+ * vectorize. Points on the boundary are reported as inside. Rings that cannot be
+ * triangulated, e.g., self-intersecting ones, are kept as they are and answered
+ * by the crossing test of isIn.
+ */
+template <typename T>
+class TriangleIndex {
+  static_assert(std::is_arithmetic<T>::value, "T must be an arithmetic type");
+  using Scalar = typename std::conditional<std::is_floating_point<T>::value, T, double>::type;
+  static constexpr std::size_t LANES{detail::PackedBoxTree<Scalar>::FANOUT};
+
+  // Edge k of a triangle starts at (x[k], y[k]) and has direction (dx[k], dy[k]).
+  struct Block {
+    Scalar x[3][LANES];
+    Scalar y[3][LANES];
+    Scalar dx[3][LANES];
+    Scalar dy[3][LANES];
+    uint32_t valid;
+  };
+
+ public:
+  /**
+   * @param polygon describing a geofenced area
+   */
+  explicit TriangleIndex(const std::vector<std::array<T,2>> &polygon)
+    : m_blocks{}
+    , m_tree{}
+    , m_ring{} {
+    constexpr const uint8_t X{0};
+    constexpr const uint8_t Y{1};
+    const auto triangles = triangulate(polygon);
+    if (triangles.empty() && (2 < polygon.size())) {
+      m_ring = polygon;
+      return;
+    }
+
+    std::vector<BoundingBox<Scalar>> boxes;
+    boxes.reserve(triangles.size());
+    for(const auto &t : triangles) {
+      BoundingBox<Scalar> box{{{static_cast<Scalar>(polygon[t[0]][X]), static_cast<Scalar>(polygon[t[0]][Y])}},
+                              {{static_cast<Scalar>(polygon[t[0]][X]), static_cast<Scalar>(polygon[t[0]][Y])}}};
+      box.extend(std::array<Scalar,2>{{static_cast<Scalar>(polygon[t[1]][X]), static_cast<Scalar>(polygon[t[1]][Y])}});
+      box.extend(std::array<Scalar,2>{{static_cast<Scalar>(polygon[t[2]][X]), static_cast<Scalar>(polygon[t[2]][Y])}});
+      boxes.push_back(box);
+    }
+
+    const auto order = m_tree.build(boxes);
+    m_blocks.resize((order.size() + LANES - 1) / LANES);
+    for(std::size_t i{0}; i < order.size(); i++) {
+      Block &block = m_blocks[i / LANES];
+      const std::size_t lane{i % LANES};
+      const auto &t = triangles[order[i]];
+      for(std::size_t k{0}; k < 3; k++) {
+        const auto &a = polygon[t[k]];
+        const auto &b = polygon[t[(k + 1) % 3]];
+        block.x[k][lane] = static_cast<Scalar>(a[X]);
+        block.y[k][lane] = static_cast<Scalar>(a[Y]);
+        block.dx[k][lane] = static_cast<Scalar>(b[X]) - static_cast<Scalar>(a[X]);
+        block.dy[k][lane] = static_cast<Scalar>(b[Y]) - static_cast<Scalar>(a[Y]);
+      }
+      block.valid |= (1u << lane);
+    }
+  }
+
+  /**
+   * @param p point to test whether inside or not
+   * @return true if p is inside or on the border of any triangle of the polygon; as isIn if it has no triangles
+   */
+  bool isIn(const std::array<T,2> &p) const {
+    constexpr const uint8_t X{0};
+    constexpr const uint8_t Y{1};
+    if (!m_ring.empty()) {
+      int32_t counter{0};
+      return detail::walkRing<EvenOddRule>(m_ring.data(), m_ring.size(), p, counter) || EvenOddRule::isInside(counter);
+    }
+    const std::array<Scalar,2> q{{static_cast<Scalar>(p[X]), static_cast<Scalar>(p[Y])}};
+    return m_tree.query(q, [this, &q](std::size_t leaf) {
+      return 0 != testBlock(m_blocks[leaf], q);
+    });
+  }
+
+  /**
+   * @return number of triangles; zero if the ring could not be triangulated
+   */
+  std::size_t size() const {
+    std::size_t count{0};
+    for(const auto &block : m_blocks) {
+      for(uint32_t valid{block.valid}; 0 != valid; valid &= valid - 1) {
+        count++;
+      }
+    }
+    return count;
+  }
+
+ private:
+  static uint32_t testBlock(const Block &block, const std::array<Scalar,2> &q) {
+    constexpr const uint8_t X{0};
+    constexpr const uint8_t Y{1};
+    uint32_t mask{0};
+    for(std::size_t lane{0}; lane < LANES; lane++) {
+      const Scalar e0{block.dx[0][lane] * (q[Y] - block.y[0][lane]) - block.dy[0][lane] * (q[X] - block.x[0][lane])};
+      const Scalar e1{block.dx[1][lane] * (q[Y] - block.y[1][lane]) - block.dy[1][lane] * (q[X] - block.x[1][lane])};
+      const Scalar e2{block.dx[2][lane] * (q[Y] - block.y[2][lane]) - block.dy[2][lane] * (q[X] - block.x[2][lane])};
+      mask |= static_cast<uint32_t>(!(e0 < 0) & !(e1 < 0) & !(e2 < 0)) << lane;
+    }
+    return mask & block.valid;
+  }
+
+ private:
+  std::vector<Block> m_blocks;
+  detail::PackedBoxTree<Scalar> m_tree;
+  std::vector<std::array<T,2>> m_ring; // only if the ring could not be triangulated
+};
+
+template <typename T>
+constexpr std::size_t TriangleIndex<T>::LANES;
+
+/**
+ * Set of polygons, each with one outer ring and any number of holes, e.g., an
+ * airport without its terminal. All rings are stored in one contiguous vertex
+ * array and a query runs a single crossing-number pass over the rings, skipping
+ * every ring whose bounding box does not contain the point. For oriented fill
+ * rules, outer rings are stored counter-clockwise and holes clockwise.
+ */
+template <typename T, typename FillRule = EvenOddRule>
+class MultiPolygon {
+  static_assert(std::is_arithmetic<T>::value, "T must be an arithmetic type");
+
+ public:
+  struct Ring {
+    std::size_t first;   // index of the first vertex
+    std::size_t size;    // number of vertices
+    BoundingBox<T> box;
+  };
+
+  struct Polygon {
+    std::size_t firstRing; // outer ring followed by its holes
+    std::size_t rings;
+  };
+
+ public:
+  MultiPolygon()
+    : m_vertices{}
+    , m_rings{}
+    , m_polygons{} {}
+
+  /**
+   * Adds a polygon; rings with less than three vertices are ignored.
+   * @param outer outer ring
+   * @param holes rings excluded from the outer ring
+   */
+  void add(const std::vector<std::array<T,2>> &outer, const std::vector<std::vector<std::array<T,2>>> &holes = std::vector<std::vector<std::array<T,2>>>{}) {
+    if (3 > outer.size()) {
+      return;
+    }
+    Polygon polygon{m_rings.size(), 0};
+    addRing(outer, true);
+    polygon.rings++;
+    for(const auto &hole : holes) {
+      if (2 < hole.size()) {
+        addRing(hole, false);
+        polygon.rings++;
+      }
+    }
+    m_polygons.push_back(polygon);
+  }
+
+  /**
+   * @param p point to test whether inside or not
+   * @return true if p is inside any polygon but not in one of its holes according to FillRule OR when p is any vertex
+   */
+  bool isIn(const std::array<T,2> &p) const {
+    for(const auto &polygon : m_polygons) {
+      if (!m_rings[polygon.firstRing].box.contains(p)) {
+        continue;
+      }
+      int32_t counter{0};
+      for(std::size_t r{polygon.firstRing}; r < polygon.firstRing + polygon.rings; r++) {
+        const Ring &ring = m_rings[r];
+        if (ring.box.contains(p) && detail::walkRing<FillRule>(m_vertices.data() + ring.first, ring.size, p, counter)) {
+          return true;
+        }
+      }
+      if (FillRule::isInside(counter)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * @return number of polygons
+   */
+  std::size_t size() const {
+    return m_polygons.size();
+  }
+
+  const std::vector<Polygon> &polygons() const {
+    return m_polygons;
+  }
+
+  const std::vector<Ring> &rings() const {
+    return m_rings;
+  }
+
+  const std::vector<std::array<T,2>> &vertices() const {
+    return m_vertices;
+  }
+
+ private:
+  void addRing(const std::vector<std::array<T,2>> &ring, bool outer) {
+    Ring r{m_vertices.size(), ring.size(), BoundingBox<T>::of(ring)};
+    if (FillRule::ORIENTED && (outer != (0 < detail::signedArea2(ring)))) {
+      m_vertices.insert(m_vertices.end(), ring.rbegin(), ring.rend());
+    }
+    else {
+      m_vertices.insert(m_vertices.end(), ring.begin(), ring.end());
+    }
+    m_rings.push_back(r);
+  }
+
+ private:
+  std::vector<std::array<T,2>> m_vertices;
+  std::vector<Ring> m_rings;
+  std::vector<Polygon> m_polygons;
+};
+
+namespace detail {
+
+/**
+ * isEqual that is usable in constant expressions.
+ */
+template <typename T>
+constexpr bool isEqualConstexpr(T a, T b) {
+  return ((a < b) ? (b - a) : (a - b)) <= 1.0e-09f ||
+         ((a < b) ? (b - a) : (a - b)) <= 1.0e-09f * (std::max)((0 < a) ? a : T(0) - a, (0 < b) ? b : T(0) - b);
+}
+
+/**
+ * Edge loop over the first I vertices of a fixed-size ring, unrolled at compile time.
+ */
+template <typename FillRule, typename T, std::size_t N, std::size_t I>
+struct UnrolledRing {
+  static GEOFENCE_CONSTEXPR bool isVertex(const std::array<std::array<T,2>,N> &polygon, const std::array<T,2> &p) {
+    return UnrolledRing<FillRule, T, N, I - 1>::isVertex(polygon, p) ||
+           (isEqualConstexpr(p[0], polygon[I - 1][0]) && isEqualConstexpr(p[1], polygon[I - 1][1]));
+  }
+
+  static GEOFENCE_CONSTEXPR int32_t count(const std::array<std::array<T,2>,N> &polygon, const std::array<T,2> &p) {
+    return FillRule::step(UnrolledRing<FillRule, T, N, I - 1>::count(polygon, p), polygon[I - 1], polygon[(I + N - 2) % N], p);
+  }
+
+  static GEOFENCE_CONSTEXPR double area2(const std::array<std::array<T,2>,N> &polygon) {
+    return UnrolledRing<FillRule, T, N, I - 1>::area2(polygon)
+         + static_cast<double>(polygon[(I + N - 2) % N][0]) * static_cast<double>(polygon[I - 1][1])
+         - static_cast<double>(polygon[I - 1][0]) * static_cast<double>(polygon[(I + N - 2) % N][1]);
+  }
+
+  static GEOFENCE_CONSTEXPR bool hasRepeatedVertex(const std::array<std::array<T,2>,N> &polygon) {
+    return UnrolledRing<FillRule, T, N, I - 1>::hasRepeatedVertex(polygon) ||
+           (isEqualConstexpr(polygon[I - 1][0], polygon[(I + N - 2) % N][0]) && isEqualConstexpr(polygon[I - 1][1], polygon[(I + N - 2) % N][1]));
+  }
+};
+
+template <typename FillRule, typename T, std::size_t N>
+struct UnrolledRing<FillRule, T, N, 0> {
+  static GEOFENCE_CONSTEXPR bool isVertex(const std::array<std::array<T,2>,N> &, const std::array<T,2> &) {
+    return false;
+  }
+
+  static GEOFENCE_CONSTEXPR int32_t count(const std::array<std::array<T,2>,N> &, const std::array<T,2> &) {
+    return 0;
+  }
+
+  static GEOFENCE_CONSTEXPR double area2(const std::array<std::array<T,2>,N> &) {
+    return 0;
+  }
+
+  static GEOFENCE_CONSTEXPR bool hasRepeatedVertex(const std::array<std::array<T,2>,N> &) {
+    return false;
+  }
+};
+
+}
+
+/**
+ * Overload for fences with a fixed number of vertices (rectangles, octagons, ...)
+ * whose edge loop is fully unrolled at compile time; without heap and usable
+ * in constant expressions when compiled as C++14 or newer.
+ * @param polygon describing a geofenced area
+ * @param p point to test whether inside or not
+ * @return true if p is inside the polygon according to FillRule OR when p is any vertex (identical to isIn)
+ */
+template <typename T, typename FillRule = EvenOddRule, std::size_t N>
+GEOFENCE_CONSTEXPR bool isIn(const std::array<std::array<T,2>,N> &polygon, const std::array<T,2> &p) {
+  static_assert(std::is_arithmetic<T>::value, "T must be an arithmetic type");
+  return (2 < N) &&
+         (detail::UnrolledRing<FillRule, T, N, N>::isVertex(polygon, p) ||
+          FillRule::isInside(detail::UnrolledRing<FillRule, T, N, N>::count(polygon, p)));
+}
+
+/**
+ * Validates a fixed-size fence, e.g., static_assert(geofence::isValid(FENCE), "...").
+ * @param polygon describing a geofenced area
+ * @return true if polygon has at least three vertices, no repeated consecutive vertices, and a non-zero area
+ */
+template <typename T, std::size_t N>
+GEOFENCE_CONSTEXPR bool isValid(const std::array<std::array<T,2>,N> &polygon) {
+  static_assert(std::is_arithmetic<T>::value, "T must be an arithmetic type");
+  return (2 < N) &&
+         !detail::UnrolledRing<EvenOddRule, T, N, N>::hasRepeatedVertex(polygon) &&
+         ((detail::UnrolledRing<EvenOddRule, T, N, N>::area2(polygon) < 0) || (0 < detail::UnrolledRing<EvenOddRule, T, N, N>::area2(polygon)));
+}
+
+namespace detail {
+
+/**
+ * Derives the counter of p from the known counter of an anchor point by
+ * accounting for the edge from u to v if the segment from the anchor to p
+ * crosses it. All edges that may cross the segment must be walked.
+ * @param u
+ * @param v
+ * @param anchor point that is not on any of the edges
+ * @param p point to test
+ * @param counter counter of the anchor, updated to the counter of p
+ * @return true if p is u or v
+ */
+template <typename FillRule, typename S>
+inline bool walkLocalEdge(const std::array<S,2> &u, const std::array<S,2> &v, const std::array<S,2> &anchor, const std::array<S,2> &p, int32_t &counter) {
+  constexpr const uint8_t X{0};
+  constexpr const uint8_t Y{1};
+  if ( (isEqual(p[X], u[X]) && isEqual(p[Y], u[Y])) || (isEqual(p[X], v[X]) && isEqual(p[Y], v[Y])) ) {
+    return true;
+  }
+  // Zero is consistently treated as right side so that passing through a vertex counts once.
+  const bool uLeft{0 < orientation(anchor, p, u)};
+  const bool vLeft{0 < orientation(anchor, p, v)};
+  if (uLeft != vLeft) {
+    const bool anchorLeft{0 < orientation(u, v, anchor)};
+    const bool pLeft{0 < orientation(u, v, p)};
+    if (anchorLeft != pLeft) {
+      counter = FillRule::transit(counter, pLeft ? 1 : -1);
+    }
+  }
+  return false;
+}
+
+/**
+ * As walkLocalEdge, for a list of edges.
+ * @param vertices of the ring
+ * @param size number of vertices
+ * @param edges indices k of the edges from vertices[k] to vertices[k+1]
+ * @param count number of edges
+ */
+template <typename FillRule, typename S>
+inline bool walkLocalEdges(const std::array<S,2> *vertices, std::size_t size, const uint32_t *edges, std::size_t count, const std::array<S,2> &anchor, const std::array<S,2> &p, int32_t &counter) {
+  for(std::size_t k{0}; k < count; k++) {
+    if (walkLocalEdge<FillRule>(vertices[edges[k]], vertices[(edges[k] + 1) % size], anchor, p, counter)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Run of consecutive ring edges crossing a grid cell.
+ */
+struct EdgeRun {
+  uint32_t firstEdge; // index k of the first edge from vertices[k] to vertices[k+1]
+  uint32_t edges;
+};
+
+/**
+ * As walkLocalEdges, for runs of consecutive edges.
+ * @param runs
+ * @param count number of runs
+ */
+template <typename FillRule, typename S>
+inline bool walkLocalRuns(const std::array<S,2> *vertices, std::size_t size, const EdgeRun *runs, std::size_t count, const std::array<S,2> &anchor, const std::array<S,2> &p, int32_t &counter) {
+  for(std::size_t r{0}; r < count; r++) {
+    std::size_t k{runs[r].firstEdge};
+    for(uint32_t e{0}; e < runs[r].edges; e++) {
+      const std::size_t next{(k + 1 < size) ? k + 1 : 0};
+      if (walkLocalEdge<FillRule>(vertices[k], vertices[next], anchor, p, counter)) {
+        return true;
+      }
+      k = next;
+    }
+  }
+  return false;
+}
+
+/**
+ * @param u
+ * @param v
+ * @param min lower corner of the box
+ * @param max upper corner of the box
+ * @return true if the edge from u to v touches the closed box
+ */
+template <typename S>
+inline bool intersects(const std::array<S,2> &u, const std::array<S,2> &v, const std::array<S,2> &min, const std::array<S,2> &max) {
+  constexpr const uint8_t X{0};
+  constexpr const uint8_t Y{1};
+  if ( ((std::max)(u[X], v[X]) < min[X]) || (max[X] < (std::min)(u[X], v[X])) ||
+       ((std::max)(u[Y], v[Y]) < min[Y]) || (max[Y] < (std::min)(u[Y], v[Y])) ) {
+    return false;
+  }
+  // Separating axis along the edge's normal: all corners strictly on one side.
+  const std::array<std::array<S,2>,4> corners{{min, {{max[X], min[Y]}}, max, {{min[X], max[Y]}}}};
+  int left{0};
+  int right{0};
+  for(const auto &c : corners) {
+    const S o{orientation(u, v, c)};
+    left += (0 < o) ? 1 : 0;
+    right += (o < 0) ? 1 : 0;
+  }
+  return (4 != left) && (4 != right);
+}
+
+/**
+ * Clips the edge from u to v to a box (Liang-Barsky); endpoints inside the box are kept as they are.
+ * @param u
+ * @param v
+ * @param min lower corner of the box
+ * @param max upper corner of the box
+ * @return false if the edge misses the box
+ */
+inline bool clip(std::array<double,2> &u, std::array<double,2> &v, const std::array<double,2> &min, const std::array<double,2> &max) {
+  const std::array<double,2> d{{v[0] - u[0], v[1] - u[1]}};
+  double t0{0};
+  double t1{1};
+  for(uint8_t a{0}; a < 2; a++) {
+    const double p[2]{-d[a], d[a]};
+    const double q[2]{u[a] - min[a], max[a] - u[a]};
+    for(uint8_t k{0}; k < 2; k++) {
+      if (p[k] < 0) {
+        t0 = (std::max)(t0, q[k] / p[k]);
+      }
+      else if (0 < p[k]) {
+        t1 = (std::min)(t1, q[k] / p[k]);
+      }
+      else if (q[k] < 0) {
+        return false;
+      }
+    }
+  }
+  if (t1 < t0) {
+    return false;
+  }
+  const std::array<double,2> a{(0 < t0) ? std::array<double,2>{{u[0] + t0 * d[0], u[1] + t0 * d[1]}} : u};
+  v = (t1 < 1) ? std::array<double,2>{{u[0] + t1 * d[0], u[1] + t1 * d[1]}} : v;
+  u = a;
+  return true;
+}
+
+/**
+ * End point of an edge of a grid cell quantized to 16 bits in a frame
+ * spanning the cell and one cell width around it.
+ */
+using QuantizedPoint = std::array<uint16_t,2>;
+
+/**
+ * Squared distance in frame units below which a point is too close to a
+ * quantized edge to trust the quantized crossing test; rounding moves an
+ * endpoint by at most 0.71 units.
+ */
+constexpr double QUANTIZATION_MARGIN2{4.0};
+
+/**
+ * As walkLocalRuns, for runs whose end points are quantized to a cell's frame.
+ * @param points quantized end points of the runs, one more per run than it has edges
+ * @param runs
+ * @param count number of runs
+ * @param anchor in frame units, at least the margin away from all edges
+ * @param p in frame units
+ * @param counter accumulated by FillRule for every edge separating anchor and p
+ * @return false if p is within the margin of an edge, so that the exact edges must decide
+ */
+template <typename FillRule>
+inline bool walkQuantizedRuns(const QuantizedPoint *points, const EdgeRun *runs, std::size_t count, const std::array<double,2> &anchor, const std::array<double,2> &p, int32_t &counter) {
+  for(std::size_t r{0}; r < count; r++, points++) {
+    for(const QuantizedPoint *last{points + runs[r].edges}; points < last; points++) {
+      const std::array<double,2> u{{static_cast<double>(points[0][0]), static_cast<double>(points[0][1])}};
+      const std::array<double,2> v{{static_cast<double>(points[1][0]), static_cast<double>(points[1][1])}};
+      // Distance test without division: near an endpoint, or near the line within the edge's extent.
+      const std::array<double,2> d{{v[0] - u[0], v[1] - u[1]}};
+      const std::array<double,2> w{{p[0] - u[0], p[1] - u[1]}};
+      const double side{d[0] * w[1] - w[0] * d[1]};
+      const double along{d[0] * w[0] + d[1] * w[1]};
+      const double length2{d[0] * d[0] + d[1] * d[1]};
+      if ( (w[0] * w[0] + w[1] * w[1] < QUANTIZATION_MARGIN2) || (length2 - 2 * along + w[0] * w[0] + w[1] * w[1] < QUANTIZATION_MARGIN2) ||
+           (!(along < 0) && !(length2 < along) && (side * side < QUANTIZATION_MARGIN2 * length2)) ) {
+        return false;
+      }
+      const bool uLeft{0 < orientation(anchor, p, u)};
+      const bool vLeft{0 < orientation(anchor, p, v)};
+      if (uLeft != vLeft) {
+        const bool anchorLeft{0 < orientation(u, v, anchor)};
+        const bool pLeft{0 < side};
+        if (anchorLeft != pLeft) {
+          counter = FillRule::transit(counter, pLeft ? 1 : -1);
+        }
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * @param x
+ * @param y
+ * @return x and y with their bits interleaved (Morton code)
+ */
+inline uint64_t interleave(uint32_t x, uint32_t y) {
+  auto spread = [](uint64_t v) {
+    v &= 0xFFFFFFFFull;
+    v = (v | (v << 16)) & 0x0000FFFF0000FFFFull;
+    v = (v | (v << 8)) & 0x00FF00FF00FF00FFull;
+    v = (v | (v << 4)) & 0x0F0F0F0F0F0F0F0Full;
+    v = (v | (v << 2)) & 0x3333333333333333ull;
+    v = (v | (v << 1)) & 0x5555555555555555ull;
+    return v;
+  };
+  return spread(x) | (spread(y) << 1);
+}
+
+}
+
+/**
+ * S2-like covering of a polygon by quadtree cells at adaptive levels. Cells
+ * without edges are stored only when they are fully inside; boundary cells keep
+ * the edges crossing them and an anchor point with known inside/outside state.
+ * A query hashes the point's cell ID at each level; points in interior cells
+ * resolve without any edge math and points in boundary cells only test the
+ * handful of edges registered for their cell. Boundary cells store their edges
+ * as runs of consecutive ring edges whose end points are quantized to 16 bits
+ * relative to the cell, i.e., 4 bytes per edge plus a small header per run,
+ * instead of two full-precision vertices. Only points within the quantization
+ * error of an edge fall back to the exact edges, which are found from the
+ * first ring edge of each run; these are evaluated in double precision.
+ * Boundary cells without an anchor clear of their edges walk the whole ring.
+ */
+template <typename T, typename FillRule = EvenOddRule>
+class CellCovering {
+  static_assert(std::is_arithmetic<T>::value, "T must be an arithmetic type");
+
+ public:
+  static constexpr uint32_t MAX_LEVEL{24};
+
+  struct Cell {
+    std::array<double,2> anchor;
+    uint32_t firstRun;         // index into edge runs, only for boundary cells
+    uint32_t runs;             // zero for interior cells; ALL if the whole ring must be walked
+    uint32_t firstPoint;       // index into quantized points; UNQUANTIZED if the anchor is too close to them
+    int32_t counter;           // FillRule's counter at the anchor
+  };
+
+  static constexpr uint32_t UNQUANTIZED{0xFFFFFFFFu};
+  static constexpr uint32_t ALL{0xFFFFFFFFu};
+
+ public:
+  /**
+   * @param polygon describing a geofenced area
+   * @param maxLevel finest quadtree level (at most MAX_LEVEL)
+   * @param maxEdgesPerCell boundary cells with more edges are subdivided until maxLevel
+   */
+  explicit CellCovering(const std::vector<std::array<T,2>> &polygon, uint32_t maxLevel = 16, uint32_t maxEdgesPerCell = 8)
+    : m_vertices{}
+    , m_origin{{0, 0}}
+    , m_size{0}
+    , m_maxLevel{(std::min)(maxLevel, MAX_LEVEL)}
+    , m_levels{0}
+    , m_cells{}
+    , m_runs{}
+    , m_points{}
+    , m_index{} {
+    constexpr const uint8_t X{0};
+    constexpr const uint8_t Y{1};
+    if (3 > polygon.size()) {
+      return;
+    }
+    for(const auto &v : polygon) {
+      m_vertices.push_back(std::array<double,2>{{static_cast<double>(v[X]), static_cast<double>(v[Y])}});
+    }
+    const auto box = BoundingBox<double>::of(m_vertices);
+    m_origin = box.min;
+    m_size = (std::max)(box.max[X] - box.min[X], box.max[Y] - box.min[Y]);
+    m_size = (0 < m_size) ? m_size * (1 + 1e-9) : 1;
+
+    std::vector<uint32_t> edges(m_vertices.size());
+    for(uint32_t k{0}; k < edges.size(); k++) {
+      edges[k] = k;
+    }
+    subdivide(0, 0, 0, edges, maxEdgesPerCell);
+  }
+
+  /**
+   * @param p point to test whether inside or not
+   * @return true if p is inside the polygon according to FillRule OR when p is any vertex
+   */
+  bool isIn(const std::array<T,2> &p) const {
+    constexpr const uint8_t X{0};
+    constexpr const uint8_t Y{1};
+    const std::array<double,2> q{{static_cast<double>(p[X]), static_cast<double>(p[Y])}};
+    const double fx{(q[X] - m_origin[X]) / m_size};
+    const double fy{(q[Y] - m_origin[Y]) / m_size};
+    if (m_cells.empty() || fx < 0 || !(fx < 1) || fy < 0 || !(fy < 1)) {
+      return false;
+    }
+    const uint32_t x{static_cast<uint32_t>(fx * static_cast<double>(1u << MAX_LEVEL))};
+    const uint32_t y{static_cast<uint32_t>(fy * static_cast<double>(1u << MAX_LEVEL))};
+    for(uint32_t level{0}; level <= m_maxLevel; level++) {
+      if (0 == (m_levels & (1u << level))) {
+        continue;
+      }
+      const uint32_t cellX{x >> (MAX_LEVEL - level)};
+      const uint32_t cellY{y >> (MAX_LEVEL - level)};
+      const auto it = m_index.find(id(level, cellX, cellY));
+      if (it != m_index.end()) {
+        const Cell &cell = m_cells[it->second];
+        int32_t counter{cell.counter};
+        if (ALL == cell.runs) {
+          counter = 0;
+          return detail::walkRing<FillRule>(m_vertices.data(), m_vertices.size(), q, counter) || FillRule::isInside(counter);
+        }
+        if (UNQUANTIZED != cell.firstPoint) {
+          const Frame frame{this->frame(level, cellX, cellY)};
+          if (detail::walkQuantizedRuns<FillRule>(m_points.data() + cell.firstPoint, m_runs.data() + cell.firstRun, cell.runs, frame.map(cell.anchor), frame.map(q), counter)) {
+            return FillRule::isInside(counter);
+          }
+          counter = cell.counter;
+        }
+        if ( (0 < cell.runs) &&
+             detail::walkLocalRuns<FillRule>(m_vertices.data(), m_vertices.size(), m_runs.data() + cell.firstRun, cell.runs, cell.anchor, q, counter) ) {
+          return true;
+        }
+        return FillRule::isInside(counter);
+      }
+    }
+    return false;
+  }
+
+  /**
+   * @return number of stored interior and boundary cells
+   */
+  std::size_t size() const {
+    return m_cells.size();
+  }
+
+  /**
+   * @return number of stored boundary cells
+   */
+  std::size_t boundaryCells() const {
+    std::size_t count{0};
+    for(const auto &c : m_cells) {
+      count += (0 < c.runs) ? 1 : 0;
+    }
+    return count;
+  }
+
+  /**
+   * @return number of boundary cells answering from quantized edges
+   */
+  std::size_t quantizedCells() const {
+    std::size_t count{0};
+    for(const auto &c : m_cells) {
+      count += (0 < c.runs && UNQUANTIZED != c.firstPoint) ? 1 : 0;
+    }
+    return count;
+  }
+
+  /**
+   * @return bytes used by the cells, their edge runs, and quantized points; without the hash index and the vertices
+   */
+  std::size_t bytes() const {
+    return m_cells.size() * sizeof(Cell) + m_runs.size() * sizeof(detail::EdgeRun) + m_points.size() * sizeof(detail::QuantizedPoint);
+  }
+
+ private:
+  // Maps coordinates to 16-bit units over a cell and one cell width around it.
+  struct Frame {
+    std::array<double,2> min;
+    double scale;
+
+    std::array<double,2> map(const std::array<double,2> &p) const {
+      return std::array<double,2>{{(p[0] - min[0]) * scale, (p[1] - min[1]) * scale}};
+    }
+  };
+
+  Frame frame(uint32_t level, uint32_t x, uint32_t y) const {
+    constexpr const uint8_t X{0};
+    constexpr const uint8_t Y{1};
+    const double size{m_size / static_cast<double>(1u << level)};
+    return Frame{{{m_origin[X] + x * size - size, m_origin[Y] + y * size - size}}, 65535.0 / (3 * size)};
+  }
+
+  static uint64_t id(uint32_t level, uint32_t x, uint32_t y) {
+    return (static_cast<uint64_t>(level) << 58) | detail::interleave(x, y);
+  }
+
+  void subdivide(uint32_t level, uint32_t x, uint32_t y, const std::vector<uint32_t> &candidates, uint32_t maxEdgesPerCell) {
+    constexpr const uint8_t X{0};
+    constexpr const uint8_t Y{1};
+    const double size{m_size / static_cast<double>(1u << level)};
+    const std::array<double,2> min{{m_origin[X] + x * size, m_origin[Y] + y * size}};
+    const std::array<double,2> max{{min[X] + size, min[Y] + size}};
+
+    std::vector<uint32_t> edges;
+    for(uint32_t k : candidates) {
+      if (detail::intersects(m_vertices[k], m_vertices[(k + 1) % m_vertices.size()], min, max)) {
+        edges.push_back(k);
+      }
+    }
+
+    if (edges.empty()) {
+      std::array<double,2> center{{min[X] + size / 2, min[Y] + size / 2}};
+      int32_t counter{0};
+      detail::walkRing<FillRule>(m_vertices.data(), m_vertices.size(), center, counter);
+      if (FillRule::isInside(counter)) {
+        store(level, x, y, Cell{center, 0, 0, UNQUANTIZED, counter});
+      }
+    }
+    else if ((level == m_maxLevel) || (edges.size() <= maxEdgesPerCell)) {
+      // Anchor is the candidate farthest from all edges of this cell.
+      std::array<double,2> anchor{{min[X], min[Y]}};
+      double best{-1};
+      for(int i{1}; i < 4; i++) {
+        for(int j{1}; j < 4; j++) {
+          const std::array<double,2> c{{min[X] + i * size / 4, min[Y] + j * size / 4}};
+          double nearest{(std::numeric_limits<double>::max)()};
+          for(uint32_t k : edges) {
+            nearest = (std::min)(nearest, detail::squaredDistance(c, m_vertices[k], m_vertices[(k + 1) % m_vertices.size()]));
+          }
+          if (best < nearest) {
+            best = nearest;
+            anchor = c;
+          }
+        }
+      }
+      // An anchor on an edge (up to rounding) has no well-defined side; such a cell walks the whole ring.
+      if (!(size * size * 1e-18 < best)) {
+        store(level, x, y, Cell{anchor, 0, ALL, UNQUANTIZED, 0});
+        return;
+      }
+      int32_t counter{0};
+      detail::walkRing<FillRule>(m_vertices.data(), m_vertices.size(), anchor, counter);
+
+      // Edges are clipped to the frame; consecutive edges share their quantized end point unless it lies outside.
+      const Frame frame{this->frame(level, x, y)};
+      const std::array<double,2> frameMax{{frame.min[X] + 3 * size, frame.min[Y] + 3 * size}};
+      auto inFrame = [&frame, &frameMax](const std::array<double,2> &v) {
+        return !(v[X] < frame.min[X]) && !(frameMax[X] < v[X]) && !(v[Y] < frame.min[Y]) && !(frameMax[Y] < v[Y]);
+      };
+      auto quantize = [&frame](const std::array<double,2> &v) {
+        const std::array<double,2> f{frame.map(v)};
+        return detail::QuantizedPoint{{static_cast<uint16_t>((std::min)(65535.0, (std::max)(0.0, std::round(f[X])))),
+                                       static_cast<uint16_t>((std::min)(65535.0, (std::max)(0.0, std::round(f[Y]))))}};
+      };
+      const std::size_t n{m_vertices.size()};
+      const std::size_t firstRun{m_runs.size()};
+      for(uint32_t k : edges) {
+        if ( (firstRun < m_runs.size()) && (m_runs.back().firstEdge + m_runs.back().edges == k) && inFrame(m_vertices[k]) ) {
+          m_runs.back().edges++;
+        }
+        else {
+          m_runs.push_back(detail::EdgeRun{k, 1});
+        }
+      }
+      // Edges are sorted, so a run through the last vertex continues with the first one.
+      if ( (firstRun + 1 < m_runs.size()) && (0 == m_runs[firstRun].firstEdge) &&
+           (n == m_runs.back().firstEdge + m_runs.back().edges) && inFrame(m_vertices[0]) ) {
+        m_runs.back().edges += m_runs[firstRun].edges;
+        m_runs.erase(m_runs.begin() + static_cast<std::ptrdiff_t>(firstRun));
+      }
+
+      // The anchor must be clear of the quantization error of all edges.
+      const std::array<double,2> frameAnchor{frame.map(anchor)};
+      std::vector<detail::QuantizedPoint> points;
+      bool quantized{true};
+      for(std::size_t run{firstRun}; run < m_runs.size(); run++) {
+        std::size_t k{m_runs[run].firstEdge};
+        for(uint32_t e{0}; e < m_runs[run].edges; e++) {
+          const std::size_t next{(k + 1 < n) ? k + 1 : 0};
+          std::array<double,2> u{m_vertices[k]};
+          std::array<double,2> v{m_vertices[next]};
+          detail::clip(u, v, frame.min, frameMax);
+          if (0 == e) {
+            points.push_back(quantize(u));
+          }
+          points.push_back(quantize(v));
+          const auto &qu = points[points.size() - 2];
+          const auto &qv = points.back();
+          quantized = quantized && !(detail::squaredDistance(frameAnchor, std::array<double,2>{{static_cast<double>(qu[X]), static_cast<double>(qu[Y])}},
+                                                             std::array<double,2>{{static_cast<double>(qv[X]), static_cast<double>(qv[Y])}}) < 4 * detail::QUANTIZATION_MARGIN2);
+          k = next;
+        }
+      }
+      store(level, x, y, Cell{anchor, static_cast<uint32_t>(firstRun), static_cast<uint32_t>(m_runs.size() - firstRun),
+                              quantized ? static_cast<uint32_t>(m_points.size()) : UNQUANTIZED, counter});
+      if (quantized) {
+        m_points.insert(m_points.end(), points.begin(), points.end());
+      }
+    }
+    else {
+      for(uint32_t child{0}; child < 4; child++) {
+        subdivide(level + 1, 2 * x + (child & 1), 2 * y + (child >> 1), edges, maxEdgesPerCell);
+      }
+    }
+  }
+
+  void store(uint32_t level, uint32_t x, uint32_t y, const Cell &cell) {
+    m_index[id(level, x, y)] = static_cast<uint32_t>(m_cells.size());
+    m_cells.push_back(cell);
+    m_levels |= (1u << level);
+  }
+
+ private:
+  std::vector<std::array<double,2>> m_vertices;
+  std::array<double,2> m_origin;
+  double m_size;
+  uint32_t m_maxLevel;
+  uint32_t m_levels; // bit set for every level that has stored cells
+  std::vector<Cell> m_cells;
+  std::vector<detail::EdgeRun> m_runs;
+  std::vector<detail::QuantizedPoint> m_points; // end points of the runs of quantized cells
+  std::unordered_map<uint64_t, uint32_t> m_index;
+};
+
+template <typename T, typename FillRule>
+constexpr uint32_t CellCovering<T, FillRule>::MAX_LEVEL;
+
+template <typename T, typename FillRule>
+constexpr uint32_t CellCovering<T, FillRule>::UNQUANTIZED;
+
+template <typename T, typename FillRule>
+constexpr uint32_t CellCovering<T, FillRule>::ALL;
+
+/**
+ * Planar subdivision of the boundaries of many, possibly overlapping fences,
+ * built offline by slab decomposition: the plane is cut into vertical slabs at
+ * every vertex and every edge intersection, so that the edges spanning a slab
+ * never cross inside it. Every face between two consecutive edges of a slab
+ * records the set of fences covering it (even-odd rule per fence); identical
+ * sets are interned. A query locates the slab and the face by two binary
+ * searches and returns the precomputed set in O(log n).
+ */
+template <typename T>
+class ArrangementIndex {
+  static_assert(std::is_arithmetic<T>::value, "T must be an arithmetic type");
+
+  struct Edge {
+    std::array<double,2> a; // left end point
+    std::array<double,2> b; // right end point
+    uint32_t fence;
+
+    double y(double x) const {
+      return a[1] + (b[1] - a[1]) * (x - a[0]) / (b[0] - a[0]);
+    }
+  };
+
+ public:
+  /**
+   * @param fences rings describing the geofenced areas; their indices are used as fence IDs
+   */
+  explicit ArrangementIndex(const std::vector<std::vector<std::array<T,2>>> &fences)
+    : m_edges{}
+    , m_xs{}
+    , m_slabOffsets{}
+    , m_slabEdges{}
+    , m_slabFaces{}
+    , m_sets{} {
+    constexpr const uint8_t X{0};
+    constexpr const uint8_t Y{1};
+    m_sets.push_back(std::vector<uint32_t>{});
+
+    for(uint32_t f{0}; f < fences.size(); f++) {
+      const auto &ring = fences[f];
+      if (3 > ring.size()) {
+        continue;
+      }
+      for(std::size_t i{0}, j{ring.size() - 1}; i < ring.size(); j = i++) {
+        std::array<double,2> u{{static_cast<double>(ring[j][X]), static_cast<double>(ring[j][Y])}};
+        std::array<double,2> v{{static_cast<double>(ring[i][X]), static_cast<double>(ring[i][Y])}};
+        m_xs.push_back(u[X]);
+        // Vertical edges never span the interior of a slab.
+        if (u[X] < v[X]) {
+          m_edges.push_back(Edge{u, v, f});
+        }
+        else if (v[X] < u[X]) {
+          m_edges.push_back(Edge{v, u, f});
+        }
+      }
+    }
+    std::sort(m_edges.begin(), m_edges.end(), [](const Edge &lhs, const Edge &rhs) {
+      return lhs.a[0] < rhs.a[0];
+    });
+    addIntersections();
+    std::sort(m_xs.begin(), m_xs.end());
+    m_xs.erase(std::unique(m_xs.begin(), m_xs.end(), [](double lhs, double rhs) {
+      return !(lhs < rhs) && !(rhs < lhs);
+    }), m_xs.end());
+    buildSlabs();
+  }
+
+  /**
+   * @param p point to locate
+   * @return ascending IDs of all fences containing p
+   */
+  const std::vector<uint32_t> &query(const std::array<T,2> &p) const {
+    constexpr const uint8_t X{0};
+    constexpr const uint8_t Y{1};
+    const double x{static_cast<double>(p[X])};
+    const double y{static_cast<double>(p[Y])};
+    if (m_xs.size() < 2 || x < m_xs.front() || !(x < m_xs.back())) {
+      return m_sets.front();
+    }
+    const std::size_t slab{static_cast<std::size_t>(std::upper_bound(m_xs.begin(), m_xs.end(), x) - m_xs.begin()) - 1};
+
+    // Number of edges of the slab that are below p.
+    std::size_t lo{m_slabOffsets[slab]};
+    std::size_t hi{m_slabOffsets[slab + 1]};
+    const std::size_t first{lo};
+    while (lo < hi) {
+      const std::size_t mid{lo + (hi - lo) / 2};
+      if (m_edges[m_slabEdges[mid]].y(x) < y) {
+        lo = mid + 1;
+      }
+      else {
+        hi = mid;
+      }
+    }
+    return (lo == first) ? m_sets.front() : m_sets[m_slabFaces[lo - 1]];
+  }
+
+  /**
+   * @return number of slabs
+   */
+  std::size_t slabs() const {
+    return (m_xs.size() < 2) ? 0 : m_xs.size() - 1;
+  }
+
+  /**
+   * @return number of distinct interned fence sets including the empty set
+   */
+  std::size_t sets() const {
+    return m_sets.size();
+  }
+
+ private:
+  void addIntersections() {
+    constexpr const uint8_t X{0};
+    constexpr const uint8_t Y{1};
+    // Edges are sorted by their left x; only edges overlapping in x are paired.
+    for(std::size_t i{0}; i < m_edges.size(); i++) {
+      const Edge &e = m_edges[i];
+      for(std::size_t j{i + 1}; j < m_edges.size() && m_edges[j].a[X] < e.b[X]; j++) {
+        const Edge &g = m_edges[j];
+        const double dx1{e.b[X] - e.a[X]};
+        const double dy1{e.b[Y] - e.a[Y]};
+        const double dx2{g.b[X] - g.a[X]};
+        const double dy2{g.b[Y] - g.a[Y]};
+        const double denominator{dx1 * dy2 - dy1 * dx2};
+        if (!(denominator < 0) && !(0 < denominator)) {
+          continue;
+        }
+        const double t{((g.a[X] - e.a[X]) * dy2 - (g.a[Y] - e.a[Y]) * dx2) / denominator};
+        const double s{((g.a[X] - e.a[X]) * dy1 - (g.a[Y] - e.a[Y]) * dx1) / denominator};
+        if (0 < t && t < 1 && 0 < s && s < 1) {
+          m_xs.push_back(e.a[X] + t * dx1);
+        }
+      }
+    }
+  }
+
+  void buildSlabs() {
+    constexpr const uint8_t X{0};
+    std::map<std::vector<uint32_t>, uint32_t> interned;
+    interned[m_sets.front()] = 0;
+
+    std::vector<uint32_t> active;
+    std::size_t next{0};
+    m_slabOffsets.push_back(0);
+    for(std::size_t s{0}; s + 1 < m_xs.size(); s++) {
+      const double left{m_xs[s]};
+      const double right{m_xs[s + 1]};
+      const double middle{left / 2 + right / 2};
+      while (next < m_edges.size() && !(left < m_edges[next].a[X])) {
+        active.push_back(static_cast<uint32_t>(next++));
+      }
+      active.erase(std::remove_if(active.begin(), active.end(), [this, right](uint32_t e) {
+        return m_edges[e].b[X] < right;
+      }), active.end());
+
+      std::vector<uint32_t> ordered{active};
+      std::sort(ordered.begin(), ordered.end(), [this, middle](uint32_t lhs, uint32_t rhs) {
+        return m_edges[lhs].y(middle) < m_edges[rhs].y(middle);
+      });
+
+      // Walk upwards through the slab and toggle every fence whose edge is passed.
+      std::vector<uint32_t> covering;
+      for(uint32_t e : ordered) {
+        const uint32_t fence{m_edges[e].fence};
+        auto it = std::lower_bound(covering.begin(), covering.end(), fence);
+        if (it != covering.end() && *it == fence) {
+          covering.erase(it);
+        }
+        else {
+          covering.insert(it, fence);
+        }
+        auto set = interned.find(covering);
+        if (set == interned.end()) {
+          set = interned.insert(std::make_pair(covering, static_cast<uint32_t>(m_sets.size()))).first;
+          m_sets.push_back(covering);
+        }
+        m_slabEdges.push_back(e);
+        m_slabFaces.push_back(set->second);
+      }
+      m_slabOffsets.push_back(m_slabEdges.size());
+    }
+  }
+
+ private:
+  std::vector<Edge> m_edges;
+  std::vector<double> m_xs;                // slab boundaries
+  std::vector<std::size_t> m_slabOffsets;  // first entry of every slab in m_slabEdges
+  std::vector<uint32_t> m_slabEdges;       // edges of every slab ordered bottom-up
+  std::vector<uint32_t> m_slabFaces;       // interned fence set of the face above every edge
+  std::vector<std::vector<uint32_t>> m_sets;
+};
+
+/**
+ * Lookup structure for disjoint partitions like postal areas or tariff zones,
+ * resolving a point to the single zone containing it. Vertices and edges
+ * shared by neighbouring zones are stored once; every edge records the zones on
+ * its left and right side. A query walks a uniform grid of edge lists to the
+ * right of the point to find the nearest edge crossing the horizontal ray and
+ * returns the zone on the side facing the point.
+ */
+template <typename T>
+class PartitionIndex {
+  static_assert(std::is_arithmetic<T>::value, "T must be an arithmetic type");
+
+ public:
+  static constexpr int32_t NONE{-1};
+
+  struct Edge {
+    uint32_t a;    // vertex index, a < b
+    uint32_t b;
+    int32_t left;  // zone left of the direction from a to b
+    int32_t right; // zone right of the direction from a to b
+  };
+
+ public:
+  /**
+   * @param zones non-overlapping rings; their indices are used as zone IDs
+   * @param cellsPerAxis resolution of the grid; 0 to derive it from the number of edges
+   */
+  explicit PartitionIndex(const std::vector<std::vector<std::array<T,2>>> &zones, uint32_t cellsPerAxis = 0)
+    : m_vertices{}
+    , m_edges{}
+    , m_box{{{0, 0}}, {{0, 0}}}
+    , m_cells{1}
+    , m_cellOffsets{}
+    , m_cellEdges{} {
+    constexpr const uint8_t X{0};
+    constexpr const uint8_t Y{1};
+    std::map<std::array<double,2>, uint32_t> vertexIds;
+    std::unordered_map<uint64_t, uint32_t> edgeIds;
+    for(int32_t zone{0}; zone < static_cast<int32_t>(zones.size()); zone++) {
+      const auto &ring = zones[static_cast<std::size_t>(zone)];
+      if (3 > ring.size()) {
+        continue;
+      }
+      // Interior is left of every edge of a counter-clockwise ring.
+      const bool CCW{0 < detail::signedArea2(ring)};
+      std::vector<uint32_t> ids;
+      for(const auto &v : ring) {
+        const std::array<double,2> w{{static_cast<double>(v[X]), static_cast<double>(v[Y])}};
+        auto it = vertexIds.find(w);
+        if (it == vertexIds.end()) {
+          it = vertexIds.insert(std::make_pair(w, static_cast<uint32_t>(m_vertices.size()))).first;
+          m_vertices.push_back(w);
+        }
+        ids.push_back(it->second);
+      }
+      for(std::size_t i{0}; i < ids.size(); i++) {
+        const uint32_t u{CCW ? ids[i] : ids[(i + 1) % ids.size()]};
+        const uint32_t v{CCW ? ids[(i + 1) % ids.size()] : ids[i]};
+        if (u == v) {
+          continue;
+        }
+        const uint64_t key{(static_cast<uint64_t>((std::min)(u, v)) << 32) | (std::max)(u, v)};
+        auto it = edgeIds.find(key);
+        if (it == edgeIds.end()) {
+          it = edgeIds.insert(std::make_pair(key, static_cast<uint32_t>(m_edges.size()))).first;
+          m_edges.push_back(Edge{(std::min)(u, v), (std::max)(u, v), NONE, NONE});
+        }
+        Edge &e = m_edges[it->second];
+        (u == e.a ? e.left : e.right) = zone;
+      }
+    }
+    if (m_vertices.empty()) {
+      return;
+    }
+
+    m_box = BoundingBox<double>::of(m_vertices);
+    m_cells = (0 < cellsPerAxis) ? cellsPerAxis : (std::max)(1u, static_cast<uint32_t>(std::sqrt(static_cast<double>(m_edges.size()))));
+    std::vector<std::vector<uint32_t>> cells(m_cells * m_cells);
+    for(uint32_t k{0}; k < m_edges.size(); k++) {
+      const auto &u = m_vertices[m_edges[k].a];
+      const auto &v = m_vertices[m_edges[k].b];
+      const uint32_t x0{column((std::min)(u[X], v[X]))};
+      const uint32_t x1{column((std::max)(u[X], v[X]))};
+      const uint32_t y0{row((std::min)(u[Y], v[Y]))};
+      const uint32_t y1{row((std::max)(u[Y], v[Y]))};
+      for(uint32_t y{y0}; y <= y1; y++) {
+        for(uint32_t x{x0}; x <= x1; x++) {
+          std::array<double,2> min{{cellX(x), cellY(y)}};
+          std::array<double,2> max{{cellX(x + 1), cellY(y + 1)}};
+          if (detail::intersects(u, v, min, max)) {
+            cells[y * m_cells + x].push_back(k);
+          }
+        }
+      }
+    }
+    m_cellOffsets.push_back(0);
+    for(const auto &cell : cells) {
+      m_cellEdges.insert(m_cellEdges.end(), cell.begin(), cell.end());
+      m_cellOffsets.push_back(static_cast<uint32_t>(m_cellEdges.size()));
+    }
+  }
+
+  /**
+   * @param p point to locate
+   * @return ID of the zone containing p, or NONE
+   */
+  int32_t zone(const std::array<T,2> &p) const {
+    constexpr const uint8_t X{0};
+    constexpr const uint8_t Y{1};
+    const std::array<double,2> q{{static_cast<double>(p[X]), static_cast<double>(p[Y])}};
+    if (m_cellOffsets.empty() || !m_box.contains(q)) {
+      return NONE;
+    }
+
+    // Walk the grid row to the right until the nearest crossing of the ray is found.
+    const uint32_t y{row(q[Y])};
+    double nearest{(std::numeric_limits<double>::max)()};
+    int32_t result{NONE};
+    for(uint32_t x{column(q[X])}; x < m_cells; x++) {
+      const uint32_t cell{y * m_cells + x};
+      for(uint32_t k{m_cellOffsets[cell]}; k < m_cellOffsets[cell + 1]; k++) {
+        const Edge &e = m_edges[m_cellEdges[k]];
+        const auto &u = m_vertices[e.a];
+        const auto &v = m_vertices[e.b];
+        if ((u[Y] > q[Y]) != (v[Y] > q[Y])) {
+          const double crossing{(u[X]-v[X]) * (q[Y]-v[Y]) / (u[Y]-v[Y]) + v[X]};
+          if (q[X] < crossing && crossing < nearest) {
+            nearest = crossing;
+            // p is west of the edge, which is the left side if the edge points upwards.
+            result = (v[Y] > q[Y]) ? e.left : e.right;
+          }
+        }
+      }
+      if (!(cellX(x + 1) < nearest)) {
+        break;
+      }
+    }
+    return result;
+  }
+
+  /**
+   * @return number of distinct edges
+   */
+  std::size_t edges() const {
+    return m_edges.size();
+  }
+
+  /**
+   * @return number of distinct vertices
+   */
+  std::size_t vertices() const {
+    return m_vertices.size();
+  }
+
+ private:
+  uint32_t column(double x) const {
+    return cell(x, m_box.min[0], m_box.max[0]);
+  }
+
+  uint32_t row(double y) const {
+    return cell(y, m_box.min[1], m_box.max[1]);
+  }
+
+  uint32_t cell(double v, double min, double max) const {
+    const double f{(min < max) ? (v - min) / (max - min) * m_cells : 0};
+    return (std::min)(m_cells - 1, static_cast<uint32_t>((std::max)(0.0, f)));
+  }
+
+  double cellX(uint32_t x) const {
+    return (x == m_cells) ? m_box.max[0] : m_box.min[0] + (m_box.max[0] - m_box.min[0]) * x / m_cells;
+  }
+
+  double cellY(uint32_t y) const {
+    return (y == m_cells) ? m_box.max[1] : m_box.min[1] + (m_box.max[1] - m_box.min[1]) * y / m_cells;
+  }
+
+ private:
+  std::vector<std::array<double,2>> m_vertices;
+  std::vector<Edge> m_edges;
+  BoundingBox<double> m_box;
+  uint32_t m_cells; // per axis
+  std::vector<uint32_t> m_cellOffsets;
+  std::vector<uint32_t> m_cellEdges;
+};
+
+template <typename T>
+constexpr int32_t PartitionIndex<T>::NONE;
+
+/**
+ * Fence store for adjacent polygons such as administrative boundaries, where
+ * every border would otherwise be stored twice. Like TopoJSON, rings are split
+ * at junctions into arcs; an arc shared by neighbouring polygons is stored
+ * once, and each polygon references its arcs by index, or by the bitwise
+ * complement of the index when the arc is traversed in reverse. The query
+ * iterates the arcs directly, skipping every arc whose bounding box cannot be
+ * crossed by the ray from the point, and answers identically to isIn.
+ */
+template <typename T, typename FillRule = EvenOddRule>
+class Topology {
+  static_assert(std::is_arithmetic<T>::value, "T must be an arithmetic type");
+
+ public:
+  struct Arc {
+    std::size_t first; // index of the first vertex
+    std::size_t size;  // number of vertices including both end points
+    BoundingBox<T> box;
+  };
+
+ public:
+  /**
+   * @param polygons rings describing the geofenced areas; their indices are used as polygon IDs
+   */
+  explicit Topology(const std::vector<std::vector<std::array<T,2>>> &polygons)
+    : m_vertices{}
+    , m_arcs{}
+    , m_references{}
+    , m_offsets{} {
+    // Identify vertices and remove repeated consecutive ones.
+    std::map<std::array<T,2>, uint32_t> vertexIds;
+    std::vector<std::array<T,2>> coordinates;
+    std::vector<std::vector<uint32_t>> rings;
+    for(const auto &polygon : polygons) {
+      std::vector<uint32_t> ring;
+      for(const auto &v : polygon) {
+        auto it = vertexIds.find(v);
+        if (it == vertexIds.end()) {
+          it = vertexIds.insert(std::make_pair(v, static_cast<uint32_t>(coordinates.size()))).first;
+          coordinates.push_back(v);
+        }
+        if (ring.empty() || ring.back() != it->second) {
+          ring.push_back(it->second);
+        }
+      }
+      while (1 < ring.size() && ring.front() == ring.back()) {
+        ring.pop_back();
+      }
+      rings.push_back((2 < ring.size()) ? ring : std::vector<uint32_t>{});
+    }
+
+    // Rings sharing an edge.
+    auto key = [](uint32_t a, uint32_t b) {
+      return (static_cast<uint64_t>((std::min)(a, b)) << 32) | (std::max)(a, b);
+    };
+    std::unordered_map<uint64_t, std::vector<uint32_t>> owners;
+    for(uint32_t r{0}; r < rings.size(); r++) {
+      for(std::size_t k{0}; k < rings[r].size(); k++) {
+        auto &o = owners[key(rings[r][k], rings[r][(k + 1) % rings[r].size()])];
+        if (o.empty() || o.back() != r) {
+          o.push_back(r);
+        }
+      }
+    }
+
+    std::map<std::vector<uint32_t>, uint32_t> arcIds;
+    m_offsets.push_back(0);
+    for(const auto &ring : rings) {
+      const std::size_t SIZE{ring.size()};
+      // Junctions are vertices where the set of rings sharing the adjacent edges changes.
+      std::vector<std::size_t> junctions;
+      for(std::size_t k{0}; k < SIZE; k++) {
+        const auto &before = owners[key(ring[(k + SIZE - 1) % SIZE], ring[k])];
+        const auto &after = owners[key(ring[k], ring[(k + 1) % SIZE])];
+        if (before != after) {
+          junctions.push_back(k);
+        }
+      }
+      if (junctions.empty() && 0 < SIZE) {
+        // Closed arc starting at its smallest vertex so that duplicated rings match.
+        junctions.push_back(static_cast<std::size_t>(std::min_element(ring.begin(), ring.end()) - ring.begin()));
+      }
+
+      for(std::size_t j{0}; j < junctions.size(); j++) {
+        const std::size_t begin{junctions[j]};
+        const std::size_t end{junctions[(j + 1) % junctions.size()] + ((1 == junctions.size()) ? SIZE : 0)};
+        std::vector<uint32_t> run;
+        for(std::size_t k{begin}; k <= ((end <= begin) ? end + SIZE : end); k++) {
+          run.push_back(ring[k % SIZE]);
+        }
+        std::vector<uint32_t> reversed(run.rbegin(), run.rend());
+        const bool forward{!(reversed < run)};
+        auto it = arcIds.find(forward ? run : reversed);
+        if (it == arcIds.end()) {
+          it = arcIds.insert(std::make_pair(forward ? run : reversed, static_cast<uint32_t>(m_arcs.size()))).first;
+          Arc arc{m_vertices.size(), run.size(), {coordinates[run.front()], coordinates[run.front()]}};
+          for(uint32_t v : (forward ? run : reversed)) {
+            m_vertices.push_back(coordinates[v]);
+            arc.box.extend(coordinates[v]);
+          }
+          m_arcs.push_back(arc);
+        }
+        const int32_t arc{static_cast<int32_t>(it->second)};
+        m_references.push_back(forward ? arc : ~arc);
+      }
+      m_offsets.push_back(m_references.size());
+    }
+  }
+
+  /**
+   * @param polygon ID of the polygon
+   * @param p point to test whether inside or not
+   * @return true if p is inside the polygon according to FillRule OR when p is any vertex (identical to isIn)
+   */
+  bool isIn(std::size_t polygon, const std::array<T,2> &p) const {
+    constexpr const uint8_t X{0};
+    constexpr const uint8_t Y{1};
+    int32_t counter{0};
+    for(std::size_t r{m_offsets[polygon]}; r < m_offsets[polygon + 1]; r++) {
+      const bool forward{0 <= m_references[r]};
+      const Arc &arc = m_arcs[static_cast<std::size_t>(forward ? m_references[r] : ~m_references[r])];
+      // The ray from p to the right cannot reach this arc.
+      if ( (p[Y] < arc.box.min[Y] && !isEqual(p[Y], arc.box.min[Y])) ||
+           (arc.box.max[Y] < p[Y] && !isEqual(p[Y], arc.box.max[Y])) ||
+           (arc.box.max[X] < p[X] && !isEqual(p[X], arc.box.max[X])) ) {
+        continue;
+      }
+      const std::array<T,2> *vertices{m_vertices.data() + arc.first};
+      for(std::size_t k{1}; k < arc.size; k++) {
+        // Traverse in ring order: i is the later vertex of the edge, j the earlier one.
+        const std::array<T,2> &i = forward ? vertices[k] : vertices[arc.size - 1 - k];
+        const std::array<T,2> &j = forward ? vertices[k - 1] : vertices[arc.size - k];
+        if ( isEqual(p[X], i[X]) && isEqual(p[Y], i[Y]) ) {
+          return true;
+        }
+        if ((i[Y] > p[Y]) != (j[Y] > p[Y])) {
+          FillRule::cross(counter, i, j, p);
+        }
+      }
+    }
+    return FillRule::isInside(counter);
+  }
+
+  /**
+   * @return number of polygons
+   */
+  std::size_t size() const {
+    return m_offsets.size() - 1;
+  }
+
+  /**
+   * @return shared arcs
+   */
+  const std::vector<Arc> &arcs() const {
+    return m_arcs;
+  }
+
+  /**
+   * @param polygon ID of the polygon
+   * @return arc references of polygon in ring order; negative values are complements of reversed arcs
+   */
+  std::vector<int32_t> references(std::size_t polygon) const {
+    return std::vector<int32_t>(m_references.begin() + static_cast<std::ptrdiff_t>(m_offsets[polygon]), m_references.begin() + static_cast<std::ptrdiff_t>(m_offsets[polygon + 1]));
+  }
+
+  /**
+   * @return number of stored vertices
+   */
+  std::size_t vertices() const {
+    return m_vertices.size();
+  }
+
+ private:
+  std::vector<std::array<T,2>> m_vertices;
+  std::vector<Arc> m_arcs;
+  std::vector<int32_t> m_references;
+  std::vector<std::size_t> m_offsets; // first reference of every polygon
+};
+
+namespace detail {
+
+/**
+ * @param x
+ * @param y
+ * @param order the grid has 2^order cells per axis (at most 16)
+ * @return distance of cell (x, y) along the Hilbert curve
+ */
+inline uint32_t hilbertKey(uint32_t x, uint32_t y, uint32_t order) {
+  // Branch-free state machine: for each of the four curve orientations, the
+  // quadrant (2 bits of x and y) maps to the curve's digit and next orientation.
+  static const uint8_t DIGIT[4][4]{{0, 1, 3, 2}, {0, 3, 1, 2}, {2, 3, 1, 0}, {2, 1, 3, 0}};
+  static const uint8_t NEXT[4][4]{{1, 0, 3, 0}, {0, 2, 1, 1}, {2, 1, 2, 3}, {3, 3, 0, 2}};
+  uint32_t key{0};
+  uint32_t state{0};
+  for(uint32_t level{order}; 0 < level; level--) {
+    const uint32_t quadrant{(((x >> (level - 1)) & 1u) << 1) | ((y >> (level - 1)) & 1u)};
+    key = (key << 2) | DIGIT[state][quadrant];
+    state = NEXT[state][quadrant];
+  }
+  return key;
+}
+
+}
+
+/**
+ * Orders points along a Hilbert curve over their bounding box so that points
+ * close to each other in space are visited consecutively. Keys are sorted by
+ * radix sort in O(n).
+ * @param points
+ * @param order resolution of the curve with 2^order cells per axis (at most 16)
+ * @return indices into points in Hilbert order
+ */
+template <typename T>
+inline std::vector<uint32_t> hilbertOrder(const std::vector<std::array<T,2>> &points, uint32_t order = 10) {
+  static_assert(std::is_arithmetic<T>::value, "T must be an arithmetic type");
+  constexpr const uint8_t X{0};
+  constexpr const uint8_t Y{1};
+  order = (std::min)(order, 16u);
+  std::vector<uint32_t> indices(points.size());
+  if (points.empty()) {
+    return indices;
+  }
+
+  const auto box = BoundingBox<T>::of(points);
+  const double CELLS{static_cast<double>(1u << order)};
+  const double width{static_cast<double>(box.max[X]) - static_cast<double>(box.min[X])};
+  const double height{static_cast<double>(box.max[Y]) - static_cast<double>(box.min[Y])};
+  auto cell = [CELLS](double offset, double extent) {
+    return (0 < extent) ? static_cast<uint32_t>((std::min)(CELLS - 1, offset / extent * CELLS)) : 0u;
+  };
+  std::vector<uint32_t> keys(points.size());
+  for(std::size_t i{0}; i < points.size(); i++) {
+    keys[i] = detail::hilbertKey(cell(static_cast<double>(points[i][X]) - static_cast<double>(box.min[X]), width),
+                                 cell(static_cast<double>(points[i][Y]) - static_cast<double>(box.min[Y]), height), order);
+    indices[i] = static_cast<uint32_t>(i);
+  }
+
+  // LSD radix sort over 11-bit digits; 2048 buckets keep the scatter targets in cache.
+  constexpr const uint32_t DIGIT{11};
+  std::vector<uint32_t> sortedKeys(keys.size());
+  std::vector<uint32_t> sortedIndices(indices.size());
+  std::vector<std::size_t> offsets((1u << DIGIT) + 1);
+  for(uint32_t shift{0}; shift < 2 * order; shift += DIGIT) {
+    std::fill(offsets.begin(), offsets.end(), 0);
+    for(uint32_t k : keys) {
+      offsets[((k >> shift) & ((1u << DIGIT) - 1)) + 1]++;
+    }
+    for(std::size_t b{1}; b < offsets.size(); b++) {
+      offsets[b] += offsets[b - 1];
+    }
+    for(std::size_t i{0}; i < keys.size(); i++) {
+      const std::size_t to{offsets[(keys[i] >> shift) & ((1u << DIGIT) - 1)]++};
+      sortedKeys[to] = keys[i];
+      sortedIndices[to] = indices[i];
+    }
+    keys.swap(sortedKeys);
+    indices.swap(sortedIndices);
+  }
+  return indices;
+}
+
+/**
+ * Evaluates query for a batch of points in Hilbert order, so that consecutive
+ * queries touch the same index nodes and polygons, and scatters the results
+ * back to the original order.
+ * @param points
+ * @param query callable returning the result for one point, e.g., a lambda calling isIn of a prepared engine
+ * @param results resized to points.size(); results[i] is the result for points[i]
+ */
+template <typename T, typename Query, typename Result>
+inline void queryBatch(const std::vector<std::array<T,2>> &points, Query &&query, std::vector<Result> &results) {
+  results.resize(points.size());
+  for(uint32_t i : hilbertOrder(points)) {
+    results[i] = query(points[i]);
+  }
+}
+
+/**
+ * Plane-sweep classification of many points against one large simple polygon.
+ * Edges are sorted once by their lower and upper end points. A sweep moves
+ * upwards through the points in y order and keeps the edges straddling the
+ * sweep line in an active list ordered by x; since the edges of a simple
+ * polygon do not cross, the order stays valid between events. All edges
+ * starting or ending between two consecutive points are merged into the list
+ * in one linear pass rather than one insertion or removal each. The crossings
+ * to the right of a point follow from its position in the active list, which
+ * is found by binary search. Answers are identical to isIn; with NonZeroRule
+ * the edges right of the point are visited to sum their directions.
+ */
+template <typename T, typename FillRule = EvenOddRule>
+class SweepClassifier {
+  static_assert(std::is_arithmetic<T>::value, "T must be an arithmetic type");
+
+  struct Edge {
+    std::array<T,2> i; // later vertex in ring order
+    std::array<T,2> j; // earlier vertex in ring order
+    double yMin;
+    double yMax;
+    double xBottom;    // x at yMin
+    double xTop;       // x at yMax
+    double slope;      // dx/dy
+
+    double x(double y) const {
+      return xBottom + (y - yMin) * slope;
+    }
+  };
+
+ public:
+  /**
+   * Sweep over points given in non-decreasing y order; keeps its state between
+   * calls so that arbitrarily many points can be streamed from an external
+   * sort in chunks that do not fit into memory at once.
+   */
+  class Sweep {
+   public:
+    explicit Sweep(const SweepClassifier &classifier)
+      : m_classifier(classifier)
+      , m_active{}
+      , m_added{}
+      , m_merged{}
+      , m_inserted(classifier.m_edges.size(), false)
+      , m_nextBottom{0}
+      , m_nextTop{0}
+      , m_nextVertex{0}
+      , m_y{-(std::numeric_limits<double>::infinity)()} {
+    }
+
+    /**
+     * @param p point to test whether inside or not; y must not be less than the y of the previous point
+     * @return true if p is inside the polygon according to FillRule OR when p is any vertex (identical to isIn)
+     * @throws std::invalid_argument if y is less than the y of the previous point, as edges already passed are not revisited
+     */
+    bool isIn(const std::array<T,2> &p) {
+      constexpr const uint8_t X{0};
+      constexpr const uint8_t Y{1};
+      const double y{static_cast<double>(p[Y])};
+      if (y < m_y) {
+        throw std::invalid_argument("geofence::SweepClassifier: points not sorted by y");
+      }
+      m_y = y;
+      advance(y);
+
+      // Vertices are sorted by y as well; only those within isEqual's tolerance of p are compared.
+      const auto &vertices = m_classifier.m_vertices;
+      const double tolerance{2.0e-9 * (std::max)(1.0, std::abs(y))};
+      while (m_nextVertex < vertices.size() && static_cast<double>(vertices[m_nextVertex][Y]) < y - tolerance) {
+        m_nextVertex++;
+      }
+      for(std::size_t v{m_nextVertex}; v < vertices.size() && !(y + tolerance < static_cast<double>(vertices[v][Y])); v++) {
+        if ( isEqual(p[X], vertices[v][X]) && isEqual(p[Y], vertices[v][Y]) ) {
+          return true;
+        }
+      }
+
+      const auto &edges = m_classifier.m_edges;
+      auto first = std::partition_point(m_active.begin(), m_active.end(), [&edges, &p](uint32_t e) {
+        int32_t right{0};
+        FillRule::cross(right, edges[e].i, edges[e].j, p);
+        return 0 == right;
+      });
+      int32_t counter{0};
+      if (FillRule::ORIENTED) {
+        for(; first != m_active.end(); ++first) {
+          FillRule::cross(counter, edges[*first].i, edges[*first].j, p);
+        }
+      }
+      else {
+        counter = static_cast<int32_t>((m_active.end() - first) & 1);
+      }
+      return FillRule::isInside(counter);
+    }
+
+   private:
+    void advance(double y) {
+      const auto &edges = m_classifier.m_edges;
+      const auto &byTop = m_classifier.m_byTop;
+      // Unmark edges ending at or below y; they are dropped from the active list in one pass below.
+      bool removed{false};
+      for(; m_nextTop < byTop.size() && !(y < edges[byTop[m_nextTop]].yMax); m_nextTop++) {
+        const uint32_t e{byTop[m_nextTop]};
+        removed = removed || m_inserted[e];
+        m_inserted[e] = false;
+      }
+      if (removed) {
+        m_active.erase(std::remove_if(m_active.begin(), m_active.end(), [this](uint32_t e) {
+          return !m_inserted[e];
+        }), m_active.end());
+      }
+      // Collect edges starting at or below y and still straddling it.
+      m_added.clear();
+      for(; m_nextBottom < edges.size() && !(y < edges[m_nextBottom].yMin); m_nextBottom++) {
+        if (y < edges[m_nextBottom].yMax) {
+          m_added.push_back(static_cast<uint32_t>(m_nextBottom));
+          m_inserted[m_nextBottom] = true;
+        }
+      }
+      if (m_added.empty()) {
+        return;
+      }
+      // Order by x at y, ties (edges leaving a common lower vertex) by direction.
+      const auto byX = [&edges, y](uint32_t lhs, uint32_t rhs) {
+        const double l{edges[lhs].x(y)};
+        const double r{edges[rhs].x(y)};
+        return (l < r) || (!(r < l) && edges[lhs].slope < edges[rhs].slope);
+      };
+      std::sort(m_added.begin(), m_added.end(), byX);
+      m_merged.resize(m_active.size() + m_added.size());
+      std::merge(m_active.begin(), m_active.end(), m_added.begin(), m_added.end(), m_merged.begin(), byX);
+      m_active.swap(m_merged);
+    }
+
+   private:
+    const SweepClassifier &m_classifier;
+    std::vector<uint32_t> m_active; // edges straddling the sweep line ordered by x
+    std::vector<uint32_t> m_added;  // edges entering the active list in the current step
+    std::vector<uint32_t> m_merged; // buffer for merging m_added into m_active
+    std::vector<bool> m_inserted;   // edges in the active list
+    std::size_t m_nextBottom;       // next edge to insert
+    std::size_t m_nextTop;          // next edge to remove
+    std::size_t m_nextVertex;
+    double m_y;                     // y of the previous point
+  };
+
+ public:
+  /**
+   * @param polygon describing a geofenced area; its edges must not cross each other
+   */
+  explicit SweepClassifier(const std::vector<std::array<T,2>> &polygon)
+    : m_edges{}
+    , m_byTop{}
+    , m_vertices{} {
+    constexpr const uint8_t X{0};
+    constexpr const uint8_t Y{1};
+    // As isIn, rings with less than three vertices contain nothing, not even their vertices.
+    if (polygon.size() < 3) {
+      return;
+    }
+    m_vertices = polygon;
+    for(std::size_t i{0}, j{polygon.size() - 1}; i < polygon.size(); j = i++) {
+      const std::array<double,2> a{{static_cast<double>(polygon[i][X]), static_cast<double>(polygon[i][Y])}};
+      const std::array<double,2> b{{static_cast<double>(polygon[j][X]), static_cast<double>(polygon[j][Y])}};
+      // Horizontal edges never straddle a point.
+      if (!(a[Y] < b[Y]) && !(b[Y] < a[Y])) {
+        continue;
+      }
+      const auto &bottom = (a[Y] < b[Y]) ? a : b;
+      const auto &top = (a[Y] < b[Y]) ? b : a;
+      m_edges.push_back(Edge{polygon[i], polygon[j], bottom[Y], top[Y], bottom[X], top[X], (top[X] - bottom[X]) / (top[Y] - bottom[Y])});
+    }
+    std::sort(m_edges.begin(), m_edges.end(), [](const Edge &lhs, const Edge &rhs) {
+      return lhs.yMin < rhs.yMin;
+    });
+    for(uint32_t e{0}; e < m_edges.size(); e++) {
+      m_byTop.push_back(e);
+    }
+    std::sort(m_byTop.begin(), m_byTop.end(), [this](uint32_t lhs, uint32_t rhs) {
+      return m_edges[lhs].yMax < m_edges[rhs].yMax;
+    });
+    std::sort(m_vertices.begin(), m_vertices.end(), [](const std::array<T,2> &lhs, const std::array<T,2> &rhs) {
+      return lhs[1] < rhs[1];
+    });
+  }
+
+  /**
+   * Sorts a batch of points by y and sweeps over it once. For inputs larger
+   * than memory, sort the points externally and stream them through a Sweep.
+   * @param points
+   * @param results resized to points.size(); results[i] is true if points[i] is inside (identical to isIn)
+   */
+  void classify(const std::vector<std::array<T,2>> &points, std::vector<bool> &results) const {
+    std::vector<uint32_t> order(points.size());
+    for(uint32_t k{0}; k < order.size(); k++) {
+      order[k] = k;
+    }
+    std::sort(order.begin(), order.end(), [&points](uint32_t lhs, uint32_t rhs) {
+      return points[lhs][1] < points[rhs][1];
+    });
+    results.assign(points.size(), false);
+    Sweep sweep{*this};
+    for(uint32_t k : order) {
+      results[k] = sweep.isIn(points[k]);
+    }
+  }
+
+  /**
+   * @return number of non-horizontal edges
+   */
+  std::size_t edges() const {
+    return m_edges.size();
+  }
+
+ private:
+  std::vector<Edge> m_edges;      // sorted by lower end
+  std::vector<uint32_t> m_byTop;  // edge indices sorted by upper end
+  std::vector<std::array<T,2>> m_vertices; // sorted by y
+};
+
+/**
+ * Fixed set of worker threads executing index ranges of a parallel loop.
+ * Every worker owns a queue of ranges; it takes ranges from the front of its
+ * own queue and, once empty, steals from the back of other workers' queues, so
+ * that a few expensive ranges (dense urban tiles next to rural ones) do not
+ * leave the other workers idle. Queues have their own locks so that workers
+ * only contend while stealing.
+ */
+class ThreadPool {
+  struct Range {
+    std::size_t begin;
+    std::size_t end;
+  };
+
+  struct Queue {
+    Queue()
+      : mutex{}
+      , ranges{} {
+    }
+
+    std::mutex mutex;
+    std::deque<Range> ranges;
+  };
+
+ public:
+  /**
+   * @param threads number of workers; 0 to use one per hardware thread
+   * @throws std::system_error if a worker cannot be started; the workers already started are joined
+   */
+  explicit ThreadPool(std::size_t threads = 0)
+    : m_queues{}
+    , m_workers{}
+    , m_job{}
+    , m_submit{}
+    , m_mutex{}
+    , m_wake{}
+    , m_done{}
+    , m_queued{0}
+    , m_pending{0}
+    , m_stop{false}
+    , m_error{} {
+    const std::size_t SIZE{(0 < threads) ? threads : (std::max)(1u, std::thread::hardware_concurrency())};
+    for(std::size_t w{0}; w < SIZE; w++) {
+      m_queues.push_back(std::unique_ptr<Queue>(new Queue()));
+    }
+    // Reserved up front so that only starting a thread can throw.
+    m_workers.reserve(SIZE);
+    try {
+      for(std::size_t w{0}; w < SIZE; w++) {
+        m_workers.emplace_back(&ThreadPool::work, this, w);
+      }
+    }
+    catch(const std::system_error &) {
+      stop();
+      throw;
+    }
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  ~ThreadPool() {
+    stop();
+  }
+
+  /**
+   * @return number of workers
+   */
+  std::size_t size() const {
+    return m_workers.size();
+  }
+
+  /**
+   * Calls task(begin, end, worker) for consecutive ranges of at most grain
+   * indices covering [0, count) and blocks until all have finished. Ranges are
+   * dealt to the workers in contiguous blocks and rebalanced by stealing.
+   * Calls from several threads are serialized; task must not call parallelFor.
+   * @param count number of indices
+   * @param grain maximum number of indices per range; small enough to balance skewed work
+   * @param task callable taking begin, end, and the worker index in [0, size())
+   */
+  template <typename Task>
+  void parallelFor(std::size_t count, std::size_t grain, Task &&task) {
+    if (0 == count) {
+      return;
+    }
+    std::lock_guard<std::mutex> submit(m_submit);
+    grain = (std::max)(std::size_t{1}, grain);
+    const std::size_t RANGES{(count + grain - 1) / grain};
+    m_job = std::forward<Task>(task);
+    m_error = nullptr;
+    m_pending = RANGES;
+    for(std::size_t w{0}; w < m_queues.size(); w++) {
+      std::lock_guard<std::mutex> lock(m_queues[w]->mutex);
+      for(std::size_t r{RANGES * w / m_queues.size()}; r < RANGES * (w + 1) / m_queues.size(); r++) {
+        m_queues[w]->ranges.push_back(Range{r * grain, (std::min)(count, (r + 1) * grain)});
+      }
+    }
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_queued += static_cast<std::ptrdiff_t>(RANGES);
+    m_wake.notify_all();
+    m_done.wait(lock, [this]() {
+      return 0 == m_pending;
+    });
+    m_job = nullptr;
+    if (m_error) {
+      std::rethrow_exception(m_error);
+    }
+  }
+
+ private:
+  bool take(std::size_t worker, Range &range) {
+    for(std::size_t k{0}; k < m_queues.size(); k++) {
+      Queue &queue = *m_queues[(worker + k) % m_queues.size()];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      if (!queue.ranges.empty()) {
+        // Own ranges in order, stolen ones from the far end of the victim's block.
+        if (0 == k) {
+          range = queue.ranges.front();
+          queue.ranges.pop_front();
+        }
+        else {
+          range = queue.ranges.back();
+          queue.ranges.pop_back();
+        }
+        m_queued--;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void stop() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_wake.notify_all();
+    for(auto &worker : m_workers) {
+      worker.join();
+    }
+  }
+
+  void work(std::size_t worker) {
+    Range range{0, 0};
+    for(;;) {
+      if (take(worker, range)) {
+        try {
+          m_job(range.begin, range.end, worker);
+        }
+        catch(...) {
+          std::lock_guard<std::mutex> lock(m_mutex);
+          if (!m_error) {
+            m_error = std::current_exception();
+          }
+        }
+        if (1 == m_pending.fetch_sub(1)) {
+          std::lock_guard<std::mutex> lock(m_mutex);
+          m_done.notify_all();
+        }
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_wake.wait(lock, [this]() {
+        return m_stop || 0 < m_queued;
+      });
+      if (m_stop) {
+        return;
+      }
+    }
+  }
+
+ private:
+  std::vector<std::unique_ptr<Queue>> m_queues;
+  std::vector<std::thread> m_workers;
+  std::function<void(std::size_t, std::size_t, std::size_t)> m_job;
+  std::mutex m_submit;  // serializes parallelFor
+  std::mutex m_mutex;   // guards waiting and m_error
+  std::condition_variable m_wake;
+  std::condition_variable m_done;
+  std::atomic<std::ptrdiff_t> m_queued;  // ranges in all queues; may be negative until a submission is counted
+  std::atomic<std::size_t> m_pending;    // ranges of the current loop not yet finished
+  bool m_stop;
+  std::exception_ptr m_error;
+};
+
+/**
+ * Parallel version of queryBatch: evaluates query for every point on the
+ * workers of pool in chunks of grain points.
+ * @param pool
+ * @param points
+ * @param query callable returning the result for one point; called concurrently
+ * @param results resized to points.size(); results[i] is the result for points[i]
+ * @param grain number of points per task
+ */
+template <typename T, typename Query, typename Result>
+inline void queryBatch(ThreadPool &pool, const std::vector<std::array<T,2>> &points, Query &&query, std::vector<Result> &results, std::size_t grain = 4096) {
+  static_assert(!std::is_same<Result, bool>::value, "std::vector<bool> cannot be written concurrently; use uint8_t");
+  results.resize(points.size());
+  pool.parallelFor(points.size(), grain, [&points, &query, &results](std::size_t begin, std::size_t end, std::size_t) {
+    for(std::size_t i{begin}; i < end; i++) {
+      results[i] = query(points[i]);
+    }
+  });
+}
+
+/**
+ * Spatial join of points and fences on the workers of pool. Every worker
+ * appends its matches to its own buffer, so that no synchronization is needed
+ * while joining; the buffers are concatenated and sorted at the end.
+ * @param pool
+ * @param points
+ * @param fences rings describing the geofenced areas; their indices are used as fence IDs
+ * @param grain number of points per task
+ * @return pairs of point index and fence index for every point inside a fence according to FillRule (as isIn), sorted
+ */
+template <typename T, typename FillRule = EvenOddRule>
+inline std::vector<std::array<uint32_t,2>> join(ThreadPool &pool, const std::vector<std::array<T,2>> &points, const std::vector<std::vector<std::array<T,2>>> &fences, std::size_t grain = 1024) {
+  std::vector<BoundingBox<T>> boxes;
+  for(const auto &fence : fences) {
+    boxes.push_back(BoundingBox<T>::of(fence));
+  }
+  std::vector<std::vector<std::array<uint32_t,2>>> buffers(pool.size());
+  pool.parallelFor(points.size(), grain, [&points, &fences, &boxes, &buffers](std::size_t begin, std::size_t end, std::size_t worker) {
+    auto &buffer = buffers[worker];
+    for(std::size_t i{begin}; i < end; i++) {
+      const std::array<T,2> &p = points[i];
+      for(std::size_t f{0}; f < fences.size(); f++) {
+        int32_t counter{0};
+        if ( boxes[f].contains(p) && (2 < fences[f].size()) &&
+             (detail::walkRing<FillRule>(fences[f].data(), fences[f].size(), p, counter) || FillRule::isInside(counter)) ) {
+          buffer.push_back(std::array<uint32_t,2>{{static_cast<uint32_t>(i), static_cast<uint32_t>(f)}});
+        }
+      }
+    }
+  });
+  std::vector<std::array<uint32_t,2>> pairs;
+  for(const auto &buffer : buffers) {
+    pairs.insert(pairs.end(), buffer.begin(), buffer.end());
+  }
+  std::sort(pairs.begin(), pairs.end());
+  return pairs;
+}
+
+/**
+ * Columnar, appendable output of a spatial join: the i-th match is
+ * (points[i], fences[i]). Chunks of a join are appended without allocating
+ * per point.
+ */
+struct JoinPairs {
+  JoinPairs()
+    : points{}
+    , fences{} {
+  }
+
+  std::vector<uint64_t> points;
+  std::vector<uint32_t> fences;
+
+  /**
+   * @return number of pairs
+   */
+  std::size_t size() const {
+    return points.size();
+  }
+
+  void clear() {
+    points.clear();
+    fences.clear();
+  }
+
+  /**
+   * @param other pairs to append
+   */
+  void append(const JoinPairs &other) {
+    points.insert(points.end(), other.points.begin(), other.points.end());
+    fences.insert(fences.end(), other.fences.begin(), other.fences.end());
+  }
+};
+
+/**
+ * Tiled spatial join of a points table and a fences table. Space is cut into
+ * a uniform grid of tiles and every fence is assigned to all tiles its
+ * bounding box overlaps. Points are bucketed by tile, so that every point
+ * belongs to exactly one tile and no pair is reported twice across tile
+ * borders. Tiles are joined in parallel, the most populated first, with the
+ * engine chosen at construction:
+ *   BOXES: the tile's fence boxes are scanned linearly
+ *   TREE:  the tile's fence boxes are indexed by a packed R-tree
+ *   SWEEP: every fence sweeps over the tile's points sorted by y (simple fences only)
+ * Pairs are identical to testing every point with isIn against every fence.
+ */
+template <typename T, typename FillRule = EvenOddRule>
+class SpatialJoin {
+  static_assert(std::is_arithmetic<T>::value, "T must be an arithmetic type");
+
+ public:
+  enum class Engine { BOXES, TREE, SWEEP };
+
+ private:
+  struct Tile {
+    Tile()
+      : fences{}
+      , tree{} {
+    }
+
+    std::vector<uint32_t> fences;          // in leaf order when using TREE
+    detail::PackedBoxTree<T> tree;
+  };
+
+ public:
+  /**
+   * @param fences rings describing the geofenced areas; their indices are used as fence IDs
+   * @param engine used to join a tile
+   * @param tilesPerAxis resolution of the tile grid; 0 to derive it from the number of fences
+   */
+  explicit SpatialJoin(const std::vector<std::vector<std::array<T,2>>> &fences, Engine engine = Engine::TREE, uint32_t tilesPerAxis = 0)
+    : m_fences{fences}
+    , m_boxes{}
+    , m_engine{engine}
+    , m_box{BoundingBox<T>::empty()}
+    , m_tilesPerAxis{1}
+    , m_tiles{}
+    , m_sweeps{} {
+    constexpr const uint8_t X{0};
+    constexpr const uint8_t Y{1};
+    for(const auto &fence : m_fences) {
+      m_boxes.push_back((2 < fence.size()) ? BoundingBox<T>::of(fence) : BoundingBox<T>::empty());
+      m_box.extend(m_boxes.back());
+      if (Engine::SWEEP == m_engine) {
+        m_sweeps.push_back(SweepClassifier<T, FillRule>(fence));
+      }
+    }
+    if (m_box.isEmpty()) {
+      return;
+    }
+
+    m_tilesPerAxis = (0 < tilesPerAxis) ? tilesPerAxis : (std::max)(1u, static_cast<uint32_t>(std::sqrt(static_cast<double>(m_fences.size()))));
+    m_tiles.resize(static_cast<std::size_t>(m_tilesPerAxis) * m_tilesPerAxis);
+    for(uint32_t f{0}; f < m_fences.size(); f++) {
+      if (3 > m_fences[f].size()) {
+        continue;
+      }
+      for(uint32_t y{row(m_boxes[f].min[Y])}; y <= row(m_boxes[f].max[Y]); y++) {
+        for(uint32_t x{column(m_boxes[f].min[X])}; x <= column(m_boxes[f].max[X]); x++) {
+          m_tiles[y * m_tilesPerAxis + x].fences.push_back(f);
+        }
+      }
+    }
+    if (Engine::TREE == m_engine) {
+      for(auto &tile : m_tiles) {
+        std::vector<BoundingBox<T>> boxes;
+        for(uint32_t f : tile.fences) {
+          boxes.push_back(m_boxes[f]);
+        }
+        std::vector<uint32_t> ordered;
+        for(std::size_t k : tile.tree.build(boxes)) {
+          ordered.push_back(tile.fences[k]);
+        }
+        tile.fences.swap(ordered);
+      }
+    }
+  }
+
+  /**
+   * Joins a chunk of the points table and appends all matches to pairs.
+   * @param pool workers to join the tiles on
+   * @param points chunk of points
+   * @param pairs receives (firstPoint + index into points, fence ID) for every point inside a fence
+   * @param firstPoint ID of points[0] when streaming the points table in chunks
+   */
+  void join(ThreadPool &pool, const std::vector<std::array<T,2>> &points, JoinPairs &pairs, uint64_t firstPoint = 0) const {
+    std::vector<JoinPairs> buffers(pool.size());
+    forEachPair(pool, points, [&buffers, firstPoint](std::size_t worker, uint32_t point, uint32_t fence) {
+      buffers[worker].points.push_back(firstPoint + point);
+      buffers[worker].fences.push_back(fence);
+    });
+    for(const auto &buffer : buffers) {
+      pairs.append(buffer);
+    }
+  }
+
+  /**
+   * Counts the points inside every fence without materializing pairs; every
+   * worker increments its own counters, which are summed at the end.
+   * @param pool workers to join the tiles on
+   * @param points chunk of points
+   * @param counts incremented by the number of points inside each fence; resized to the number of fences if smaller
+   */
+  void count(ThreadPool &pool, const std::vector<std::array<T,2>> &points, std::vector<uint64_t> &counts) const {
+    count(pool, points, std::vector<uint32_t>(), 1, counts);
+  }
+
+  /**
+   * Counts the points inside every fence per bucket (e.g., hour of the day)
+   * without materializing pairs.
+   * @param pool workers to join the tiles on
+   * @param points chunk of points
+   * @param buckets bucket in [0, bucketCount) of every point; empty to count all points in bucket 0
+   * @param bucketCount number of buckets per fence
+   * @param counts counts[fence * bucketCount + bucket] is incremented for every point inside a fence; resized if smaller
+   * @throws std::invalid_argument if bucketCount is zero, or buckets is neither empty nor has a bucket in range for every point
+   */
+  void count(ThreadPool &pool, const std::vector<std::array<T,2>> &points, const std::vector<uint32_t> &buckets, uint32_t bucketCount, std::vector<uint64_t> &counts) const {
+    // Workers index their counters with the buckets unchecked.
+    if (0 == bucketCount) {
+      throw std::invalid_argument("geofence::SpatialJoin: no buckets");
+    }
+    if (!buckets.empty() && (buckets.size() != points.size())) {
+      throw std::invalid_argument("geofence::SpatialJoin: number of buckets differs from number of points");
+    }
+    if (std::any_of(buckets.begin(), buckets.end(), [bucketCount](uint32_t bucket) { return !(bucket < bucketCount); })) {
+      throw std::invalid_argument("geofence::SpatialJoin: bucket out of range");
+    }
+    const std::size_t SIZE{m_fences.size() * bucketCount};
+    counts.resize((std::max)(counts.size(), SIZE), 0);
+    std::vector<std::vector<uint32_t>> counters(pool.size());
+    forEachPair(pool, points, [&counters, &buckets, bucketCount, SIZE](std::size_t worker, uint32_t point, uint32_t fence) {
+      auto &counter = counters[worker];
+      if (counter.empty()) {
+        counter.resize(SIZE, 0);
+      }
+      counter[static_cast<std::size_t>(fence) * bucketCount + (buckets.empty() ? 0 : buckets[point])]++;
+    });
+    for(const auto &counter : counters) {
+      for(std::size_t k{0}; k < counter.size(); k++) {
+        counts[k] += counter[k];
+      }
+    }
+  }
+
+  /**
+   * @return number of tiles
+   */
+  std::size_t tiles() const {
+    return m_tiles.size();
+  }
+
+ private:
+  /**
+   * Buckets the points by tile and joins the tiles in parallel.
+   * @param visit callable taking the worker index, the index into points, and the fence ID of every match
+   */
+  template <typename Visit>
+  void forEachPair(ThreadPool &pool, const std::vector<std::array<T,2>> &points, Visit &&visit) const {
+    constexpr const uint8_t X{0};
+    constexpr const uint8_t Y{1};
+    if (m_tiles.empty()) {
+      return;
+    }
+
+    // Bucket the points by tile (counting sort).
+    const uint32_t NONE{static_cast<uint32_t>(m_tiles.size())};
+    std::vector<uint32_t> tileOf(points.size());
+    std::vector<uint32_t> offsets(m_tiles.size() + 2, 0);
+    for(std::size_t i{0}; i < points.size(); i++) {
+      tileOf[i] = m_box.contains(points[i]) ? row(points[i][Y]) * m_tilesPerAxis + column(points[i][X]) : NONE;
+      offsets[tileOf[i] + 1]++;
+    }
+    for(std::size_t t{1}; t < offsets.size(); t++) {
+      offsets[t] += offsets[t - 1];
+    }
+    std::vector<uint32_t> bucketed(points.size());
+    {
+      std::vector<uint32_t> next(offsets.begin(), offsets.end() - 1);
+      for(uint32_t i{0}; i < points.size(); i++) {
+        bucketed[next[tileOf[i]]++] = i;
+      }
+    }
+
+    // Most populated tiles first so that stragglers are small.
+    std::vector<uint32_t> tiles;
+    for(uint32_t t{0}; t < m_tiles.size(); t++) {
+      if ((offsets[t] < offsets[t + 1]) && !m_tiles[t].fences.empty()) {
+        tiles.push_back(t);
+      }
+    }
+    std::sort(tiles.begin(), tiles.end(), [&offsets](uint32_t lhs, uint32_t rhs) {
+      return offsets[rhs + 1] - offsets[rhs] < offsets[lhs + 1] - offsets[lhs];
+    });
+
+    pool.parallelFor(tiles.size(), 1, [this, &points, &tiles, &offsets, &bucketed, &visit](std::size_t begin, std::size_t end, std::size_t worker) {
+      for(std::size_t k{begin}; k < end; k++) {
+        const uint32_t t{tiles[k]};
+        joinTile(m_tiles[t], points, bucketed.data() + offsets[t], offsets[t + 1] - offsets[t], [&visit, worker](uint32_t point, uint32_t fence) {
+          visit(worker, point, fence);
+        });
+      }
+    });
+  }
+
+  bool contains(uint32_t fence, const std::array<T,2> &p) const {
+    int32_t counter{0};
+    return m_boxes[fence].contains(p) &&
+           (detail::walkRing<FillRule>(m_fences[fence].data(), m_fences[fence].size(), p, counter) || FillRule::isInside(counter));
+  }
+
+  template <typename Emit>
+  void joinTile(const Tile &tile, const std::vector<std::array<T,2>> &points, const uint32_t *indices, std::size_t count, Emit &&emit) const {
+    constexpr const uint8_t X{0};
+    constexpr const uint8_t Y{1};
+    if (Engine::SWEEP == m_engine) {
+      std::vector<uint32_t> byY(indices, indices + count);
+      std::sort(byY.begin(), byY.end(), [&points](uint32_t lhs, uint32_t rhs) {
+        return points[lhs][Y] < points[rhs][Y];
+      });
+      for(uint32_t f : tile.fences) {
+        const auto &box = m_boxes[f];
+        auto it = std::lower_bound(byY.begin(), byY.end(), box.min[Y], [&points](uint32_t i, T y) {
+          return points[i][Y] < y;
+        });
+        typename SweepClassifier<T, FillRule>::Sweep sweep{m_sweeps[f]};
+        for(; it != byY.end() && !(box.max[Y] < points[*it][Y]); ++it) {
+          if (!(points[*it][X] < box.min[X]) && !(box.max[X] < points[*it][X]) && sweep.isIn(points[*it])) {
+            emit(*it, f);
+          }
+        }
+      }
+      return;
+    }
+
+    for(std::size_t k{0}; k < count; k++) {
+      const std::array<T,2> &p = points[indices[k]];
+      if (Engine::TREE == m_engine) {
+        tile.tree.query(p, [this, &tile, &p, &emit, &indices, k](std::size_t group) {
+          const std::size_t END{(std::min)(tile.fences.size(), (group + 1) * detail::PackedBoxTree<T>::FANOUT)};
+          for(std::size_t g{group * detail::PackedBoxTree<T>::FANOUT}; g < END; g++) {
+            if (contains(tile.fences[g], p)) {
+              emit(indices[k], tile.fences[g]);
+            }
+          }
+          return false;
+        });
+      }
+      else {
+        for(uint32_t f : tile.fences) {
+          if (contains(f, p)) {
+            emit(indices[k], f);
+          }
+        }
+      }
+    }
+  }
+
+  uint32_t column(T x) const {
+    return cell(x, m_box.min[0], m_box.max[0]);
+  }
+
+  uint32_t row(T y) const {
+    return cell(y, m_box.min[1], m_box.max[1]);
+  }
+
+  uint32_t cell(T v, T min, T max) const {
+    const double f{(min < max) ? (static_cast<double>(v) - static_cast<double>(min)) / (static_cast<double>(max) - static_cast<double>(min)) * m_tilesPerAxis : 0};
+    return (std::min)(m_tilesPerAxis - 1, static_cast<uint32_t>((std::max)(0.0, f)));
+  }
+
+ private:
+  std::vector<std::vector<std::array<T,2>>> m_fences;
+  std::vector<BoundingBox<T>> m_boxes;
+  Engine m_engine;
+  BoundingBox<T> m_box;
+  uint32_t m_tilesPerAxis;
+  std::vector<Tile> m_tiles;
+  std::vector<SweepClassifier<T, FillRule>> m_sweeps;
+};
+
+/**
+ * Versioned registry of an immutable prepared index (e.g., an ArrangementIndex
+ * of all fences) that is replaced while queries are running. Readers pin the
+ * current snapshot without locking: they announce the global epoch in their
+ * own slot and load the snapshot pointer. Writers build the next index in the
+ * background, swap the pointer atomically, and retire the old snapshot with
+ * the current epoch; a retired snapshot is deleted once every active reader
+ * has announced a later epoch (epoch-based reclamation).
+ */
+template <typename Index>
+class Registry {
+  static constexpr uint64_t IDLE{(std::numeric_limits<uint64_t>::max)()};
+
+  struct Version {
+    std::unique_ptr<const Index> index;
+    uint64_t number;
+  };
+
+  struct Retired {
+    const Version *version;
+    uint64_t epoch; // readers that announced a later epoch cannot hold it
+  };
+
+  static constexpr std::size_t CACHE_LINE{64};
+
+  // Aligned and padded to a cache line so that readers do not invalidate each
+  // other's slots.
+  struct alignas(CACHE_LINE) Slot {
+    Slot()
+      : epoch{IDLE}
+      , claimed{false}
+      , padding{} {
+    }
+
+    std::atomic<uint64_t> epoch;
+    std::atomic<bool> claimed;
+    char padding[CACHE_LINE - sizeof(std::atomic<uint64_t>) - sizeof(std::atomic<bool>)];
+  };
+  static_assert(sizeof(Slot) == CACHE_LINE, "reader slot must fill one cache line");
+
+ public:
+  class Reader;
+
+  /**
+   * Pinned snapshot; the index stays valid until the Snapshot is destroyed.
+   */
+  class Snapshot {
+   public:
+    Snapshot(const Snapshot &) = delete;
+    Snapshot &operator=(const Snapshot &) = delete;
+
+    Snapshot(Snapshot &&other)
+      : m_slot{other.m_slot}
+      , m_version{other.m_version} {
+      other.m_slot = nullptr;
+    }
+
+    ~Snapshot() {
+      if (nullptr != m_slot) {
+        m_slot->epoch = IDLE;
+      }
+    }
+
+    const Index &operator*() const {
+      return *m_version->index;
+    }
+
+    const Index *operator->() const {
+      return m_version->index.get();
+    }
+
+    /**
+     * @return version of the pinned index, starting at 1 for the initial one
+     */
+    uint64_t version() const {
+      return m_version->number;
+    }
+
+   private:
+    friend class Reader;
+
+    Snapshot(Slot *slot, const Version *version)
+      : m_slot{slot}
+      , m_version{version} {
+    }
+
+   private:
+    Slot *m_slot;
+    const Version *m_version;
+  };
+
+  /**
+   * Reader slot owned by one thread at a time; obtain it once per thread and
+   * pin snapshots from it for every query or batch.
+   */
+  class Reader {
+   public:
+    Reader(const Reader &) = delete;
+    Reader &operator=(const Reader &) = delete;
+
+    Reader(Reader &&other)
+      : m_registry{other.m_registry}
+      , m_slot{other.m_slot} {
+      other.m_slot = nullptr;
+    }
+
+    ~Reader() {
+      if (nullptr != m_slot) {
+        m_slot->claimed = false;
+      }
+    }
+
+    /**
+     * Pins the current snapshot without locking; must not be nested.
+     * @return pinned snapshot
+     */
+    Snapshot pin() const {
+      // Announce before loading so that a writer retiring the loaded version sees this reader.
+      m_slot->epoch = m_registry->m_epoch.load();
+      return Snapshot(m_slot, m_registry->m_current.load());
+    }
+
+   private:
+    friend class Registry;
+
+    Reader(const Registry *registry, Slot *slot)
+      : m_registry{registry}
+      , m_slot{slot} {
+    }
+
+   private:
+    const Registry *m_registry;
+    Slot *m_slot;
+  };
+
+ public:
+  /**
+   * @param index initial snapshot
+   * @param maxReaders number of reader slots, i.e., threads reading concurrently
+   */
+  explicit Registry(std::unique_ptr<const Index> index, std::size_t maxReaders = 64)
+    : m_storage{new unsigned char[maxReaders * sizeof(Slot) + CACHE_LINE]}
+    , m_slots{constructSlots(m_storage.get(), maxReaders)}
+    , m_slotCount{maxReaders}
+    , m_current{new Version{std::move(index), 1}}
+    , m_epoch{1}
+    , m_writer{}
+    , m_retired{} {
+  }
+
+  Registry(const Registry &) = delete;
+  Registry &operator=(const Registry &) = delete;
+
+  /**
+   * Readers and background rebuilds must have finished.
+   */
+  ~Registry() {
+    for(const auto &retired : m_retired) {
+      delete retired.version;
+    }
+    delete m_current.load();
+    for(std::size_t i = 0; i < m_slotCount; ++i) {
+      m_slots[i].~Slot();
+    }
+  }
+
+  /**
+   * Claims a free reader slot.
+   * @return reader, or throws std::runtime_error if all slots are taken
+   */
+  Reader reader() {
+    for(std::size_t i = 0; i < m_slotCount; ++i) {
+      bool expected{false};
+      if (m_slots[i].claimed.compare_exchange_strong(expected, true)) {
+        return Reader(this, &m_slots[i]);
+      }
+    }
+    throw std::runtime_error("geofence::Registry: no free reader slot");
+  }
+
+  /**
+   * Replaces the current snapshot; readers that pinned the old one keep using
+   * it until they release it.
+   * @param index next snapshot
+   * @return version of the published snapshot
+   */
+  uint64_t publish(std::unique_ptr<const Index> index) {
+    std::lock_guard<std::mutex> lock(m_writer);
+    const Version *next{new Version{std::move(index), m_current.load()->number + 1}};
+    const Version *previous{m_current.exchange(next)};
+    m_retired.push_back(Retired{previous, m_epoch.fetch_add(1)});
+    reclaimRetired();
+    return next->number;
+  }
+
+  /**
+   * Builds the next snapshot on a background thread and publishes it.
+   * @param build callable returning the next index by value
+   * @return future that becomes ready once the snapshot is published
+   */
+  template <typename Build>
+  std::future<uint64_t> rebuild(Build &&build) {
+    return std::async(std::launch::async, [this](typename std::decay<Build>::type b) {
+      return publish(std::unique_ptr<const Index>(new Index(b())));
+    }, std::forward<Build>(build));
+  }
+
+  /**
+   * Deletes retired snapshots that no reader can hold anymore.
+   * @return number of snapshots still retired
+   */
+  std::size_t reclaim() {
+    std::lock_guard<std::mutex> lock(m_writer);
+    return reclaimRetired();
+  }
+
+  /**
+   * @return version of the current snapshot
+   */
+  uint64_t version() const {
+    return m_current.load()->number;
+  }
+
+ private:
+  // The default allocator only guarantees alignof(std::max_align_t) before
+  // C++17, so the slot array is placed by hand in over-allocated storage.
+  static Slot *constructSlots(unsigned char *storage, std::size_t count) {
+    const auto address = reinterpret_cast<std::uintptr_t>(storage);
+    Slot *slots{reinterpret_cast<Slot*>(storage + (CACHE_LINE - address % CACHE_LINE) % CACHE_LINE)};
+    for(std::size_t i = 0; i < count; ++i) {
+      new (slots + i) Slot();
+    }
+    return slots;
+  }
+
+  std::size_t reclaimRetired() {
+    uint64_t oldest{IDLE};
+    for(std::size_t i = 0; i < m_slotCount; ++i) {
+      oldest = (std::min)(oldest, m_slots[i].epoch.load());
+    }
+    auto end = std::partition(m_retired.begin(), m_retired.end(), [oldest](const Retired &retired) {
+      return !(retired.epoch < oldest);
+    });
+    for(auto it = end; it != m_retired.end(); ++it) {
+      delete it->version;
+    }
+    m_retired.erase(end, m_retired.end());
+    return m_retired.size();
+  }
+
+ private:
+  std::unique_ptr<unsigned char[]> m_storage;
+  Slot *m_slots;                    // cache-line aligned within m_storage
+  std::size_t m_slotCount;
+  std::atomic<const Version*> m_current;
+  std::atomic<uint64_t> m_epoch;
+  std::mutex m_writer;              // serializes writers
+  std::vector<Retired> m_retired;
+};
+
+template <typename Index>
+constexpr uint64_t Registry<Index>::IDLE;
+
+template <typename Index>
+constexpr std::size_t Registry<Index>::CACHE_LINE;
+
+/**
+ * Multi-fence index supporting insertion and removal of single fences,
+ * organized as a log-structured merge of static packed R-trees. New fences go
+ * to a small buffer that is scanned linearly; a full buffer is merged with the
+ * levels below it like a binary counter, so that level k holds BUFFER * 2^k
+ * fences and every fence is rebuilt at most log(n) times. Removal sets a
+ * tombstone; a level is rebuilt without its tombstones once half of it is
+ * dead. A query visits at most log(n / BUFFER) trees, which bounds its cost
+ * relative to a single bulk-loaded tree.
+ */
+template <typename T, typename FillRule = EvenOddRule>
+class DynamicFenceIndex {
+  static_assert(std::is_arithmetic<T>::value, "T must be an arithmetic type");
+
+  struct Level {
+    Level()
+      : ids{}
+      , tree{}
+      , dead{0} {
+    }
+
+    std::vector<uint32_t> ids;     // fences in leaf order
+    detail::PackedBoxTree<T> tree;
+    std::size_t dead;              // removed fences still listed
+  };
+
+ public:
+  static constexpr std::size_t BUFFER{64};
+
+ public:
+  DynamicFenceIndex()
+    : m_fences{}
+    , m_boxes{}
+    , m_level{}
+    , m_buffer{}
+    , m_levels{}
+    , m_size{0} {
+  }
+
+  /**
+   * @param fence ring describing the geofenced area
+   * @return ID of the fence
+   */
+  uint32_t insert(const std::vector<std::array<T,2>> &fence) {
+    const uint32_t id{static_cast<uint32_t>(m_fences.size())};
+    m_fences.push_back(fence);
+    m_boxes.push_back((2 < fence.size()) ? BoundingBox<T>::of(fence) : BoundingBox<T>::empty());
+    m_level.push_back(BUFFERED);
+    m_buffer.push_back(id);
+    m_size++;
+    if (BUFFER <= m_buffer.size()) {
+      // Carry into the first empty level, merging all full levels below it.
+      std::vector<uint32_t> ids;
+      ids.swap(m_buffer);
+      std::size_t k{0};
+      for(; k < m_levels.size() && !m_levels[k].ids.empty(); k++) {
+        collect(m_levels[k], ids);
+      }
+      if (k == m_levels.size()) {
+        m_levels.push_back(Level());
+      }
+      build(k, ids);
+    }
+    return id;
+  }
+
+  /**
+   * @param id ID of the fence to remove
+   * @return true if the fence was present
+   */
+  bool remove(uint32_t id) {
+    if (m_fences.size() <= id || REMOVED == m_level[id]) {
+      return false;
+    }
+    const uint32_t level{m_level[id]};
+    m_level[id] = REMOVED;
+    m_fences[id] = std::vector<std::array<T,2>>();
+    m_size--;
+    if (BUFFERED == level) {
+      m_buffer.erase(std::find(m_buffer.begin(), m_buffer.end(), id));
+    }
+    else if (m_levels[level].ids.size() < 2 * ++m_levels[level].dead) {
+      std::vector<uint32_t> ids;
+      collect(m_levels[level], ids);
+      build(level, ids);
+    }
+    return true;
+  }
+
+  /**
+   * @param p point to locate
+   * @return ascending IDs of all fences containing p according to FillRule OR having p as vertex (as isIn)
+   */
+  std::vector<uint32_t> query(const std::array<T,2> &p) const {
+    std::vector<uint32_t> result;
+    for(uint32_t id : m_buffer) {
+      if (contains(id, p)) {
+        result.push_back(id);
+      }
+    }
+    for(const auto &level : m_levels) {
+      level.tree.query(p, [this, &level, &p, &result](std::size_t group) {
+        const std::size_t END{(std::min)(level.ids.size(), (group + 1) * detail::PackedBoxTree<T>::FANOUT)};
+        for(std::size_t g{group * detail::PackedBoxTree<T>::FANOUT}; g < END; g++) {
+          if ((REMOVED != m_level[level.ids[g]]) && contains(level.ids[g], p)) {
+            result.push_back(level.ids[g]);
+          }
+        }
+        return false;
+      });
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+  }
+
+  /**
+   * @return number of fences
+   */
+  std::size_t size() const {
+    return m_size;
+  }
+
+  /**
+   * @return number of non-empty static levels
+   */
+  std::size_t levels() const {
+    std::size_t count{0};
+    for(const auto &level : m_levels) {
+      count += level.ids.empty() ? 0 : 1;
+    }
+    return count;
+  }
+
+ private:
+  static constexpr uint32_t BUFFERED{(std::numeric_limits<uint32_t>::max)()};
+  static constexpr uint32_t REMOVED{BUFFERED - 1};
+
+  bool contains(uint32_t id, const std::array<T,2> &p) const {
+    int32_t counter{0};
+    return m_boxes[id].contains(p) && (2 < m_fences[id].size()) &&
+           (detail::walkRing<FillRule>(m_fences[id].data(), m_fences[id].size(), p, counter) || FillRule::isInside(counter));
+  }
+
+  void collect(Level &level, std::vector<uint32_t> &ids) {
+    for(uint32_t id : level.ids) {
+      if (REMOVED != m_level[id]) {
+        ids.push_back(id);
+      }
+    }
+    level = Level();
+  }
+
+  void build(std::size_t k, const std::vector<uint32_t> &ids) {
+    Level &level = m_levels[k];
+    std::vector<BoundingBox<T>> boxes;
+    for(uint32_t id : ids) {
+      boxes.push_back(m_boxes[id]);
+      m_level[id] = static_cast<uint32_t>(k);
+    }
+    for(std::size_t i : level.tree.build(boxes)) {
+      level.ids.push_back(ids[i]);
+    }
+  }
+
+ private:
+  std::vector<std::vector<std::array<T,2>>> m_fences; // indexed by ID; emptied when removed
+  std::vector<BoundingBox<T>> m_boxes;
+  std::vector<uint32_t> m_level;                      // level of every fence, BUFFERED, or REMOVED
+  std::vector<uint32_t> m_buffer;
+  std::vector<Level> m_levels;
+  std::size_t m_size;
+};
+
+template <typename T, typename FillRule>
+constexpr std::size_t DynamicFenceIndex<T, FillRule>::BUFFER;
+
+template <typename T, typename FillRule>
+constexpr uint32_t DynamicFenceIndex<T, FillRule>::BUFFERED;
+
+template <typename T, typename FillRule>
+constexpr uint32_t DynamicFenceIndex<T, FillRule>::REMOVED;
+
+/**
+ * Read-only view of fences in a versioned, position-independent binary
+ * layout: vertices, the y-monotone chains of every fence (see
+ * MonotoneChainIndex), and a packed R-tree over the fences' bounding boxes are
+ * stored as flat arrays addressed by offsets from the start of the buffer. The
+ * view queries the buffer in place without deserialization, so a memory-mapped
+ * file is usable immediately, pages are faulted in on first access, and
+ * several processes share the page cache. All numbers are in host byte order;
+ * a marker in the header rejects files written on a machine with another one.
+ */
+class FenceStore {
+ public:
+  static constexpr uint32_t VERSION{1};
+
+  struct Header {
+    char magic[8];       // "GEOFENCE"
+    uint32_t version;
+    uint32_t byteOrder;  // 0x01020304 as written
+    uint64_t size;       // total bytes
+    uint64_t fences;
+    uint64_t vertices;
+    uint64_t chains;
+    uint64_t nodes;
+    uint64_t levels;
+    uint64_t fenceOffset;
+    uint64_t vertexOffset;
+    uint64_t chainOffset;
+    uint64_t nodeOffset;
+    uint64_t levelOffset;
+  };
+
+  // Fences are stored in the leaf order of the tree.
+  struct Fence {
+    uint64_t id;
+    uint64_t firstVertex;
+    uint64_t vertices;
+    uint64_t firstChain;
+    uint64_t chains;
+    double min[2];
+    double max[2];
+  };
+
+  struct Chain {
+    uint64_t first;      // relative to the fence's first vertex
+    uint64_t length;
+    uint64_t ascending;
+    double min[2];
+    double max[2];
+  };
+
+  struct Node {
+    double min[2];
+    double max[2];
+  };
+
+  struct Level {
+    uint64_t first;      // first node, bottom level first
+    uint64_t count;
+  };
+
+  static constexpr std::size_t FANOUT{detail::PackedBoxTree<double>::FANOUT};
+  static constexpr std::size_t MAX_LEVELS{32};
+
+ public:
+  /**
+   * Checks the header and every fence, chain, and tree level against the
+   * sections they refer to, so that queries on a corrupt file cannot read
+   * outside the buffer; this visits all records once.
+   * @param data start of a buffer holding a fence store, aligned to 8 bytes; must outlive the view
+   * @param size number of bytes in the buffer
+   * @throws std::runtime_error if the buffer does not hold a valid fence store of this version
+   */
+  FenceStore(const void *data, std::size_t size)
+    : m_data{static_cast<const uint8_t*>(data)}
+    , m_header{nullptr}
+    , m_fences{nullptr}
+    , m_vertices{nullptr}
+    , m_chains{nullptr}
+    , m_nodes{nullptr}
+    , m_levels{nullptr} {
+    if ((nullptr == data) || (0 != reinterpret_cast<std::uintptr_t>(data) % 8) || (size < sizeof(Header))) {
+      throw std::runtime_error("geofence::FenceStore: buffer too small or misaligned");
+    }
+    m_header = reinterpret_cast<const Header*>(m_data);
+    if ( (0 != std::memcmp(m_header->magic, "GEOFENCE", 8)) || (0x01020304u != m_header->byteOrder) ) {
+      throw std::runtime_error("geofence::FenceStore: not a fence store or different byte order");
+    }
+    if (VERSION != m_header->version) {
+      throw std::runtime_error("geofence::FenceStore: unsupported version");
+    }
+    auto fits = [size](uint64_t offset, uint64_t count, std::size_t element) {
+      return (offset % 8 == 0) && (offset <= size) && (count <= (size - offset) / element);
+    };
+    if ( (m_header->size != size) ||
+         !fits(m_header->fenceOffset, m_header->fences, sizeof(Fence)) ||
+         !fits(m_header->vertexOffset, m_header->vertices, sizeof(std::array<double,2>)) ||
+         !fits(m_header->chainOffset, m_header->chains, sizeof(Chain)) ||
+         !fits(m_header->nodeOffset, m_header->nodes, sizeof(Node)) ||
+         !fits(m_header->levelOffset, m_header->levels, sizeof(Level)) ) {
+      throw std::runtime_error("geofence::FenceStore: truncated or corrupt");
+    }
+    m_fences = reinterpret_cast<const Fence*>(m_data + m_header->fenceOffset);
+    m_vertices = reinterpret_cast<const std::array<double,2>*>(m_data + m_header->vertexOffset);
+    m_chains = reinterpret_cast<const Chain*>(m_data + m_header->chainOffset);
+    m_nodes = reinterpret_cast<const Node*>(m_data + m_header->nodeOffset);
+    m_levels = reinterpret_cast<const Level*>(m_data + m_header->levelOffset);
+
+    // Every range that query() follows must stay inside its section.
+    auto within = [](uint64_t first, uint64_t count, uint64_t total) {
+      return (first <= total) && (count <= total - first);
+    };
+    if ( (MAX_LEVELS < m_header->levels) || ((0 < m_header->levels) && (0 == m_levels[m_header->levels - 1].count)) ) {
+      throw std::runtime_error("geofence::FenceStore: truncated or corrupt tree");
+    }
+    for(uint64_t l{0}; l < m_header->levels; l++) {
+      if (!within(m_levels[l].first, m_levels[l].count, m_header->nodes)) {
+        throw std::runtime_error("geofence::FenceStore: truncated or corrupt tree");
+      }
+    }
+    for(uint64_t f{0}; f < m_header->fences; f++) {
+      const Fence &fence = m_fences[f];
+      if ( !within(fence.firstVertex, fence.vertices, m_header->vertices) || !within(fence.firstChain, fence.chains, m_header->chains) ) {
+        throw std::runtime_error("geofence::FenceStore: truncated or corrupt fence");
+      }
+      for(uint64_t k{fence.firstChain}; k < fence.firstChain + fence.chains; k++) {
+        if ( (fence.vertices <= m_chains[k].first) || (fence.vertices < m_chains[k].length) ) {
+          throw std::runtime_error("geofence::FenceStore: truncated or corrupt chain");
+        }
+      }
+    }
+  }
+
+  /**
+   * Lays out fences in the binary format.
+   * @param fences rings describing the geofenced areas; their indices are used as fence IDs
+   * @param pool optional workers to prepare the fences on in parallel
+   * @return buffer to write to a file or to view directly
+   */
+  template <typename T>
+  static std::vector<uint8_t> build(const std::vector<std::vector<std::array<T,2>>> &fences, ThreadPool *pool = nullptr) {
+    constexpr const uint8_t X{0};
+    constexpr const uint8_t Y{1};
+    std::vector<std::vector<std::array<double,2>>> rings;
+    std::vector<BoundingBox<double>> boxes;
+    for(const auto &fence : fences) {
+      std::vector<std::array<double,2>> ring;
+      for(const auto &v : fence) {
+        ring.push_back(std::array<double,2>{{static_cast<double>(v[X]), static_cast<double>(v[Y])}});
+      }
+      boxes.push_back(BoundingBox<double>::of(ring));
+      rings.push_back(ring);
+    }
+    detail::PackedBoxTree<double> tree;
+    const std::vector<std::size_t> order{tree.build(boxes)};
+
+    std::vector<std::vector<Chain>> prepared(rings.size());
+    auto prepare = [&rings, &prepared](std::size_t begin, std::size_t end, std::size_t) {
+      for(std::size_t id{begin}; id < end; id++) {
+        const MonotoneChainIndex<double> index(rings[id]);
+        for(const auto &c : index.chains()) {
+          prepared[id].push_back(Chain{c.first, c.length, c.ascending ? 1u : 0u, {c.min[0], c.min[1]}, {c.max[0], c.max[1]}});
+        }
+      }
+    };
+    if (nullptr != pool) {
+      pool->parallelFor(rings.size(), 64, prepare);
+    }
+    else {
+      prepare(0, rings.size(), 0);
+    }
+
+    std::vector<Fence> records;
+    std::vector<std::array<double,2>> vertices;
+    std::vector<Chain> chains;
+    for(std::size_t id : order) {
+      const Fence record{id, vertices.size(), rings[id].size(), chains.size(), prepared[id].size(), {boxes[id].min[X], boxes[id].min[Y]}, {boxes[id].max[X], boxes[id].max[Y]}};
+      records.push_back(record);
+      vertices.insert(vertices.end(), rings[id].begin(), rings[id].end());
+      chains.insert(chains.end(), prepared[id].begin(), prepared[id].end());
+    }
+    std::vector<Node> nodes;
+    std::vector<Level> levels;
+    for(const auto &level : tree.levels()) {
+      levels.push_back(Level{nodes.size(), level.size()});
+      for(const auto &box : level) {
+        nodes.push_back(Node{{box.min[X], box.min[Y]}, {box.max[X], box.max[Y]}});
+      }
+    }
+
+    Header header{{'G', 'E', 'O', 'F', 'E', 'N', 'C', 'E'}, VERSION, 0x01020304u, 0, records.size(), vertices.size(), chains.size(), nodes.size(), levels.size(), 0, 0, 0, 0, 0};
+    // Sections follow the header, each padded to 8 bytes; offsets are known before anything is copied.
+    auto padded = [](std::size_t bytes) {
+      return (bytes + 7) / 8 * 8;
+    };
+    header.fenceOffset = padded(sizeof(Header));
+    header.vertexOffset = header.fenceOffset + padded(records.size() * sizeof(Fence));
+    header.chainOffset = header.vertexOffset + padded(vertices.size() * sizeof(std::array<double,2>));
+    header.nodeOffset = header.chainOffset + padded(chains.size() * sizeof(Chain));
+    header.levelOffset = header.nodeOffset + padded(nodes.size() * sizeof(Node));
+    header.size = header.levelOffset + padded(levels.size() * sizeof(Level));
+
+    std::vector<uint8_t> buffer(static_cast<std::size_t>(header.size), 0);
+    auto copy = [&buffer](uint64_t offset, const void *data, std::size_t bytes) {
+      if (0 < bytes) {
+        std::memcpy(buffer.data() + offset, data, bytes);
+      }
+    };
+    copy(0, &header, sizeof(Header));
+    copy(header.fenceOffset, records.data(), records.size() * sizeof(Fence));
+    copy(header.vertexOffset, vertices.data(), vertices.size() * sizeof(std::array<double,2>));
+    copy(header.chainOffset, chains.data(), chains.size() * sizeof(Chain));
+    copy(header.nodeOffset, nodes.data(), nodes.size() * sizeof(Node));
+    copy(header.levelOffset, levels.data(), levels.size() * sizeof(Level));
+    return buffer;
+  }
+
+  /**
+   * @param p point to locate
+   * @return ascending IDs of all fences containing p according to FillRule OR having p as vertex (as isIn)
+   */
+  template <typename FillRule = EvenOddRule>
+  std::vector<uint32_t> query(const std::array<double,2> &p) const {
+    std::vector<uint32_t> result;
+    if (0 == m_header->levels) {
+      return result;
+    }
+    // Depth-first descent from the root; children of node i are nodes i*FANOUT.. of the level below.
+    // At most FANOUT nodes per level wait on the stack.
+    std::array<std::pair<uint64_t, uint64_t>, MAX_LEVELS * FANOUT> stack;
+    std::size_t top{0};
+    stack[top++] = std::make_pair(m_header->levels - 1, uint64_t{0});
+    while (0 < top) {
+      const uint64_t level{stack[top - 1].first};
+      const uint64_t node{stack[top - 1].second};
+      top--;
+      if (!contains(m_nodes[m_levels[level].first + node].min, m_nodes[m_levels[level].first + node].max, p)) {
+        continue;
+      }
+      if (0 < level) {
+        const uint64_t end{(std::min)(m_levels[level - 1].count, (node + 1) * FANOUT)};
+        for(uint64_t child{node * FANOUT}; child < end; child++) {
+          stack[top++] = std::make_pair(level - 1, child);
+        }
+        continue;
+      }
+      const uint64_t end{(std::min)(m_header->fences, (node + 1) * FANOUT)};
+      for(uint64_t f{node * FANOUT}; f < end; f++) {
+        if (isIn<FillRule>(m_fences[f], p)) {
+          result.push_back(static_cast<uint32_t>(m_fences[f].id));
+        }
+      }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+  }
+
+  /**
+   * @return number of fences
+   */
+  std::size_t size() const {
+    return static_cast<std::size_t>(m_header->fences);
+  }
+
+ private:
+  static bool contains(const double *min, const double *max, const std::array<double,2> &p) {
+    return !(p[0] < min[0] || max[0] < p[0] || p[1] < min[1] || max[1] < p[1]);
+  }
+
+  template <typename FillRule>
+  bool isIn(const Fence &fence, const std::array<double,2> &p) const {
+    constexpr const uint8_t Y{1};
+    if ((fence.vertices < 3) || !contains(fence.min, fence.max, p)) {
+      return false;
+    }
+    int32_t counter{0};
+    for(uint64_t k{fence.firstChain}; k < fence.firstChain + fence.chains; k++) {
+      const Chain &c = m_chains[k];
+      if (p[Y] < c.min[Y] && !isEqual(p[Y], c.min[Y])) {
+        // Chains are sorted by their lower y-bound.
+        break;
+      }
+      if (c.max[Y] < p[Y] && !isEqual(p[Y], c.max[Y])) {
+        continue;
+      }
+      if (detail::walkMonotoneChain<FillRule>(m_vertices + fence.firstVertex, fence.vertices, c.first, c.length, 0 != c.ascending, p, counter)) {
+        return true;
+      }
+    }
+    return FillRule::isInside(counter);
+  }
+
+ private:
+  const uint8_t *m_data;
+  const Header *m_header;
+  const Fence *m_fences;
+  const std::array<double,2> *m_vertices;
+  const Chain *m_chains;
+  const Node *m_nodes;
+  const Level *m_levels;
+};
+
+constexpr uint32_t FenceStore::VERSION;
+constexpr std::size_t FenceStore::FANOUT;
+constexpr std::size_t FenceStore::MAX_LEVELS;
+
+/**
+ * Polygon read from an external format; usable with MultiPolygon::add.
+ */
+struct Polygon {
+  Polygon()
+    : outer{}
+    , holes{} {
+  }
+
+  std::vector<std::array<double,2>> outer;
+  std::vector<std::vector<std::array<double,2>>> holes;
+};
+
+/**
+ * Normalizes a ring read from an external source: removes repeated
+ * consecutive vertices and the closing vertex, and orients it
+ * counter-clockwise.
+ * @param ring to normalize in place
+ * @return true if the ring has finite coordinates, at least three distinct vertices, and a non-zero area
+ */
+template <typename T>
+inline bool normalize(std::vector<std::array<T,2>> &ring) {
+  static_assert(std::is_arithmetic<T>::value, "T must be an arithmetic type");
+  constexpr const uint8_t X{0};
+  constexpr const uint8_t Y{1};
+  std::vector<std::array<T,2>> unique;
+  for(const auto &v : ring) {
+    if (!std::isfinite(static_cast<double>(v[X])) || !std::isfinite(static_cast<double>(v[Y]))) {
+      return false;
+    }
+    if (unique.empty() || !isEqual(unique.back()[X], v[X]) || !isEqual(unique.back()[Y], v[Y])) {
+      unique.push_back(v);
+    }
+  }
+  while ( (1 < unique.size()) && isEqual(unique.front()[X], unique.back()[X]) && isEqual(unique.front()[Y], unique.back()[Y]) ) {
+    unique.pop_back();
+  }
+  ring.swap(unique);
+  const double area{(2 < ring.size()) ? detail::signedArea2(ring) : 0.0};
+  if (area < 0) {
+    std::reverse(ring.begin(), ring.end());
+  }
+  return (area < 0) || (0 < area);
+}
+
+namespace detail {
+template <typename T> class GeoJsonReader;
+}
+
+/**
+ * Caller-owned storage for polygons read from an external format: all
+ * vertices of all rings in one array, with the end of every ring and of every
+ * polygon (outer ring followed by its holes) as offsets. Reusing an arena
+ * across documents or after clear() keeps its capacity, so steady-state
+ * reading does not allocate.
+ */
+template <typename T>
+class RingArena {
+  static_assert(std::is_arithmetic<T>::value, "T must be an arithmetic type");
+
+ public:
+  RingArena()
+    : m_vertices{}
+    , m_ringEnds{}
+    , m_polygonEnds{} {}
+
+  /**
+   * Removes all polygons but keeps the allocated capacity.
+   */
+  void clear() {
+    m_vertices.clear();
+    m_ringEnds.clear();
+    m_polygonEnds.clear();
+  }
+
+  /**
+   * @return number of polygons
+   */
+  std::size_t polygons() const {
+    return m_polygonEnds.size();
+  }
+
+  /**
+   * @return number of rings of all polygons
+   */
+  std::size_t rings() const {
+    return m_ringEnds.size();
+  }
+
+  /**
+   * @param polygon index of a polygon
+   * @return index of its outer ring; its holes follow up to firstRing(polygon + 1)
+   */
+  std::size_t firstRing(std::size_t polygon) const {
+    return (0 == polygon) ? 0 : m_polygonEnds[polygon - 1];
+  }
+
+  /**
+   * @param ring index of a ring
+   * @return pointer to its first vertex, e.g., for detail::walkRing
+   */
+  const std::array<T,2> *ring(std::size_t ring) const {
+    return m_vertices.data() + ((0 == ring) ? 0 : m_ringEnds[ring - 1]);
+  }
+
+  /**
+   * @param ring index of a ring
+   * @return number of its vertices
+   */
+  std::size_t ringSize(std::size_t ring) const {
+    return m_ringEnds[ring] - ((0 == ring) ? 0 : m_ringEnds[ring - 1]);
+  }
+
+  /**
+   * @param ring index of a ring
+   * @return copy of the ring, e.g., for isIn or MultiPolygon::add
+   */
+  std::vector<std::array<T,2>> copy(std::size_t ring) const {
+    return std::vector<std::array<T,2>>(this->ring(ring), this->ring(ring) + ringSize(ring));
+  }
+
+  const std::vector<std::array<T,2>> &vertices() const {
+    return m_vertices;
+  }
+
+ private:
+  template <typename> friend class detail::GeoJsonReader;
+
+  std::vector<std::array<T,2>> m_vertices;
+  std::vector<std::size_t> m_ringEnds;     // one past the last vertex of every ring
+  std::vector<std::size_t> m_polygonEnds;  // one past the last ring of every polygon
+};
+
+namespace detail {
+
+inline bool hostIsLittleEndian() {
+  const uint32_t one{1};
+  uint8_t first{0};
+  std::memcpy(&first, &one, 1);
+  return 1 == first;
+}
+
+inline uint32_t swapBytes(uint32_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_bswap32(v);
+#else
+  return ((v & 0xFFu) << 24) | ((v & 0xFF00u) << 8) | ((v >> 8) & 0xFF00u) | (v >> 24);
+#endif
+}
+
+inline uint64_t swapBytes(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_bswap64(v);
+#else
+  return (static_cast<uint64_t>(swapBytes(static_cast<uint32_t>(v))) << 32) | swapBytes(static_cast<uint32_t>(v >> 32));
+#endif
+}
+
+/**
+ * @param p bytes of an unsigned integer, in little-endian order if LITTLE; need not be aligned
+ * @return the integer, independent of the host's byte order; compiles to a plain or byte-swapping load
+ */
+template <typename U, bool LITTLE>
+inline U loadOrdered(const uint8_t *p) {
+  U value;
+  std::memcpy(&value, p, sizeof(U));
+  return (LITTLE == hostIsLittleEndian()) ? value : swapBytes(value);
+}
+
+template <typename U>
+inline U loadOrdered(const uint8_t *p, bool little) {
+  return little ? loadOrdered<U, true>(p) : loadOrdered<U, false>(p);
+}
+
+/**
+ * @param p eight characters
+ * @return the characters with the first one in the lowest byte, independent of byte order
+ */
+inline uint64_t load8(const char *p) {
+  return loadOrdered<uint64_t, true>(reinterpret_cast<const uint8_t*>(p));
+}
+
+/**
+ * @param chunk eight characters as returned by load8
+ * @return true if all of them are decimal digits
+ */
+inline bool isEightDigits(uint64_t chunk) {
+  return 0 == (((chunk & 0xF0F0F0F0F0F0F0F0ull) | (((chunk + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4)) ^ 0x3333333333333333ull);
+}
+
+/**
+ * @param chunk eight decimal digits as returned by load8
+ * @return their value
+ */
+inline uint32_t eightDigits(uint64_t chunk) {
+  chunk -= 0x3030303030303030ull;
+  chunk = (chunk * 10) + (chunk >> 8);
+  return static_cast<uint32_t>((((chunk & 0x000000FF000000FFull) * 0x000F424000000064ull) +
+                                (((chunk >> 16) & 0x000000FF000000FFull) * 0x0000271000000001ull)) >> 32);
+}
+
+/**
+ * @param v non-zero
+ * @return number of leading zero bits
+ */
+inline uint32_t countLeadingZeros(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<uint32_t>(__builtin_clzll(v));
+#else
+  uint32_t zeros{0};
+  for(; 0 == (v >> 63); v <<= 1) {
+    zeros++;
+  }
+  return zeros;
+#endif
+}
+
+/**
+ * @return low 64 bits of the product a * b; its high 64 bits are stored in high
+ */
+inline uint64_t multiply128(uint64_t a, uint64_t b, uint64_t &high) {
+#if defined(__SIZEOF_INT128__)
+  __extension__ typedef unsigned __int128 uint128;
+  const uint128 product{static_cast<uint128>(a) * b};
+  high = static_cast<uint64_t>(product >> 64);
+  return static_cast<uint64_t>(product);
+#else
+  const uint64_t lowLow{(a & 0xFFFFFFFFull) * (b & 0xFFFFFFFFull)};
+  const uint64_t lowHigh{(a & 0xFFFFFFFFull) * (b >> 32)};
+  const uint64_t highLow{(a >> 32) * (b & 0xFFFFFFFFull)};
+  const uint64_t middle{(lowLow >> 32) + (lowHigh & 0xFFFFFFFFull) + (highLow & 0xFFFFFFFFull)};
+  high = (a >> 32) * (b >> 32) + (lowHigh >> 32) + (highLow >> 32) + (middle >> 32);
+  return (middle << 32) | (lowLow & 0xFFFFFFFFull);
+#endif
+}
+
+/**
+ * @param q decimal exponent within [-342, 308]
+ * @return 10^q scaled to 128 bits with the highest bit set and rounded down, as high and low 64 bits
+ */
+inline const uint64_t *powerOfTen128(int32_t q) {
+  static const uint64_t POW10[651][2]{
+    {0xEEF453D6923BD65Aull, 0x113FAA2906A13B3Full},
+    {0x9558B4661B6565F8ull, 0x4AC7CA59A424C507ull},
+    {0xBAAEE17FA23EBF76ull, 0x5D79BCF00D2DF649ull},
+    {0xE95A99DF8ACE6F53ull, 0xF4D82C2C107973DCull},
+    {0x91D8A02BB6C10594ull, 0x79071B9B8A4BE869ull},
+    {0xB64EC836A47146F9ull, 0x9748E2826CDEE284ull},
+    {0xE3E27A444D8D98B7ull, 0xFD1B1B2308169B25ull},
+    {0x8E6D8C6AB0787F72ull, 0xFE30F0F5E50E20F7ull},
+    {0xB208EF855C969F4Full, 0xBDBD2D335E51A935ull},
+    {0xDE8B2B66B3BC4723ull, 0xAD2C788035E61382ull},
+    {0x8B16FB203055AC76ull, 0x4C3BCB5021AFCC31ull},
+    {0xADDCB9E83C6B1793ull, 0xDF4ABE242A1BBF3Dull},
+    {0xD953E8624B85DD78ull, 0xD71D6DAD34A2AF0Dull},
+    {0x87D4713D6F33AA6Bull, 0x8672648C40E5AD68ull},
+    {0xA9C98D8CCB009506ull, 0x680EFDAF511F18C2ull},
+    {0xD43BF0EFFDC0BA48ull, 0x0212BD1B2566DEF2ull},
+    {0x84A57695FE98746Dull, 0x014BB630F7604B57ull},
+    {0xA5CED43B7E3E9188ull, 0x419EA3BD35385E2Dull},
+    {0xCF42894A5DCE35EAull, 0x52064CAC828675B9ull},
+    {0x818995CE7AA0E1B2ull, 0x7343EFEBD1940993ull},
+    {0xA1EBFB4219491A1Full, 0x1014EBE6C5F90BF8ull},
+    {0xCA66FA129F9B60A6ull, 0xD41A26E077774EF6ull},
+    {0xFD00B897478238D0ull, 0x8920B098955522B4ull},
+    {0x9E20735E8CB16382ull, 0x55B46E5F5D5535B0ull},
+    {0xC5A890362FDDBC62ull, 0xEB2189F734AA831Dull},
+    {0xF712B443BBD52B7Bull, 0xA5E9EC7501D523E4ull},
+    {0x9A6BB0AA55653B2Dull, 0x47B233C92125366Eull},
+    {0xC1069CD4EABE89F8ull, 0x999EC0BB696E840Aull},
+    {0xF148440A256E2C76ull, 0xC00670EA43CA250Dull},
+    {0x96CD2A865764DBCAull, 0x380406926A5E5728ull},
+    {0xBC807527ED3E12BCull, 0xC605083704F5ECF2ull},
+    {0xEBA09271E88D976Bull, 0xF7864A44C633682Eull},
+    {0x93445B8731587EA3ull, 0x7AB3EE6AFBE0211Dull},
+    {0xB8157268FDAE9E4Cull, 0x5960EA05BAD82964ull},
+    {0xE61ACF033D1A45DFull, 0x6FB92487298E33BDull},
+    {0x8FD0C16206306BABull, 0xA5D3B6D479F8E056ull},
+    {0xB3C4F1BA87BC8696ull, 0x8F48A4899877186Cull},
+    {0xE0B62E2929ABA83Cull, 0x331ACDABFE94DE87ull},
+    {0x8C71DCD9BA0B4925ull, 0x9FF0C08B7F1D0B14ull},
+    {0xAF8E5410288E1B6Full, 0x07ECF0AE5EE44DD9ull},
+    {0xDB71E91432B1A24Aull, 0xC9E82CD9F69D6150ull},
+    {0x892731AC9FAF056Eull, 0xBE311C083A225CD2ull},
+    {0xAB70FE17C79AC6CAull, 0x6DBD630A48AAF406ull},
+    {0xD64D3D9DB981787Dull, 0x092CBBCCDAD5B108ull},
+    {0x85F0468293F0EB4Eull, 0x25BBF56008C58EA5ull},
+    {0xA76C582338ED2621ull, 0xAF2AF2B80AF6F24Eull},
+    {0xD1476E2C07286FAAull, 0x1AF5AF660DB4AEE1ull},
+    {0x82CCA4DB847945CAull, 0x50D98D9FC890ED4Dull},
+    {0xA37FCE126597973Cull, 0xE50FF107BAB528A0ull},
+    {0xCC5FC196FEFD7D0Cull, 0x1E53ED49A96272C8ull},
+    {0xFF77B1FCBEBCDC4Full, 0x25E8E89C13BB0F7Aull},
+    {0x9FAACF3DF73609B1ull, 0x77B191618C54E9ACull},
+    {0xC795830D75038C1Dull, 0xD59DF5B9EF6A2417ull},
+    {0xF97AE3D0D2446F25ull, 0x4B0573286B44AD1Dull},
+    {0x9BECCE62836AC577ull, 0x4EE367F9430AEC32ull},
+    {0xC2E801FB244576D5ull, 0x229C41F793CDA73Full},
+    {0xF3A20279ED56D48Aull, 0x6B43527578C1110Full},
+    {0x9845418C345644D6ull, 0x830A13896B78AAA9ull},
+    {0xBE5691EF416BD60Cull, 0x23CC986BC656D553ull},
+    {0xEDEC366B11C6CB8Full, 0x2CBFBE86B7EC8AA8ull},
+    {0x94B3A202EB1C3F39ull, 0x7BF7D71432F3D6A9ull},
+    {0xB9E08A83A5E34F07ull, 0xDAF5CCD93FB0CC53ull},
+    {0xE858AD248F5C22C9ull, 0xD1B3400F8F9CFF68ull},
+    {0x91376C36D99995BEull, 0x23100809B9C21FA1ull},
+    {0xB58547448FFFFB2Dull, 0xABD40A0C2832A78Aull},
+    {0xE2E69915B3FFF9F9ull, 0x16C90C8F323F516Cull},
+    {0x8DD01FAD907FFC3Bull, 0xAE3DA7D97F6792E3ull},
+    {0xB1442798F49FFB4Aull, 0x99CD11CFDF41779Cull},
+    {0xDD95317F31C7FA1Dull, 0x40405643D711D583ull},
+    {0x8A7D3EEF7F1CFC52ull, 0x482835EA666B2572ull},
+    {0xAD1C8EAB5EE43B66ull, 0xDA3243650005EECFull},
+    {0xD863B256369D4A40ull, 0x90BED43E40076A82ull},
+    {0x873E4F75E2224E68ull, 0x5A7744A6E804A291ull},
+    {0xA90DE3535AAAE202ull, 0x711515D0A205CB36ull},
+    {0xD3515C2831559A83ull, 0x0D5A5B44CA873E03ull},
+    {0x8412D9991ED58091ull, 0xE858790AFE9486C2ull},
+    {0xA5178FFF668AE0B6ull, 0x626E974DBE39A872ull},
+    {0xCE5D73FF402D98E3ull, 0xFB0A3D212DC8128Full},
+    {0x80FA687F881C7F8Eull, 0x7CE66634BC9D0B99ull},
+    {0xA139029F6A239F72ull, 0x1C1FFFC1EBC44E80ull},
+    {0xC987434744AC874Eull, 0xA327FFB266B56220ull},
+    {0xFBE9141915D7A922ull, 0x4BF1FF9F0062BAA8ull},
+    {0x9D71AC8FADA6C9B5ull, 0x6F773FC3603DB4A9ull},
+    {0xC4CE17B399107C22ull, 0xCB550FB4384D21D3ull},
+    {0xF6019DA07F549B2Bull, 0x7E2A53A146606A48ull},
+    {0x99C102844F94E0FBull, 0x2EDA7444CBFC426Dull},
+    {0xC0314325637A1939ull, 0xFA911155FEFB5308ull},
+    {0xF03D93EEBC589F88ull, 0x793555AB7EBA27CAull},
+    {0x96267C7535B763B5ull, 0x4BC1558B2F3458DEull},
+    {0xBBB01B9283253CA2ull, 0x9EB1AAEDFB016F16ull},
+    {0xEA9C227723EE8BCBull, 0x465E15A979C1CADCull},
+    {0x92A1958A7675175Full, 0x0BFACD89EC191EC9ull},
+    {0xB749FAED14125D36ull, 0xCEF980EC671F667Bull},
+    {0xE51C79A85916F484ull, 0x82B7E12780E7401Aull},
+    {0x8F31CC0937AE58D2ull, 0xD1B2ECB8B0908810ull},
+    {0xB2FE3F0B8599EF07ull, 0x861FA7E6DCB4AA15ull},
+    {0xDFBDCECE67006AC9ull, 0x67A791E093E1D49Aull},
+    {0x8BD6A141006042BDull, 0xE0C8BB2C5C6D24E0ull},
+    {0xAECC49914078536Dull, 0x58FAE9F773886E18ull},
+    {0xDA7F5BF590966848ull, 0xAF39A475506A899Eull},
+    {0x888F99797A5E012Dull, 0x6D8406C952429603ull},
+    {0xAAB37FD7D8F58178ull, 0xC8E5087BA6D33B83ull},
+    {0xD5605FCDCF32E1D6ull, 0xFB1E4A9A90880A64ull},
+    {0x855C3BE0A17FCD26ull, 0x5CF2EEA09A55067Full},
+    {0xA6B34AD8C9DFC06Full, 0xF42FAA48C0EA481Eull},
+    {0xD0601D8EFC57B08Bull, 0xF13B94DAF124DA26ull},
+    {0x823C12795DB6CE57ull, 0x76C53D08D6B70858ull},
+    {0xA2CB1717B52481EDull, 0x54768C4B0C64CA6Eull},
+    {0xCB7DDCDDA26DA268ull, 0xA9942F5DCF7DFD09ull},
+    {0xFE5D54150B090B02ull, 0xD3F93B35435D7C4Cull},
+    {0x9EFA548D26E5A6E1ull, 0xC47BC5014A1A6DAFull},
+    {0xC6B8E9B0709F109Aull, 0x359AB6419CA1091Bull},
+    {0xF867241C8CC6D4C0ull, 0xC30163D203C94B62ull},
+    {0x9B407691D7FC44F8ull, 0x79E0DE63425DCF1Dull},
+    {0xC21094364DFB5636ull, 0x985915FC12F542E4ull},
+    {0xF294B943E17A2BC4ull, 0x3E6F5B7B17B2939Dull},
+    {0x979CF3CA6CEC5B5Aull, 0xA705992CEECF9C42ull},
+    {0xBD8430BD08277231ull, 0x50C6FF782A838353ull},
+    {0xECE53CEC4A314EBDull, 0xA4F8BF5635246428ull},
+    {0x940F4613AE5ED136ull, 0x871B7795E136BE99ull},
+    {0xB913179899F68584ull, 0x28E2557B59846E3Full},
+    {0xE757DD7EC07426E5ull, 0x331AEADA2FE589CFull},
+    {0x9096EA6F3848984Full, 0x3FF0D2C85DEF7621ull},
+    {0xB4BCA50B065ABE63ull, 0x0FED077A756B53A9ull},
+    {0xE1EBCE4DC7F16DFBull, 0xD3E8495912C62894ull},
+    {0x8D3360F09CF6E4BDull, 0x64712DD7ABBBD95Cull},
+    {0xB080392CC4349DECull, 0xBD8D794D96AACFB3ull},
+    {0xDCA04777F541C567ull, 0xECF0D7A0FC5583A0ull},
+    {0x89E42CAAF9491B60ull, 0xF41686C49DB57244ull},
+    {0xAC5D37D5B79B6239ull, 0x311C2875C522CED5ull},
+    {0xD77485CB25823AC7ull, 0x7D633293366B828Bull},
+    {0x86A8D39EF77164BCull, 0xAE5DFF9C02033197ull},
+    {0xA8530886B54DBDEBull, 0xD9F57F830283FDFCull},
+    {0xD267CAA862A12D66ull, 0xD072DF63C324FD7Bull},
+    {0x8380DEA93DA4BC60ull, 0x4247CB9E59F71E6Dull},
+    {0xA46116538D0DEB78ull, 0x52D9BE85F074E608ull},
+    {0xCD795BE870516656ull, 0x67902E276C921F8Bull},
+    {0x806BD9714632DFF6ull, 0x00BA1CD8A3DB53B6ull},
+    {0xA086CFCD97BF97F3ull, 0x80E8A40ECCD228A4ull},
+    {0xC8A883C0FDAF7DF0ull, 0x6122CD128006B2CDull},
+    {0xFAD2A4B13D1B5D6Cull, 0x796B805720085F81ull},
+    {0x9CC3A6EEC6311A63ull, 0xCBE3303674053BB0ull},
+    {0xC3F490AA77BD60FCull, 0xBEDBFC4411068A9Cull},
+    {0xF4F1B4D515ACB93Bull, 0xEE92FB5515482D44ull},
+    {0x991711052D8BF3C5ull, 0x751BDD152D4D1C4Aull},
+    {0xBF5CD54678EEF0B6ull, 0xD262D45A78A0635Dull},
+    {0xEF340A98172AACE4ull, 0x86FB897116C87C34ull},
+    {0x9580869F0E7AAC0Eull, 0xD45D35E6AE3D4DA0ull},
+    {0xBAE0A846D2195712ull, 0x8974836059CCA109ull},
+    {0xE998D258869FACD7ull, 0x2BD1A438703FC94Bull},
+    {0x91FF83775423CC06ull, 0x7B6306A34627DDCFull},
+    {0xB67F6455292CBF08ull, 0x1A3BC84C17B1D542ull},
+    {0xE41F3D6A7377EECAull, 0x20CABA5F1D9E4A93ull},
+    {0x8E938662882AF53Eull, 0x547EB47B7282EE9Cull},
+    {0xB23867FB2A35B28Dull, 0xE99E619A4F23AA43ull},
+    {0xDEC681F9F4C31F31ull, 0x6405FA00E2EC94D4ull},
+    {0x8B3C113C38F9F37Eull, 0xDE83BC408DD3DD04ull},
+    {0xAE0B158B4738705Eull, 0x9624AB50B148D445ull},
+    {0xD98DDAEE19068C76ull, 0x3BADD624DD9B0957ull},
+    {0x87F8A8D4CFA417C9ull, 0xE54CA5D70A80E5D6ull},
+    {0xA9F6D30A038D1DBCull, 0x5E9FCF4CCD211F4Cull},
+    {0xD47487CC8470652Bull, 0x7647C3200069671Full},
+    {0x84C8D4DFD2C63F3Bull, 0x29ECD9F40041E073ull},
+    {0xA5FB0A17C777CF09ull, 0xF468107100525890ull},
+    {0xCF79CC9DB955C2CCull, 0x7182148D4066EEB4ull},
+    {0x81AC1FE293D599BFull, 0xC6F14CD848405530ull},
+    {0xA21727DB38CB002Full, 0xB8ADA00E5A506A7Cull},
+    {0xCA9CF1D206FDC03Bull, 0xA6D90811F0E4851Cull},
+    {0xFD442E4688BD304Aull, 0x908F4A166D1DA663ull},
+    {0x9E4A9CEC15763E2Eull, 0x9A598E4E043287FEull},
+    {0xC5DD44271AD3CDBAull, 0x40EFF1E1853F29FDull},
+    {0xF7549530E188C128ull, 0xD12BEE59E68EF47Cull},
+    {0x9A94DD3E8CF578B9ull, 0x82BB74F8301958CEull},
+    {0xC13A148E3032D6E7ull, 0xE36A52363C1FAF01ull},
+    {0xF18899B1BC3F8CA1ull, 0xDC44E6C3CB279AC1ull},
+    {0x96F5600F15A7B7E5ull, 0x29AB103A5EF8C0B9ull},
+    {0xBCB2B812DB11A5DEull, 0x7415D448F6B6F0E7ull},
+    {0xEBDF661791D60F56ull, 0x111B495B3464AD21ull},
+    {0x936B9FCEBB25C995ull, 0xCAB10DD900BEEC34ull},
+    {0xB84687C269EF3BFBull, 0x3D5D514F40EEA742ull},
+    {0xE65829B3046B0AFAull, 0x0CB4A5A3112A5112ull},
+    {0x8FF71A0FE2C2E6DCull, 0x47F0E785EABA72ABull},
+    {0xB3F4E093DB73A093ull, 0x59ED216765690F56ull},
+    {0xE0F218B8D25088B8ull, 0x306869C13EC3532Cull},
+    {0x8C974F7383725573ull, 0x1E414218C73A13FBull},
+    {0xAFBD2350644EEACFull, 0xE5D1929EF90898FAull},
+    {0xDBAC6C247D62A583ull, 0xDF45F746B74ABF39ull},
+    {0x894BC396CE5DA772ull, 0x6B8BBA8C328EB783ull},
+    {0xAB9EB47C81F5114Full, 0x066EA92F3F326564ull},
+    {0xD686619BA27255A2ull, 0xC80A537B0EFEFEBDull},
+    {0x8613FD0145877585ull, 0xBD06742CE95F5F36ull},
+    {0xA798FC4196E952E7ull, 0x2C48113823B73704ull},
+    {0xD17F3B51FCA3A7A0ull, 0xF75A15862CA504C5ull},
+    {0x82EF85133DE648C4ull, 0x9A984D73DBE722FBull},
+    {0xA3AB66580D5FDAF5ull, 0xC13E60D0D2E0EBBAull},
+    {0xCC963FEE10B7D1B3ull, 0x318DF905079926A8ull},
+    {0xFFBBCFE994E5C61Full, 0xFDF17746497F7052ull},
+    {0x9FD561F1FD0F9BD3ull, 0xFEB6EA8BEDEFA633ull},
+    {0xC7CABA6E7C5382C8ull, 0xFE64A52EE96B8FC0ull},
+    {0xF9BD690A1B68637Bull, 0x3DFDCE7AA3C673B0ull},
+    {0x9C1661A651213E2Dull, 0x06BEA10CA65C084Eull},
+    {0xC31BFA0FE5698DB8ull, 0x486E494FCFF30A62ull},
+    {0xF3E2F893DEC3F126ull, 0x5A89DBA3C3EFCCFAull},
+    {0x986DDB5C6B3A76B7ull, 0xF89629465A75E01Cull},
+    {0xBE89523386091465ull, 0xF6BBB397F1135823ull},
+    {0xEE2BA6C0678B597Full, 0x746AA07DED582E2Cull},
+    {0x94DB483840B717EFull, 0xA8C2A44EB4571CDCull},
+    {0xBA121A4650E4DDEBull, 0x92F34D62616CE413ull},
+    {0xE896A0D7E51E1566ull, 0x77B020BAF9C81D17ull},
+    {0x915E2486EF32CD60ull, 0x0ACE1474DC1D122Eull},
+    {0xB5B5ADA8AAFF80B8ull, 0x0D819992132456BAull},
+    {0xE3231912D5BF60E6ull, 0x10E1FFF697ED6C69ull},
+    {0x8DF5EFABC5979C8Full, 0xCA8D3FFA1EF463C1ull},
+    {0xB1736B96B6FD83B3ull, 0xBD308FF8A6B17CB2ull},
+    {0xDDD0467C64BCE4A0ull, 0xAC7CB3F6D05DDBDEull},
+    {0x8AA22C0DBEF60EE4ull, 0x6BCDF07A423AA96Bull},
+    {0xAD4AB7112EB3929Dull, 0x86C16C98D2C953C6ull},
+    {0xD89D64D57A607744ull, 0xE871C7BF077BA8B7ull},
+    {0x87625F056C7C4A8Bull, 0x11471CD764AD4972ull},
+    {0xA93AF6C6C79B5D2Dull, 0xD598E40D3DD89BCFull},
+    {0xD389B47879823479ull, 0x4AFF1D108D4EC2C3ull},
+    {0x843610CB4BF160CBull, 0xCEDF722A585139BAull},
+    {0xA54394FE1EEDB8FEull, 0xC2974EB4EE658828ull},
+    {0xCE947A3DA6A9273Eull, 0x733D226229FEEA32ull},
+    {0x811CCC668829B887ull, 0x0806357D5A3F525Full},
+    {0xA163FF802A3426A8ull, 0xCA07C2DCB0CF26F7ull},
+    {0xC9BCFF6034C13052ull, 0xFC89B393DD02F0B5ull},
+    {0xFC2C3F3841F17C67ull, 0xBBAC2078D443ACE2ull},
+    {0x9D9BA7832936EDC0ull, 0xD54B944B84AA4C0Dull},
+    {0xC5029163F384A931ull, 0x0A9E795E65D4DF11ull},
+    {0xF64335BCF065D37Dull, 0x4D4617B5FF4A16D5ull},
+    {0x99EA0196163FA42Eull, 0x504BCED1BF8E4E45ull},
+    {0xC06481FB9BCF8D39ull, 0xE45EC2862F71E1D6ull},
+    {0xF07DA27A82C37088ull, 0x5D767327BB4E5A4Cull},
+    {0x964E858C91BA2655ull, 0x3A6A07F8D510F86Full},
+    {0xBBE226EFB628AFEAull, 0x890489F70A55368Bull},
+    {0xEADAB0ABA3B2DBE5ull, 0x2B45AC74CCEA842Eull},
+    {0x92C8AE6B464FC96Full, 0x3B0B8BC90012929Dull},
+    {0xB77ADA0617E3BBCBull, 0x09CE6EBB40173744ull},
+    {0xE55990879DDCAABDull, 0xCC420A6A101D0515ull},
+    {0x8F57FA54C2A9EAB6ull, 0x9FA946824A12232Dull},
+    {0xB32DF8E9F3546564ull, 0x47939822DC96ABF9ull},
+    {0xDFF9772470297EBDull, 0x59787E2B93BC56F7ull},
+    {0x8BFBEA76C619EF36ull, 0x57EB4EDB3C55B65Aull},
+    {0xAEFAE51477A06B03ull, 0xEDE622920B6B23F1ull},
+    {0xDAB99E59958885C4ull, 0xE95FAB368E45ECEDull},
+    {0x88B402F7FD75539Bull, 0x11DBCB0218EBB414ull},
+    {0xAAE103B5FCD2A881ull, 0xD652BDC29F26A119ull},
+    {0xD59944A37C0752A2ull, 0x4BE76D3346F0495Full},
+    {0x857FCAE62D8493A5ull, 0x6F70A4400C562DDBull},
+    {0xA6DFBD9FB8E5B88Eull, 0xCB4CCD500F6BB952ull},
+    {0xD097AD07A71F26B2ull, 0x7E2000A41346A7A7ull},
+    {0x825ECC24C873782Full, 0x8ED400668C0C28C8ull},
+    {0xA2F67F2DFA90563Bull, 0x728900802F0F32FAull},
+    {0xCBB41EF979346BCAull, 0x4F2B40A03AD2FFB9ull},
+    {0xFEA126B7D78186BCull, 0xE2F610C84987BFA8ull},
+    {0x9F24B832E6B0F436ull, 0x0DD9CA7D2DF4D7C9ull},
+    {0xC6EDE63FA05D3143ull, 0x91503D1C79720DBBull},
+    {0xF8A95FCF88747D94ull, 0x75A44C6397CE912Aull},
+    {0x9B69DBE1B548CE7Cull, 0xC986AFBE3EE11ABAull},
+    {0xC24452DA229B021Bull, 0xFBE85BADCE996168ull},
+    {0xF2D56790AB41C2A2ull, 0xFAE27299423FB9C3ull},
+    {0x97C560BA6B0919A5ull, 0xDCCD879FC967D41Aull},
+    {0xBDB6B8E905CB600Full, 0x5400E987BBC1C920ull},
+    {0xED246723473E3813ull, 0x290123E9AAB23B68ull},
+    {0x9436C0760C86E30Bull, 0xF9A0B6720AAF6521ull},
+    {0xB94470938FA89BCEull, 0xF808E40E8D5B3E69ull},
+    {0xE7958CB87392C2C2ull, 0xB60B1D1230B20E04ull},
+    {0x90BD77F3483BB9B9ull, 0xB1C6F22B5E6F48C2ull},
+    {0xB4ECD5F01A4AA828ull, 0x1E38AEB6360B1AF3ull},
+    {0xE2280B6C20DD5232ull, 0x25C6DA63C38DE1B0ull},
+    {0x8D590723948A535Full, 0x579C487E5A38AD0Eull},
+    {0xB0AF48EC79ACE837ull, 0x2D835A9DF0C6D851ull},
+    {0xDCDB1B2798182244ull, 0xF8E431456CF88E65ull},
+    {0x8A08F0F8BF0F156Bull, 0x1B8E9ECB641B58FFull},
+    {0xAC8B2D36EED2DAC5ull, 0xE272467E3D222F3Full},
+    {0xD7ADF884AA879177ull, 0x5B0ED81DCC6ABB0Full},
+    {0x86CCBB52EA94BAEAull, 0x98E947129FC2B4E9ull},
+    {0xA87FEA27A539E9A5ull, 0x3F2398D747B36224ull},
+    {0xD29FE4B18E88640Eull, 0x8EEC7F0D19A03AADull},
+    {0x83A3EEEEF9153E89ull, 0x1953CF68300424ACull},
+    {0xA48CEAAAB75A8E2Bull, 0x5FA8C3423C052DD7ull},
+    {0xCDB02555653131B6ull, 0x3792F412CB06794Dull},
+    {0x808E17555F3EBF11ull, 0xE2BBD88BBEE40BD0ull},
+    {0xA0B19D2AB70E6ED6ull, 0x5B6ACEAEAE9D0EC4ull},
+    {0xC8DE047564D20A8Bull, 0xF245825A5A445275ull},
+    {0xFB158592BE068D2Eull, 0xEED6E2F0F0D56712ull},
+    {0x9CED737BB6C4183Dull, 0x55464DD69685606Bull},
+    {0xC428D05AA4751E4Cull, 0xAA97E14C3C26B886ull},
+    {0xF53304714D9265DFull, 0xD53DD99F4B3066A8ull},
+    {0x993FE2C6D07B7FABull, 0xE546A8038EFE4029ull},
+    {0xBF8FDB78849A5F96ull, 0xDE98520472BDD033ull},
+    {0xEF73D256A5C0F77Cull, 0x963E66858F6D4440ull},
+    {0x95A8637627989AADull, 0xDDE7001379A44AA8ull},
+    {0xBB127C53B17EC159ull, 0x5560C018580D5D52ull},
+    {0xE9D71B689DDE71AFull, 0xAAB8F01E6E10B4A6ull},
+    {0x9226712162AB070Dull, 0xCAB3961304CA70E8ull},
+    {0xB6B00D69BB55C8D1ull, 0x3D607B97C5FD0D22ull},
+    {0xE45C10C42A2B3B05ull, 0x8CB89A7DB77C506Aull},
+    {0x8EB98A7A9A5B04E3ull, 0x77F3608E92ADB242ull},
+    {0xB267ED1940F1C61Cull, 0x55F038B237591ED3ull},
+    {0xDF01E85F912E37A3ull, 0x6B6C46DEC52F6688ull},
+    {0x8B61313BBABCE2C6ull, 0x2323AC4B3B3DA015ull},
+    {0xAE397D8AA96C1B77ull, 0xABEC975E0A0D081Aull},
+    {0xD9C7DCED53C72255ull, 0x96E7BD358C904A21ull},
+    {0x881CEA14545C7575ull, 0x7E50D64177DA2E54ull},
+    {0xAA242499697392D2ull, 0xDDE50BD1D5D0B9E9ull},
+    {0xD4AD2DBFC3D07787ull, 0x955E4EC64B44E864ull},
+    {0x84EC3C97DA624AB4ull, 0xBD5AF13BEF0B113Eull},
+    {0xA6274BBDD0FADD61ull, 0xECB1AD8AEACDD58Eull},
+    {0xCFB11EAD453994BAull, 0x67DE18EDA5814AF2ull},
+    {0x81CEB32C4B43FCF4ull, 0x80EACF948770CED7ull},
+    {0xA2425FF75E14FC31ull, 0xA1258379A94D028Dull},
+    {0xCAD2F7F5359A3B3Eull, 0x096EE45813A04330ull},
+    {0xFD87B5F28300CA0Dull, 0x8BCA9D6E188853FCull},
+    {0x9E74D1B791E07E48ull, 0x775EA264CF55347Dull},
+    {0xC612062576589DDAull, 0x95364AFE032A819Dull},
+    {0xF79687AED3EEC551ull, 0x3A83DDBD83F52204ull},
+    {0x9ABE14CD44753B52ull, 0xC4926A9672793542ull},
+    {0xC16D9A0095928A27ull, 0x75B7053C0F178293ull},
+    {0xF1C90080BAF72CB1ull, 0x5324C68B12DD6338ull},
+    {0x971DA05074DA7BEEull, 0xD3F6FC16EBCA5E03ull},
+    {0xBCE5086492111AEAull, 0x88F4BB1CA6BCF584ull},
+    {0xEC1E4A7DB69561A5ull, 0x2B31E9E3D06C32E5ull},
+    {0x9392EE8E921D5D07ull, 0x3AFF322E62439FCFull},
+    {0xB877AA3236A4B449ull, 0x09BEFEB9FAD487C2ull},
+    {0xE69594BEC44DE15Bull, 0x4C2EBE687989A9B3ull},
+    {0x901D7CF73AB0ACD9ull, 0x0F9D37014BF60A10ull},
+    {0xB424DC35095CD80Full, 0x538484C19EF38C94ull},
+    {0xE12E13424BB40E13ull, 0x2865A5F206B06FB9ull},
+    {0x8CBCCC096F5088CBull, 0xF93F87B7442E45D3ull},
+    {0xAFEBFF0BCB24AAFEull, 0xF78F69A51539D748ull},
+    {0xDBE6FECEBDEDD5BEull, 0xB573440E5A884D1Bull},
+    {0x89705F4136B4A597ull, 0x31680A88F8953030ull},
+    {0xABCC77118461CEFCull, 0xFDC20D2B36BA7C3Dull},
+    {0xD6BF94D5E57A42BCull, 0x3D32907604691B4Cull},
+    {0x8637BD05AF6C69B5ull, 0xA63F9A49C2C1B10Full},
+    {0xA7C5AC471B478423ull, 0x0FCF80DC33721D53ull},
+    {0xD1B71758E219652Bull, 0xD3C36113404EA4A8ull},
+    {0x83126E978D4FDF3Bull, 0x645A1CAC083126E9ull},
+    {0xA3D70A3D70A3D70Aull, 0x3D70A3D70A3D70A3ull},
+    {0xCCCCCCCCCCCCCCCCull, 0xCCCCCCCCCCCCCCCCull},
+    {0x8000000000000000ull, 0x0000000000000000ull},
+    {0xA000000000000000ull, 0x0000000000000000ull},
+    {0xC800000000000000ull, 0x0000000000000000ull},
+    {0xFA00000000000000ull, 0x0000000000000000ull},
+    {0x9C40000000000000ull, 0x0000000000000000ull},
+    {0xC350000000000000ull, 0x0000000000000000ull},
+    {0xF424000000000000ull, 0x0000000000000000ull},
+    {0x9896800000000000ull, 0x0000000000000000ull},
+    {0xBEBC200000000000ull, 0x0000000000000000ull},
+    {0xEE6B280000000000ull, 0x0000000000000000ull},
+    {0x9502F90000000000ull, 0x0000000000000000ull},
+    {0xBA43B74000000000ull, 0x0000000000000000ull},
+    {0xE8D4A51000000000ull, 0x0000000000000000ull},
+    {0x9184E72A00000000ull, 0x0000000000000000ull},
+    {0xB5E620F480000000ull, 0x0000000000000000ull},
+    {0xE35FA931A0000000ull, 0x0000000000000000ull},
+    {0x8E1BC9BF04000000ull, 0x0000000000000000ull},
+    {0xB1A2BC2EC5000000ull, 0x0000000000000000ull},
+    {0xDE0B6B3A76400000ull, 0x0000000000000000ull},
+    {0x8AC7230489E80000ull, 0x0000000000000000ull},
+    {0xAD78EBC5AC620000ull, 0x0000000000000000ull},
+    {0xD8D726B7177A8000ull, 0x0000000000000000ull},
+    {0x878678326EAC9000ull, 0x0000000000000000ull},
+    {0xA968163F0A57B400ull, 0x0000000000000000ull},
+    {0xD3C21BCECCEDA100ull, 0x0000000000000000ull},
+    {0x84595161401484A0ull, 0x0000000000000000ull},
+    {0xA56FA5B99019A5C8ull, 0x0000000000000000ull},
+    {0xCECB8F27F4200F3Aull, 0x0000000000000000ull},
+    {0x813F3978F8940984ull, 0x4000000000000000ull},
+    {0xA18F07D736B90BE5ull, 0x5000000000000000ull},
+    {0xC9F2C9CD04674EDEull, 0xA400000000000000ull},
+    {0xFC6F7C4045812296ull, 0x4D00000000000000ull},
+    {0x9DC5ADA82B70B59Dull, 0xF020000000000000ull},
+    {0xC5371912364CE305ull, 0x6C28000000000000ull},
+    {0xF684DF56C3E01BC6ull, 0xC732000000000000ull},
+    {0x9A130B963A6C115Cull, 0x3C7F400000000000ull},
+    {0xC097CE7BC90715B3ull, 0x4B9F100000000000ull},
+    {0xF0BDC21ABB48DB20ull, 0x1E86D40000000000ull},
+    {0x96769950B50D88F4ull, 0x1314448000000000ull},
+    {0xBC143FA4E250EB31ull, 0x17D955A000000000ull},
+    {0xEB194F8E1AE525FDull, 0x5DCFAB0800000000ull},
+    {0x92EFD1B8D0CF37BEull, 0x5AA1CAE500000000ull},
+    {0xB7ABC627050305ADull, 0xF14A3D9E40000000ull},
+    {0xE596B7B0C643C719ull, 0x6D9CCD05D0000000ull},
+    {0x8F7E32CE7BEA5C6Full, 0xE4820023A2000000ull},
+    {0xB35DBF821AE4F38Bull, 0xDDA2802C8A800000ull},
+    {0xE0352F62A19E306Eull, 0xD50B2037AD200000ull},
+    {0x8C213D9DA502DE45ull, 0x4526F422CC340000ull},
+    {0xAF298D050E4395D6ull, 0x9670B12B7F410000ull},
+    {0xDAF3F04651D47B4Cull, 0x3C0CDD765F114000ull},
+    {0x88D8762BF324CD0Full, 0xA5880A69FB6AC800ull},
+    {0xAB0E93B6EFEE0053ull, 0x8EEA0D047A457A00ull},
+    {0xD5D238A4ABE98068ull, 0x72A4904598D6D880ull},
+    {0x85A36366EB71F041ull, 0x47A6DA2B7F864750ull},
+    {0xA70C3C40A64E6C51ull, 0x999090B65F67D924ull},
+    {0xD0CF4B50CFE20765ull, 0xFFF4B4E3F741CF6Dull},
+    {0x82818F1281ED449Full, 0xBFF8F10E7A8921A4ull},
+    {0xA321F2D7226895C7ull, 0xAFF72D52192B6A0Dull},
+    {0xCBEA6F8CEB02BB39ull, 0x9BF4F8A69F764490ull},
+    {0xFEE50B7025C36A08ull, 0x02F236D04753D5B4ull},
+    {0x9F4F2726179A2245ull, 0x01D762422C946590ull},
+    {0xC722F0EF9D80AAD6ull, 0x424D3AD2B7B97EF5ull},
+    {0xF8EBAD2B84E0D58Bull, 0xD2E0898765A7DEB2ull},
+    {0x9B934C3B330C8577ull, 0x63CC55F49F88EB2Full},
+    {0xC2781F49FFCFA6D5ull, 0x3CBF6B71C76B25FBull},
+    {0xF316271C7FC3908Aull, 0x8BEF464E3945EF7Aull},
+    {0x97EDD871CFDA3A56ull, 0x97758BF0E3CBB5ACull},
+    {0xBDE94E8E43D0C8ECull, 0x3D52EEED1CBEA317ull},
+    {0xED63A231D4C4FB27ull, 0x4CA7AAA863EE4BDDull},
+    {0x945E455F24FB1CF8ull, 0x8FE8CAA93E74EF6Aull},
+    {0xB975D6B6EE39E436ull, 0xB3E2FD538E122B44ull},
+    {0xE7D34C64A9C85D44ull, 0x60DBBCA87196B616ull},
+    {0x90E40FBEEA1D3A4Aull, 0xBC8955E946FE31CDull},
+    {0xB51D13AEA4A488DDull, 0x6BABAB6398BDBE41ull},
+    {0xE264589A4DCDAB14ull, 0xC696963C7EED2DD1ull},
+    {0x8D7EB76070A08AECull, 0xFC1E1DE5CF543CA2ull},
+    {0xB0DE65388CC8ADA8ull, 0x3B25A55F43294BCBull},
+    {0xDD15FE86AFFAD912ull, 0x49EF0EB713F39EBEull},
+    {0x8A2DBF142DFCC7ABull, 0x6E3569326C784337ull},
+    {0xACB92ED9397BF996ull, 0x49C2C37F07965404ull},
+    {0xD7E77A8F87DAF7FBull, 0xDC33745EC97BE906ull},
+    {0x86F0AC99B4E8DAFDull, 0x69A028BB3DED71A3ull},
+    {0xA8ACD7C0222311BCull, 0xC40832EA0D68CE0Cull},
+    {0xD2D80DB02AABD62Bull, 0xF50A3FA490C30190ull},
+    {0x83C7088E1AAB65DBull, 0x792667C6DA79E0FAull},
+    {0xA4B8CAB1A1563F52ull, 0x577001B891185938ull},
+    {0xCDE6FD5E09ABCF26ull, 0xED4C0226B55E6F86ull},
+    {0x80B05E5AC60B6178ull, 0x544F8158315B05B4ull},
+    {0xA0DC75F1778E39D6ull, 0x696361AE3DB1C721ull},
+    {0xC913936DD571C84Cull, 0x03BC3A19CD1E38E9ull},
+    {0xFB5878494ACE3A5Full, 0x04AB48A04065C723ull},
+    {0x9D174B2DCEC0E47Bull, 0x62EB0D64283F9C76ull},
+    {0xC45D1DF942711D9Aull, 0x3BA5D0BD324F8394ull},
+    {0xF5746577930D6500ull, 0xCA8F44EC7EE36479ull},
+    {0x9968BF6ABBE85F20ull, 0x7E998B13CF4E1ECBull},
+    {0xBFC2EF456AE276E8ull, 0x9E3FEDD8C321A67Eull},
+    {0xEFB3AB16C59B14A2ull, 0xC5CFE94EF3EA101Eull},
+    {0x95D04AEE3B80ECE5ull, 0xBBA1F1D158724A12ull},
+    {0xBB445DA9CA61281Full, 0x2A8A6E45AE8EDC97ull},
+    {0xEA1575143CF97226ull, 0xF52D09D71A3293BDull},
+    {0x924D692CA61BE758ull, 0x593C2626705F9C56ull},
+    {0xB6E0C377CFA2E12Eull, 0x6F8B2FB00C77836Cull},
+    {0xE498F455C38B997Aull, 0x0B6DFB9C0F956447ull},
+    {0x8EDF98B59A373FECull, 0x4724BD4189BD5EACull},
+    {0xB2977EE300C50FE7ull, 0x58EDEC91EC2CB657ull},
+    {0xDF3D5E9BC0F653E1ull, 0x2F2967B66737E3EDull},
+    {0x8B865B215899F46Cull, 0xBD79E0D20082EE74ull},
+    {0xAE67F1E9AEC07187ull, 0xECD8590680A3AA11ull},
+    {0xDA01EE641A708DE9ull, 0xE80E6F4820CC9495ull},
+    {0x884134FE908658B2ull, 0x3109058D147FDCDDull},
+    {0xAA51823E34A7EEDEull, 0xBD4B46F0599FD415ull},
+    {0xD4E5E2CDC1D1EA96ull, 0x6C9E18AC7007C91Aull},
+    {0x850FADC09923329Eull, 0x03E2CF6BC604DDB0ull},
+    {0xA6539930BF6BFF45ull, 0x84DB8346B786151Cull},
+    {0xCFE87F7CEF46FF16ull, 0xE612641865679A63ull},
+    {0x81F14FAE158C5F6Eull, 0x4FCB7E8F3F60C07Eull},
+    {0xA26DA3999AEF7749ull, 0xE3BE5E330F38F09Dull},
+    {0xCB090C8001AB551Cull, 0x5CADF5BFD3072CC5ull},
+    {0xFDCB4FA002162A63ull, 0x73D9732FC7C8F7F6ull},
+    {0x9E9F11C4014DDA7Eull, 0x2867E7FDDCDD9AFAull},
+    {0xC646D63501A1511Dull, 0xB281E1FD541501B8ull},
+    {0xF7D88BC24209A565ull, 0x1F225A7CA91A4226ull},
+    {0x9AE757596946075Full, 0x3375788DE9B06958ull},
+    {0xC1A12D2FC3978937ull, 0x0052D6B1641C83AEull},
+    {0xF209787BB47D6B84ull, 0xC0678C5DBD23A49Aull},
+    {0x9745EB4D50CE6332ull, 0xF840B7BA963646E0ull},
+    {0xBD176620A501FBFFull, 0xB650E5A93BC3D898ull},
+    {0xEC5D3FA8CE427AFFull, 0xA3E51F138AB4CEBEull},
+    {0x93BA47C980E98CDFull, 0xC66F336C36B10137ull},
+    {0xB8A8D9BBE123F017ull, 0xB80B0047445D4184ull},
+    {0xE6D3102AD96CEC1Dull, 0xA60DC059157491E5ull},
+    {0x9043EA1AC7E41392ull, 0x87C89837AD68DB2Full},
+    {0xB454E4A179DD1877ull, 0x29BABE4598C311FBull},
+    {0xE16A1DC9D8545E94ull, 0xF4296DD6FEF3D67Aull},
+    {0x8CE2529E2734BB1Dull, 0x1899E4A65F58660Cull},
+    {0xB01AE745B101E9E4ull, 0x5EC05DCFF72E7F8Full},
+    {0xDC21A1171D42645Dull, 0x76707543F4FA1F73ull},
+    {0x899504AE72497EBAull, 0x6A06494A791C53A8ull},
+    {0xABFA45DA0EDBDE69ull, 0x0487DB9D17636892ull},
+    {0xD6F8D7509292D603ull, 0x45A9D2845D3C42B6ull},
+    {0x865B86925B9BC5C2ull, 0x0B8A2392BA45A9B2ull},
+    {0xA7F26836F282B732ull, 0x8E6CAC7768D7141Eull},
+    {0xD1EF0244AF2364FFull, 0x3207D795430CD926ull},
+    {0x8335616AED761F1Full, 0x7F44E6BD49E807B8ull},
+    {0xA402B9C5A8D3A6E7ull, 0x5F16206C9C6209A6ull},
+    {0xCD036837130890A1ull, 0x36DBA887C37A8C0Full},
+    {0x802221226BE55A64ull, 0xC2494954DA2C9789ull},
+    {0xA02AA96B06DEB0FDull, 0xF2DB9BAA10B7BD6Cull},
+    {0xC83553C5C8965D3Dull, 0x6F92829494E5ACC7ull},
+    {0xFA42A8B73ABBF48Cull, 0xCB772339BA1F17F9ull},
+    {0x9C69A97284B578D7ull, 0xFF2A760414536EFBull},
+    {0xC38413CF25E2D70Dull, 0xFEF5138519684ABAull},
+    {0xF46518C2EF5B8CD1ull, 0x7EB258665FC25D69ull},
+    {0x98BF2F79D5993802ull, 0xEF2F773FFBD97A61ull},
+    {0xBEEEFB584AFF8603ull, 0xAAFB550FFACFD8FAull},
+    {0xEEAABA2E5DBF6784ull, 0x95BA2A53F983CF38ull},
+    {0x952AB45CFA97A0B2ull, 0xDD945A747BF26183ull},
+    {0xBA756174393D88DFull, 0x94F971119AEEF9E4ull},
+    {0xE912B9D1478CEB17ull, 0x7A37CD5601AAB85Dull},
+    {0x91ABB422CCB812EEull, 0xAC62E055C10AB33Aull},
+    {0xB616A12B7FE617AAull, 0x577B986B314D6009ull},
+    {0xE39C49765FDF9D94ull, 0xED5A7E85FDA0B80Bull},
+    {0x8E41ADE9FBEBC27Dull, 0x14588F13BE847307ull},
+    {0xB1D219647AE6B31Cull, 0x596EB2D8AE258FC8ull},
+    {0xDE469FBD99A05FE3ull, 0x6FCA5F8ED9AEF3BBull},
+    {0x8AEC23D680043BEEull, 0x25DE7BB9480D5854ull},
+    {0xADA72CCC20054AE9ull, 0xAF561AA79A10AE6Aull},
+    {0xD910F7FF28069DA4ull, 0x1B2BA1518094DA04ull},
+    {0x87AA9AFF79042286ull, 0x90FB44D2F05D0842ull},
+    {0xA99541BF57452B28ull, 0x353A1607AC744A53ull},
+    {0xD3FA922F2D1675F2ull, 0x42889B8997915CE8ull},
+    {0x847C9B5D7C2E09B7ull, 0x69956135FEBADA11ull},
+    {0xA59BC234DB398C25ull, 0x43FAB9837E699095ull},
+    {0xCF02B2C21207EF2Eull, 0x94F967E45E03F4BBull},
+    {0x8161AFB94B44F57Dull, 0x1D1BE0EEBAC278F5ull},
+    {0xA1BA1BA79E1632DCull, 0x6462D92A69731732ull},
+    {0xCA28A291859BBF93ull, 0x7D7B8F7503CFDCFEull},
+    {0xFCB2CB35E702AF78ull, 0x5CDA735244C3D43Eull},
+    {0x9DEFBF01B061ADABull, 0x3A0888136AFA64A7ull},
+    {0xC56BAEC21C7A1916ull, 0x088AAA1845B8FDD0ull},
+    {0xF6C69A72A3989F5Bull, 0x8AAD549E57273D45ull},
+    {0x9A3C2087A63F6399ull, 0x36AC54E2F678864Bull},
+    {0xC0CB28A98FCF3C7Full, 0x84576A1BB416A7DDull},
+    {0xF0FDF2D3F3C30B9Full, 0x656D44A2A11C51D5ull},
+    {0x969EB7C47859E743ull, 0x9F644AE5A4B1B325ull},
+    {0xBC4665B596706114ull, 0x873D5D9F0DDE1FEEull},
+    {0xEB57FF22FC0C7959ull, 0xA90CB506D155A7EAull},
+    {0x9316FF75DD87CBD8ull, 0x09A7F12442D588F2ull},
+    {0xB7DCBF5354E9BECEull, 0x0C11ED6D538AEB2Full},
+    {0xE5D3EF282A242E81ull, 0x8F1668C8A86DA5FAull},
+    {0x8FA475791A569D10ull, 0xF96E017D694487BCull},
+    {0xB38D92D760EC4455ull, 0x37C981DCC395A9ACull},
+    {0xE070F78D3927556Aull, 0x85BBE253F47B1417ull},
+    {0x8C469AB843B89562ull, 0x93956D7478CCEC8Eull},
+    {0xAF58416654A6BABBull, 0x387AC8D1970027B2ull},
+    {0xDB2E51BFE9D0696Aull, 0x06997B05FCC0319Eull},
+    {0x88FCF317F22241E2ull, 0x441FECE3BDF81F03ull},
+    {0xAB3C2FDDEEAAD25Aull, 0xD527E81CAD7626C3ull},
+    {0xD60B3BD56A5586F1ull, 0x8A71E223D8D3B074ull},
+    {0x85C7056562757456ull, 0xF6872D5667844E49ull},
+    {0xA738C6BEBB12D16Cull, 0xB428F8AC016561DBull},
+    {0xD106F86E69D785C7ull, 0xE13336D701BEBA52ull},
+    {0x82A45B450226B39Cull, 0xECC0024661173473ull},
+    {0xA34D721642B06084ull, 0x27F002D7F95D0190ull},
+    {0xCC20CE9BD35C78A5ull, 0x31EC038DF7B441F4ull},
+    {0xFF290242C83396CEull, 0x7E67047175A15271ull},
+    {0x9F79A169BD203E41ull, 0x0F0062C6E984D386ull},
+    {0xC75809C42C684DD1ull, 0x52C07B78A3E60868ull},
+    {0xF92E0C3537826145ull, 0xA7709A56CCDF8A82ull},
+    {0x9BBCC7A142B17CCBull, 0x88A66076400BB691ull},
+    {0xC2ABF989935DDBFEull, 0x6ACFF893D00EA435ull},
+    {0xF356F7EBF83552FEull, 0x0583F6B8C4124D43ull},
+    {0x98165AF37B2153DEull, 0xC3727A337A8B704Aull},
+    {0xBE1BF1B059E9A8D6ull, 0x744F18C0592E4C5Cull},
+    {0xEDA2EE1C7064130Cull, 0x1162DEF06F79DF73ull},
+    {0x9485D4D1C63E8BE7ull, 0x8ADDCB5645AC2BA8ull},
+    {0xB9A74A0637CE2EE1ull, 0x6D953E2BD7173692ull},
+    {0xE8111C87C5C1BA99ull, 0xC8FA8DB6CCDD0437ull},
+    {0x910AB1D4DB9914A0ull, 0x1D9C9892400A22A2ull},
+    {0xB54D5E4A127F59C8ull, 0x2503BEB6D00CAB4Bull},
+    {0xE2A0B5DC971F303Aull, 0x2E44AE64840FD61Dull},
+    {0x8DA471A9DE737E24ull, 0x5CEAECFED289E5D2ull},
+    {0xB10D8E1456105DADull, 0x7425A83E872C5F47ull},
+    {0xDD50F1996B947518ull, 0xD12F124E28F77719ull},
+    {0x8A5296FFE33CC92Full, 0x82BD6B70D99AAA6Full},
+    {0xACE73CBFDC0BFB7Bull, 0x636CC64D1001550Bull},
+    {0xD8210BEFD30EFA5Aull, 0x3C47F7E05401AA4Eull},
+    {0x8714A775E3E95C78ull, 0x65ACFAEC34810A71ull},
+    {0xA8D9D1535CE3B396ull, 0x7F1839A741A14D0Dull},
+    {0xD31045A8341CA07Cull, 0x1EDE48111209A050ull},
+    {0x83EA2B892091E44Dull, 0x934AED0AAB460432ull},
+    {0xA4E4B66B68B65D60ull, 0xF81DA84D5617853Full},
+    {0xCE1DE40642E3F4B9ull, 0x36251260AB9D668Eull},
+    {0x80D2AE83E9CE78F3ull, 0xC1D72B7C6B426019ull},
+    {0xA1075A24E4421730ull, 0xB24CF65B8612F81Full},
+    {0xC94930AE1D529CFCull, 0xDEE033F26797B627ull},
+    {0xFB9B7CD9A4A7443Cull, 0x169840EF017DA3B1ull},
+    {0x9D412E0806E88AA5ull, 0x8E1F289560EE864Eull},
+    {0xC491798A08A2AD4Eull, 0xF1A6F2BAB92A27E2ull},
+    {0xF5B5D7EC8ACB58A2ull, 0xAE10AF696774B1DBull},
+    {0x9991A6F3D6BF1765ull, 0xACCA6DA1E0A8EF29ull},
+    {0xBFF610B0CC6EDD3Full, 0x17FD090A58D32AF3ull},
+    {0xEFF394DCFF8A948Eull, 0xDDFC4B4CEF07F5B0ull},
+    {0x95F83D0A1FB69CD9ull, 0x4ABDAF101564F98Eull},
+    {0xBB764C4CA7A4440Full, 0x9D6D1AD41ABE37F1ull},
+    {0xEA53DF5FD18D5513ull, 0x84C86189216DC5EDull},
+    {0x92746B9BE2F8552Cull, 0x32FD3CF5B4E49BB4ull},
+    {0xB7118682DBB66A77ull, 0x3FBC8C33221DC2A1ull},
+    {0xE4D5E82392A40515ull, 0x0FABAF3FEAA5334Aull},
+    {0x8F05B1163BA6832Dull, 0x29CB4D87F2A7400Eull},
+    {0xB2C71D5BCA9023F8ull, 0x743E20E9EF511012ull},
+    {0xDF78E4B2BD342CF6ull, 0x914DA9246B255416ull},
+    {0x8BAB8EEFB6409C1Aull, 0x1AD089B6C2F7548Eull},
+    {0xAE9672ABA3D0C320ull, 0xA184AC2473B529B1ull},
+    {0xDA3C0F568CC4F3E8ull, 0xC9E5D72D90A2741Eull},
+    {0x8865899617FB1871ull, 0x7E2FA67C7A658892ull},
+    {0xAA7EEBFB9DF9DE8Dull, 0xDDBB901B98FEEAB7ull},
+    {0xD51EA6FA85785631ull, 0x552A74227F3EA565ull},
+    {0x8533285C936B35DEull, 0xD53A88958F87275Full},
+    {0xA67FF273B8460356ull, 0x8A892ABAF368F137ull},
+    {0xD01FEF10A657842Cull, 0x2D2B7569B0432D85ull},
+    {0x8213F56A67F6B29Bull, 0x9C3B29620E29FC73ull},
+    {0xA298F2C501F45F42ull, 0x8349F3BA91B47B8Full},
+    {0xCB3F2F7642717713ull, 0x241C70A936219A73ull},
+    {0xFE0EFB53D30DD4D7ull, 0xED238CD383AA0110ull},
+    {0x9EC95D1463E8A506ull, 0xF4363804324A40AAull},
+    {0xC67BB4597CE2CE48ull, 0xB143C6053EDCD0D5ull},
+    {0xF81AA16FDC1B81DAull, 0xDD94B7868E94050Aull},
+    {0x9B10A4E5E9913128ull, 0xCA7CF2B4191C8326ull},
+    {0xC1D4CE1F63F57D72ull, 0xFD1C2F611F63A3F0ull},
+    {0xF24A01A73CF2DCCFull, 0xBC633B39673C8CECull},
+    {0x976E41088617CA01ull, 0xD5BE0503E085D813ull},
+    {0xBD49D14AA79DBC82ull, 0x4B2D8644D8A74E18ull},
+    {0xEC9C459D51852BA2ull, 0xDDF8E7D60ED1219Eull},
+    {0x93E1AB8252F33B45ull, 0xCABB90E5C942B503ull},
+    {0xB8DA1662E7B00A17ull, 0x3D6A751F3B936243ull},
+    {0xE7109BFBA19C0C9Dull, 0x0CC512670A783AD4ull},
+    {0x906A617D450187E2ull, 0x27FB2B80668B24C5ull},
+    {0xB484F9DC9641E9DAull, 0xB1F9F660802DEDF6ull},
+    {0xE1A63853BBD26451ull, 0x5E7873F8A0396973ull},
+    {0x8D07E33455637EB2ull, 0xDB0B487B6423E1E8ull},
+    {0xB049DC016ABC5E5Full, 0x91CE1A9A3D2CDA62ull},
+    {0xDC5C5301C56B75F7ull, 0x7641A140CC7810FBull},
+    {0x89B9B3E11B6329BAull, 0xA9E904C87FCB0A9Dull},
+    {0xAC2820D9623BF429ull, 0x546345FA9FBDCD44ull},
+    {0xD732290FBACAF133ull, 0xA97C177947AD4095ull},
+    {0x867F59A9D4BED6C0ull, 0x49ED8EABCCCC485Dull},
+    {0xA81F301449EE8C70ull, 0x5C68F256BFFF5A74ull},
+    {0xD226FC195C6A2F8Cull, 0x73832EEC6FFF3111ull},
+    {0x83585D8FD9C25DB7ull, 0xC831FD53C5FF7EABull},
+    {0xA42E74F3D032F525ull, 0xBA3E7CA8B77F5E55ull},
+    {0xCD3A1230C43FB26Full, 0x28CE1BD2E55F35EBull},
+    {0x80444B5E7AA7CF85ull, 0x7980D163CF5B81B3ull},
+    {0xA0555E361951C366ull, 0xD7E105BCC332621Full},
+    {0xC86AB5C39FA63440ull, 0x8DD9472BF3FEFAA7ull},
+    {0xFA856334878FC150ull, 0xB14F98F6F0FEB951ull},
+    {0x9C935E00D4B9D8D2ull, 0x6ED1BF9A569F33D3ull},
+    {0xC3B8358109E84F07ull, 0x0A862F80EC4700C8ull},
+    {0xF4A642E14C6262C8ull, 0xCD27BB612758C0FAull},
+    {0x98E7E9CCCFBD7DBDull, 0x8038D51CB897789Cull},
+    {0xBF21E44003ACDD2Cull, 0xE0470A63E6BD56C3ull},
+    {0xEEEA5D5004981478ull, 0x1858CCFCE06CAC74ull},
+    {0x95527A5202DF0CCBull, 0x0F37801E0C43EBC8ull},
+    {0xBAA718E68396CFFDull, 0xD30560258F54E6BAull},
+    {0xE950DF20247C83FDull, 0x47C6B82EF32A2069ull},
+    {0x91D28B7416CDD27Eull, 0x4CDC331D57FA5441ull},
+    {0xB6472E511C81471Dull, 0xE0133FE4ADF8E952ull},
+    {0xE3D8F9E563A198E5ull, 0x58180FDDD97723A6ull},
+    {0x8E679C2F5E44FF8Full, 0x570F09EAA7EA7648ull},
+  };
+  return POW10[q + 342];
+}
+
+/**
+ * Converts w * 10^q to the nearest double by multiplying with a 128-bit
+ * approximation of the power of ten (Eisel-Lemire, see Lemire, "Number
+ * Parsing at a Gigabyte per Second"). The few products too close to halfway
+ * between two doubles, subnormal results, and overflows are not decided.
+ * @param w non-zero decimal mantissa
+ * @param q decimal exponent within [-342, 308]
+ * @param v the nearest double if decided; otherwise an estimate within a few ulps
+ * @return true if v is the nearest double
+ */
+inline bool eiselLemire(uint64_t w, int32_t q, double &v) {
+  const uint32_t zeros{countLeadingZeros(w)};
+  w <<= zeros;
+  const uint64_t *power{powerOfTen128(q)};
+  uint64_t high{0};
+  uint64_t low{multiply128(w, power[0], high)};
+  // floor(log2(10^q)) == (217706 * q) >> 16 within the range of q
+  const int32_t log2{(217706 * q) >> 16};
+  v = std::ldexp(static_cast<double>(high), log2 + 1 - static_cast<int32_t>(zeros));
+
+  // The high half of the power suffices unless the bits below the mantissa may carry.
+  if ((0x1FF == (high & 0x1FF)) && (low + w < w)) {
+    uint64_t lowHigh{0};
+    const uint64_t lowLow{multiply128(w, power[1], lowHigh)};
+    low += lowHigh;
+    high += (low < lowHigh) ? 1 : 0;
+    if ((0x1FF == (high & 0x1FF)) && (0 == low + 1) && (lowLow + w < w)) {
+      return false;
+    }
+  }
+  const uint64_t msb{high >> 63};
+  uint64_t mantissa{high >> (msb + 9)};
+  int32_t exponent{log2 + 64 + 1023 - static_cast<int32_t>(zeros) - static_cast<int32_t>(1 ^ msb)};
+  if ((0 == low) && (0 == (high & 0x1FF)) && (1 == (mantissa & 3))) {
+    return false;
+  }
+  mantissa += mantissa & 1;
+  mantissa >>= 1;
+  if (0 < (mantissa >> 53)) {
+    mantissa >>= 1;
+    exponent++;
+  }
+  if ((exponent <= 0) || (0x7FF <= exponent)) {
+    return false;
+  }
+  const uint64_t bits{(static_cast<uint64_t>(exponent) << 52) | (mantissa & ((uint64_t{1} << 52) - 1))};
+  std::memcpy(&v, &bits, sizeof(double));
+  return true;
+}
+
+/**
+ * Unsigned integer with a fixed capacity for the exact comparisons of
+ * parseNumber's slow path: at most 800 significant digits times a power of
+ * five for exponents down to -1142, about 2900 bits.
+ */
+class FixedBigInteger {
+ public:
+  explicit FixedBigInteger(uint64_t v)
+    : m_limbs{}
+    , m_size{0} {
+    for(; 0 != v; v >>= 32) {
+      m_limbs[m_size++] = static_cast<uint32_t>(v);
+    }
+  }
+
+  /**
+   * Sets this to this * factor + summand.
+   */
+  void multiplyAdd(uint32_t factor, uint32_t summand) {
+    uint64_t carry{summand};
+    for(std::size_t i{0}; i < m_size; i++) {
+      const uint64_t product{static_cast<uint64_t>(m_limbs[i]) * factor + carry};
+      m_limbs[i] = static_cast<uint32_t>(product);
+      carry = product >> 32;
+    }
+    if (0 != carry) {
+      m_limbs[m_size++] = static_cast<uint32_t>(carry);
+    }
+  }
+
+  void multiplyPowerOfFive(int32_t n) {
+    static const uint32_t POW5[]{1, 5, 25, 125, 625, 3125, 15625, 78125, 390625, 1953125, 9765625, 48828125, 244140625, 1220703125};
+    for(; 13 <= n; n -= 13) {
+      multiplyAdd(POW5[13], 0);
+    }
+    multiplyAdd(POW5[n], 0);
+  }
+
+  void shiftLeft(int32_t bits) {
+    if (0 == m_size) {
+      return;
+    }
+    const uint32_t rest{static_cast<uint32_t>(bits) % 32};
+    if (0 != rest) {
+      uint32_t carry{0};
+      for(std::size_t i{0}; i < m_size; i++) {
+        const uint32_t next{m_limbs[i] >> (32 - rest)};
+        m_limbs[i] = (m_limbs[i] << rest) | carry;
+        carry = next;
+      }
+      if (0 != carry) {
+        m_limbs[m_size++] = carry;
+      }
+    }
+    const std::size_t limbs{static_cast<std::size_t>(bits) / 32};
+    std::copy_backward(m_limbs.begin(), m_limbs.begin() + m_size, m_limbs.begin() + m_size + limbs);
+    std::fill(m_limbs.begin(), m_limbs.begin() + limbs, 0);
+    m_size += limbs;
+  }
+
+  /**
+   * @return -1, 0 or 1 if this is less than, equal to or greater than other
+   */
+  int compare(const FixedBigInteger &other) const {
+    if (m_size != other.m_size) {
+      return (m_size < other.m_size) ? -1 : 1;
+    }
+    for(std::size_t i{m_size}; 0 < i; i--) {
+      if (m_limbs[i - 1] != other.m_limbs[i - 1]) {
+        return (m_limbs[i - 1] < other.m_limbs[i - 1]) ? -1 : 1;
+      }
+    }
+    return 0;
+  }
+
+ private:
+  std::array<uint32_t, 128> m_limbs;
+  std::size_t m_size;
+};
+
+/**
+ * @param digits significant decimal digits
+ * @param q decimal exponent of the last digit
+ * @param sticky true if non-zero digits follow the significant ones
+ * @return -1, 0 or 1 if digits * 10^q is less than, equal to or greater than h * 2^e
+ */
+inline int compareDecimal(const FixedBigInteger &digits, int32_t q, bool sticky, uint64_t h, int32_t e) {
+  // digits * 5^q * 2^q against h * 2^e, with the power of five on the side where it is an integer
+  FixedBigInteger left{digits};
+  FixedBigInteger right{h};
+  if (0 <= q) {
+    left.multiplyPowerOfFive(q);
+  }
+  else {
+    right.multiplyPowerOfFive(-q);
+  }
+  if (q < e) {
+    right.shiftLeft(e - q);
+  }
+  else {
+    left.shiftLeft(q - e);
+  }
+  const int order{left.compare(right)};
+  return (0 == order && sticky) ? 1 : order;
+}
+
+/**
+ * Rounds a decimal number exactly, without allocation or locale, by
+ * comparing it with the halfway points next to an estimate and stepping one
+ * double at a time (Clinger's AlgorithmR); for the rare numbers that
+ * eiselLemire cannot decide.
+ * @param first first digit of the number, possibly followed by a decimal point and more digits
+ * @param last end of its digits
+ * @param q decimal exponent of the last digit
+ * @param estimate positive and within a few ulps of the number
+ * @return the nearest double
+ */
+inline double roundDecimal(const char *first, const char *last, int32_t q, double estimate) {
+  static const uint32_t POW10[]{1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+  // 800 digits are more than a halfway point between two doubles can have; the others only break ties.
+  FixedBigInteger digits{0};
+  uint32_t chunk{0};
+  int32_t chunkDigits{0};
+  int32_t kept{0};
+  bool sticky{false};
+  for(const char *d{first}; d < last; d++) {
+    if ('.' == *d || (0 == kept && '0' == *d)) {
+      continue;
+    }
+    if (800 <= kept) {
+      sticky = sticky || ('0' != *d);
+      q++;
+      continue;
+    }
+    chunk = chunk * 10 + static_cast<uint32_t>(*d - '0');
+    kept++;
+    if (9 == ++chunkDigits) {
+      digits.multiplyAdd(POW10[9], chunk);
+      chunk = 0;
+      chunkDigits = 0;
+    }
+  }
+  digits.multiplyAdd(POW10[chunkDigits], chunk);
+
+  const double MAX{(std::numeric_limits<double>::max)()};
+  double x{(std::min)(estimate, MAX)};
+  for(;;) {
+    // x == m * 2^e with the exponent of its ulp
+    int k{0};
+    std::frexp(x, &k);
+    const int32_t e{(0 < x) ? (std::max)(k - 53, -1074) : -1074};
+    const uint64_t m{static_cast<uint64_t>(std::ldexp(x, -e))};
+    const int above{compareDecimal(digits, q, sticky, 2 * m + 1, e - 1)};
+    if ((0 < above) || (0 == above && 1 == (m & 1))) {
+      if (!(x < MAX)) {
+        return std::numeric_limits<double>::infinity();
+      }
+      x = std::nextafter(x, MAX);
+      continue;
+    }
+    if (0 == m) {
+      return x;
+    }
+    // Below a power of two the previous double is half an ulp away.
+    const bool narrower{((uint64_t{1} << 52) == m) && (-1074 < e)};
+    const int below{narrower ? compareDecimal(digits, q, sticky, 4 * m - 1, e - 2) : compareDecimal(digits, q, sticky, 2 * m - 1, e - 1)};
+    if ((below < 0) || (0 == below && 1 == (m & 1))) {
+      x = std::nextafter(x, 0.0);
+      continue;
+    }
+    return x;
+  }
+}
+
+/**
+ * Parses a JSON number without allocation and independent of the locale.
+ * Numbers with at most 19 digits, a mantissa below 2^53, and a decimal
+ * exponent within +-22 are converted exactly by a single multiplication or
+ * division with an exact power of ten (Clinger's fast path); all others by
+ * eiselLemire from their first 19 significant digits. The few numbers that
+ * this cannot decide are rounded exactly by roundDecimal.
+ * @param s first character; advanced past the number
+ * @param end end of the text
+ * @param v parsed number
+ * @return false if no number starts at s
+ */
+inline bool parseNumber(const char *&s, const char *end, double &v) {
+  static const double POW10[]{1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                              1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  const char *p{s};
+  const bool negative{(p < end) && ('-' == *p)};
+  p += negative ? 1 : 0;
+  const char *first{p};
+  uint64_t mantissa{0};
+  // Wraps around for more than 19 digits, which are parsed again below.
+  auto digits = [&p, end, &mantissa]() {
+    const char *begin{p};
+    // Eight digits at a time (SWAR), see Lemire, "Fast number parsing".
+    while ((8 <= end - p) && isEightDigits(load8(p))) {
+      mantissa = mantissa * 100000000 + eightDigits(load8(p));
+      p += 8;
+    }
+    for(; p < end && static_cast<unsigned>(*p - '0') < 10; p++) {
+      mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+    }
+    return static_cast<int32_t>(p - begin);
+  };
+  const int32_t integer{digits()};
+  int32_t fraction{0};
+  if (p < end && '.' == *p) {
+    p++;
+    fraction = digits();
+  }
+  if (0 == integer + fraction) {
+    return false;
+  }
+  const char *last{p};
+  int32_t exponent{-fraction};
+  if (p < end && ('e' == *p || 'E' == *p)) {
+    const char *q{p + 1};
+    const bool negativeExponent{(q < end) && ('-' == *q)};
+    q += (q < end && ('-' == *q || '+' == *q)) ? 1 : 0;
+    int32_t e{0};
+    bool anyExponent{false};
+    for(; q < end && static_cast<unsigned>(*q - '0') < 10; q++, anyExponent = true) {
+      e = (e < 100000) ? e * 10 + (*q - '0') : e;
+    }
+    if (anyExponent) {
+      exponent += negativeExponent ? -e : e;
+      p = q;
+    }
+  }
+  s = p;
+  const int32_t lastExponent{exponent};
+
+  // Leading zeros do not count; beyond 19 significant digits only the first 19 are kept.
+  int32_t significant{integer + fraction};
+  const char *d{first};
+  if (19 < significant) {
+    for(; d < last && ('0' == *d || '.' == *d); d++) {
+      significant -= ('0' == *d) ? 1 : 0;
+    }
+  }
+  const bool truncated{19 < significant};
+  if (truncated) {
+    mantissa = 0;
+    for(int32_t kept{0}; kept < 19; d++) {
+      if ('.' != *d) {
+        mantissa = mantissa * 10 + static_cast<uint64_t>(*d - '0');
+        kept++;
+      }
+    }
+    exponent += significant - 19;
+  }
+
+  if (0 == mantissa) {
+    v = 0;
+  }
+  else if ( !truncated && (mantissa <= (uint64_t{1} << 53)) && (-22 <= exponent) && (exponent <= 22) ) {
+    const double m{static_cast<double>(mantissa)};
+    v = (exponent < 0) ? m / POW10[-exponent] : m * POW10[exponent];
+  }
+  else if (exponent < -342) {
+    v = 0;
+  }
+  else if (308 < exponent) {
+    v = std::numeric_limits<double>::infinity();
+  }
+  else {
+    bool exact{eiselLemire(mantissa, exponent, v)};
+    // The dropped digits lie between the first 19 and the next larger mantissa.
+    double above{0};
+    exact = exact && (!truncated || (eiselLemire(mantissa + 1, exponent, above) && (0 == std::memcmp(&v, &above, sizeof(double)))));
+    if (!exact) {
+      v = roundDecimal(first, last, lastExponent, v);
+    }
+  }
+  v = negative ? -v : v;
+  return true;
+}
+
+/**
+ * Single-pass reader for the subset of JSON used by GeoJSON that reports
+ * every object with a "type" of Polygon or MultiPolygon and its
+ * "coordinates", in document order. Coordinates are parsed straight into a
+ * RingArena; no document tree and no strings are built. "properties" and
+ * "bbox" members, and the coordinates of other geometry types, are skipped by
+ * a bracket-matching scan that does not validate their contents.
+ */
+template <typename T>
+class GeoJsonReader {
+  // Nesting of arrays and objects outside of coordinates; GeoJSON documents rarely exceed five.
+  static constexpr int MAX_DEPTH{64};
+
+ public:
+  GeoJsonReader(const char *data, std::size_t size)
+    : m_begin{data}
+    , m_position{data}
+    , m_end{data + size} {
+  }
+
+  /**
+   * @param arena receives the polygons
+   * @param visit called with the arena after every Polygon or MultiPolygon; may consume and clear it
+   */
+  template <typename Visitor>
+  void read(RingArena<T> &arena, Visitor &visit) {
+    value(arena, visit, 1);
+    if ('\0' != peek()) {
+      fail("trailing characters");
+    }
+  }
+
+ private:
+  [[noreturn]] void fail(const char *what) const {
+    throw std::runtime_error(std::string("geofence::readGeoJson: ") + what + " at offset " + std::to_string(m_position - m_begin));
+  }
+
+  char peek() {
+    while (m_position < m_end && (' ' == *m_position || '\n' == *m_position || '\r' == *m_position || '\t' == *m_position)) {
+      m_position++;
+    }
+    return (m_position < m_end) ? *m_position : '\0';
+  }
+
+  void expect(char c) {
+    if (c != peek()) {
+      fail("unexpected character");
+    }
+    m_position++;
+  }
+
+  bool comma() {
+    if (',' != peek()) {
+      return false;
+    }
+    m_position++;
+    return true;
+  }
+
+  /**
+   * Reads a string without unescaping it.
+   * @return first character and length of the raw contents
+   */
+  std::pair<const char*, std::size_t> string() {
+    expect('"');
+    const char *begin{m_position};
+    for(;;) {
+      const char *quote{static_cast<const char*>(std::memchr(m_position, '"', static_cast<std::size_t>(m_end - m_position)))};
+      if (nullptr == quote) {
+        m_position = m_end;
+        fail("unterminated string");
+      }
+      m_position = quote + 1;
+      std::size_t backslashes{0};
+      for(const char *b{quote}; begin < b && '\\' == *(b - 1); b--) {
+        backslashes++;
+      }
+      if (0 == backslashes % 2) {
+        return std::make_pair(begin, static_cast<std::size_t>(quote - begin));
+      }
+    }
+  }
+
+  static bool equals(const std::pair<const char*, std::size_t> &s, const char *word) {
+    return (std::strlen(word) == s.second) && (0 == std::memcmp(s.first, word, s.second));
+  }
+
+  double number() {
+    double v{0};
+    if (!parseNumber(m_position, m_end, v)) {
+      fail("invalid number");
+    }
+    return v;
+  }
+
+  void literal(const char *word) {
+    const std::size_t LENGTH{std::strlen(word)};
+    if ((static_cast<std::size_t>(m_end - m_position) < LENGTH) || (0 != std::memcmp(m_position, word, LENGTH))) {
+      fail("invalid literal");
+    }
+    m_position += LENGTH;
+  }
+
+  /**
+   * Skips any value by matching brackets.
+   */
+  void skip() {
+    const char c{peek()};
+    if ('"' == c) {
+      string();
+      return;
+    }
+    if ('{' != c && '[' != c) {
+      scalar();
+      return;
+    }
+    std::size_t depth{0};
+    do {
+      const char d{*m_position};
+      if ('"' == d) {
+        string();
+        continue;
+      }
+      depth += ('{' == d || '[' == d) ? 1 : 0;
+      depth -= ('}' == d || ']' == d) ? 1 : 0;
+      m_position++;
+    } while (0 < depth && m_position < m_end);
+    if (0 < depth) {
+      fail("unterminated value");
+    }
+  }
+
+  void scalar() {
+    const char c{peek()};
+    if ('t' == c) {
+      literal("true");
+    }
+    else if ('f' == c) {
+      literal("false");
+    }
+    else if ('n' == c) {
+      literal("null");
+    }
+    else {
+      number();
+    }
+  }
+
+  /**
+   * @param depth number of enclosing arrays and objects including this value; deeper than MAX_DEPTH fails
+   */
+  template <typename Visitor>
+  void value(RingArena<T> &arena, Visitor &visit, int depth) {
+    if (MAX_DEPTH < depth) {
+      fail("values nested too deeply");
+    }
+    const char c{peek()};
+    if ('{' == c) {
+      object(arena, visit, depth);
+    }
+    else if ('[' == c) {
+      expect('[');
+      if (']' == peek()) {
+        m_position++;
+        return;
+      }
+      do {
+        value(arena, visit, depth + 1);
+      } while (comma());
+      expect(']');
+    }
+    else if ('"' == c) {
+      string();
+    }
+    else {
+      scalar();
+    }
+  }
+
+  template <typename Visitor>
+  void object(RingArena<T> &arena, Visitor &visit, int depth) {
+    enum { UNKNOWN, POLYGON, MULTIPOLYGON, OTHER } type{UNKNOWN};
+    int coordinates{-1};
+    std::size_t vertices{arena.m_vertices.size()};
+    std::size_t rings{arena.m_ringEnds.size()};
+    std::size_t polygons{arena.m_polygonEnds.size()};
+    expect('{');
+    if ('}' != peek()) {
+      do {
+        const std::pair<const char*, std::size_t> key{string()};
+        expect(':');
+        if (equals(key, "type") && ('"' == peek())) {
+          const std::pair<const char*, std::size_t> name{string()};
+          type = equals(name, "Polygon") ? POLYGON : (equals(name, "MultiPolygon") ? MULTIPOLYGON : OTHER);
+        }
+        else if (equals(key, "coordinates") && (OTHER != type) && ('[' == peek())) {
+          vertices = arena.m_vertices.size();
+          rings = arena.m_ringEnds.size();
+          polygons = arena.m_polygonEnds.size();
+          coordinates = nested(arena, 1);
+        }
+        else if (equals(key, "coordinates") || equals(key, "properties") || equals(key, "bbox")) {
+          skip();
+        }
+        else {
+          value(arena, visit, depth + 1);
+        }
+      } while (comma());
+    }
+    expect('}');
+    if (coordinates < 0) {
+      return;
+    }
+
+    // A Polygon has three levels of nesting, a MultiPolygon four; an empty one none.
+    if ( ((POLYGON == type) && (3 == coordinates || 0 == coordinates)) ||
+         ((MULTIPOLYGON == type) && (4 == coordinates || 0 == coordinates)) ) {
+      visit(arena);
+      return;
+    }
+    arena.m_vertices.resize((std::min)(vertices, arena.m_vertices.size()));
+    arena.m_ringEnds.resize((std::min)(rings, arena.m_ringEnds.size()));
+    arena.m_polygonEnds.resize((std::min)(polygons, arena.m_polygonEnds.size()));
+  }
+
+  /**
+   * Parses nested coordinate arrays into the arena.
+   * @param depth number of enclosing coordinate arrays including this one; deeper than a multipolygon fails
+   * @return nesting level: 0 for an empty array, 1 for a position, 2 for a ring, 3 for a polygon, 4 for a multipolygon
+   */
+  int nested(RingArena<T> &arena, int depth) {
+    if (4 < depth) {
+      fail("coordinates nested too deeply");
+    }
+    expect('[');
+    if (']' == peek()) {
+      m_position++;
+      return 0;
+    }
+    int level{1};
+    std::array<double,2> position{{0, 0}};
+    std::size_t numbers{0};
+    do {
+      if ('[' == peek()) {
+        level = (std::max)(level, nested(arena, depth + 1) + 1);
+      }
+      else {
+        const double v{number()};
+        if (numbers < 2) {
+          position[numbers] = v;
+        }
+        numbers++;
+      }
+    } while (comma());
+    expect(']');
+    if (1 == level) {
+      if (numbers < 2) {
+        fail("position with less than two numbers");
+      }
+      arena.m_vertices.push_back(std::array<T,2>{{static_cast<T>(position[0]), static_cast<T>(position[1])}});
+    }
+    else if (2 == level) {
+      arena.m_ringEnds.push_back(arena.m_vertices.size());
+    }
+    else if (3 == level) {
+      arena.m_polygonEnds.push_back(arena.m_ringEnds.size());
+    }
+    return level;
+  }
+
+ private:
+  const char *m_begin;
+  const char *m_position;
+  const char *m_end;
+};
+
+template <typename T>
+constexpr int GeoJsonReader<T>::MAX_DEPTH;
+
+}
+
+/**
+ * Streams all Polygon and MultiPolygon geometries of a GeoJSON document,
+ * e.g., a FeatureCollection or a memory-mapped file, into an arena in
+ * document order. Coordinates beyond x and y are ignored.
+ * @param data GeoJSON document; need not be terminated
+ * @param size number of bytes
+ * @param arena receives the polygons; rings are not normalized
+ * @param visit called with the arena after every geometry; clearing the arena there bounds memory for large documents
+ * @throws std::runtime_error if the document is malformed or nested more than 64 levels deep
+ */
+template <typename T, typename Visitor>
+inline void readGeoJson(const char *data, std::size_t size, RingArena<T> &arena, Visitor &&visit) {
+  detail::GeoJsonReader<T>(data, size).read(arena, visit);
+}
+
+/**
+ * Reads all Polygon and MultiPolygon geometries of a GeoJSON document into an arena.
+ * @param data GeoJSON document; need not be terminated
+ * @param size number of bytes
+ * @param arena receives the polygons; rings are not normalized
+ * @throws std::runtime_error if the document is malformed
+ */
+template <typename T>
+inline void readGeoJson(const char *data, std::size_t size, RingArena<T> &arena) {
+  readGeoJson(data, size, arena, [](RingArena<T> &) {});
+}
+
+/**
+ * Reads all Polygon and MultiPolygon geometries of a GeoJSON document, e.g.,
+ * a FeatureCollection, in document order. Coordinates beyond x and y are
+ * ignored.
+ * @param text GeoJSON document
+ * @return polygons; rings are not normalized
+ * @throws std::runtime_error if the document is malformed
+ */
+inline std::vector<Polygon> readGeoJson(const std::string &text) {
+  RingArena<double> arena;
+  readGeoJson(text.data(), text.size(), arena);
+  std::vector<Polygon> polygons(arena.polygons());
+  for(std::size_t k{0}; k < arena.polygons(); k++) {
+    for(std::size_t r{arena.firstRing(k)}; r < arena.firstRing(k + 1); r++) {
+      if (r == arena.firstRing(k)) {
+        polygons[k].outer = arena.copy(r);
+      }
+      else {
+        polygons[k].holes.push_back(arena.copy(r));
+      }
+    }
+  }
+  return polygons;
+}
+
+/**
+ * Reads POLYGON and MULTIPOLYGON geometries in Well-Known Text; several
+ * geometries may follow each other, separated by whitespace. Z and M
+ * coordinates are ignored.
+ * @param text WKT
+ * @return polygons in input order; rings are not normalized
+ * @throws std::runtime_error if the text is malformed or contains other geometry types
+ */
+inline std::vector<Polygon> readWkt(const std::string &text) {
+  std::size_t position{0};
+  auto fail = [&position](const char *what) {
+    throw std::runtime_error(std::string("geofence::readWkt: ") + what + " at offset " + std::to_string(position));
+  };
+  auto peek = [&text, &position]() {
+    while (position < text.size() && std::isspace(static_cast<unsigned char>(text[position]))) {
+      position++;
+    }
+    return (position < text.size()) ? text[position] : '\0';
+  };
+  auto word = [&text, &position, &peek]() {
+    peek();
+    std::string w;
+    while (position < text.size() && std::isalpha(static_cast<unsigned char>(text[position]))) {
+      w += static_cast<char>(std::toupper(static_cast<unsigned char>(text[position++])));
+    }
+    return w;
+  };
+  auto expect = [&position, &peek, &fail](char c) {
+    if (c != peek()) {
+      fail("unexpected character");
+    }
+    position++;
+  };
+  auto comma = [&position, &peek]() {
+    if (',' != peek()) {
+      return false;
+    }
+    position++;
+    return true;
+  };
+  auto ring = [&text, &position, &peek, &expect, &comma, &fail]() {
+    std::vector<std::array<double,2>> vertices;
+    expect('(');
+    do {
+      std::array<double,2> v{{0, 0}};
+      std::size_t numbers{0};
+      while (')' != peek() && ',' != peek()) {
+        const char *begin{text.c_str() + position};
+        char *end{nullptr};
+        const double value{std::strtod(begin, &end)};
+        if (end == begin) {
+          fail("invalid number");
+        }
+        position += static_cast<std::size_t>(end - begin);
+        if (numbers < 2) {
+          v[numbers] = value;
+        }
+        numbers++;
+      }
+      if (numbers < 2) {
+        fail("position with less than two numbers");
+      }
+      vertices.push_back(v);
+    } while (comma());
+    expect(')');
+    return vertices;
+  };
+  auto polygon = [&expect, &comma, &ring]() {
+    Polygon p;
+    expect('(');
+    do {
+      auto vertices = ring();
+      if (p.outer.empty()) {
+        p.outer.swap(vertices);
+      }
+      else {
+        p.holes.push_back(vertices);
+      }
+    } while (comma());
+    expect(')');
+    return p;
+  };
+
+  std::vector<Polygon> polygons;
+  while ('\0' != peek()) {
+    const std::string type{word()};
+    std::string dimension{word()};
+    if ("Z" == dimension || "M" == dimension || "ZM" == dimension) {
+      dimension = word();
+    }
+    if ("EMPTY" == dimension) {
+      continue;
+    }
+    if (!dimension.empty()) {
+      fail("unexpected keyword");
+    }
+    if ("POLYGON" == type) {
+      polygons.push_back(polygon());
+    }
+    else if ("MULTIPOLYGON" == type) {
+      expect('(');
+      do {
+        polygons.push_back(polygon());
+      } while (comma());
+      expect(')');
+    }
+    else {
+      fail("unsupported geometry type");
+    }
+    if (';' == peek()) {
+      position++;
+    }
+  }
+  return polygons;
+}
+
+namespace detail {
+
+template <bool LITTLE>
+inline double loadDouble(const uint8_t *p) {
+  const uint64_t bits{loadOrdered<uint64_t, LITTLE>(p)};
+  double v;
+  std::memcpy(&v, &bits, sizeof(v));
+  return v;
+}
+
+}
+
+/**
+ * Read-only view of a ring inside a WKB buffer. Vertices are decoded on
+ * access from their stored byte order, and Z and M coordinates are skipped,
+ * so no vertex is copied; the buffer must outlive the view.
+ */
+class WkbRing {
+ public:
+  /**
+   * @param points first byte of the ring's first point
+   * @param size number of points
+   * @param dimensions number of doubles per point (2 to 4)
+   * @param little true if the points are stored in little-endian order
+   */
+  WkbRing(const uint8_t *points, std::size_t size, std::size_t dimensions, bool little)
+    : m_points{points}
+    , m_size{size}
+    , m_stride{dimensions * sizeof(double)}
+    , m_little{little} {
+  }
+
+  std::size_t size() const {
+    return m_size;
+  }
+
+  std::array<double,2> operator[](std::size_t i) const {
+    return m_little ? at<true>(i) : at<false>(i);
+  }
+
+  /**
+   * @param i index of a vertex
+   * @return the vertex, decoded from little-endian order if LITTLE; for loops that branch on little() once
+   */
+  template <bool LITTLE>
+  std::array<double,2> at(std::size_t i) const {
+    const uint8_t *point{m_points + i * m_stride};
+    return std::array<double,2>{{detail::loadDouble<LITTLE>(point), detail::loadDouble<LITTLE>(point + sizeof(double))}};
+  }
+
+  bool little() const {
+    return m_little;
+  }
+
+  /**
+   * @return copy of the vertices, e.g., for normalize or FenceStore::build
+   */
+  std::vector<std::array<double,2>> copy() const {
+    std::vector<std::array<double,2>> vertices(m_size);
+    for(std::size_t i{0}; i < m_size; i++) {
+      vertices[i] = (*this)[i];
+    }
+    return vertices;
+  }
+
+ private:
+  const uint8_t *m_points;
+  std::size_t m_size;
+  std::size_t m_stride;
+  bool m_little;
+};
+
+/**
+ * Read-only view of a WKB polygon: the outer ring followed by its holes.
+ */
+struct WkbPolygon {
+  WkbPolygon()
+    : rings{} {
+  }
+
+  std::vector<WkbRing> rings;
+};
+
+/**
+ * Reads Polygon and MultiPolygon geometries in Well-Known Binary as views
+ * over the buffer. Both byte orders, ISO Z/M/ZM types (1003, 2006, ...), and
+ * PostGIS extended WKB with Z/M flags and an SRID are accepted; several
+ * geometries may follow each other.
+ * @param data WKB; must outlive the returned views
+ * @param size number of bytes
+ * @return polygons in input order; rings are not normalized
+ * @throws std::runtime_error if the buffer is truncated or contains other geometry types
+ */
+inline std::vector<WkbPolygon> readWkb(const void *data, std::size_t size) {
+  constexpr const uint32_t POLYGON{3};
+  constexpr const uint32_t MULTIPOLYGON{6};
+  const uint8_t *begin{static_cast<const uint8_t*>(data)};
+  std::size_t position{0};
+  auto fail = [&position](const char *what) {
+    throw std::runtime_error(std::string("geofence::readWkb: ") + what + " at offset " + std::to_string(position));
+  };
+  auto need = [&position, size, &fail](std::size_t count, std::size_t bytes) {
+    if ((size - position) / bytes < count) {
+      fail("truncated");
+    }
+  };
+  // Reads a geometry header and returns its base type, setting byte order and dimensions.
+  auto header = [begin, &position, &need, &fail](bool &little, std::size_t &dimensions) {
+    need(1, 5);
+    if (1 < begin[position]) {
+      fail("invalid byte order");
+    }
+    little = (1 == begin[position]);
+    uint32_t type{detail::loadOrdered<uint32_t>(begin + position + 1, little)};
+    position += 5;
+    dimensions = 2 + ((0 != (type & 0x80000000u)) ? 1 : 0) + ((0 != (type & 0x40000000u)) ? 1 : 0);
+    if (0 != (type & 0x20000000u)) {
+      need(1, 4);
+      position += 4;  // SRID
+    }
+    type &= 0x0FFFFFFFu;
+    dimensions += (type / 1000 == 3) ? 2 : ((0 < type / 1000) ? 1 : 0);
+    if ((3 < type / 1000) || (4 < dimensions)) {
+      fail("invalid geometry type");
+    }
+    return type % 1000;
+  };
+  auto polygon = [begin, &position, &need](bool little, std::size_t dimensions) {
+    WkbPolygon p;
+    need(1, 4);
+    const uint32_t rings{detail::loadOrdered<uint32_t>(begin + position, little)};
+    position += 4;
+    need(rings, 4);
+    for(uint32_t r{0}; r < rings; r++) {
+      need(1, 4);
+      const uint32_t points{detail::loadOrdered<uint32_t>(begin + position, little)};
+      position += 4;
+      need(points, dimensions * sizeof(double));
+      p.rings.push_back(WkbRing(begin + position, points, dimensions, little));
+      position += points * dimensions * sizeof(double);
+    }
+    return p;
+  };
+
+  std::vector<WkbPolygon> polygons;
+  while (position < size) {
+    bool little{true};
+    std::size_t dimensions{2};
+    const uint32_t type{header(little, dimensions)};
+    if (POLYGON == type) {
+      polygons.push_back(polygon(little, dimensions));
+    }
+    else if (MULTIPOLYGON == type) {
+      need(1, 4);
+      const uint32_t count{detail::loadOrdered<uint32_t>(begin + position, little)};
+      position += 4;
+      need(count, 9);
+      for(uint32_t k{0}; k < count; k++) {
+        if (POLYGON != header(little, dimensions)) {
+          fail("MultiPolygon with other geometry");
+        }
+        polygons.push_back(polygon(little, dimensions));
+      }
+    }
+    else {
+      fail("unsupported geometry type");
+    }
+  }
+  return polygons;
+}
+
+/**
+ * Writes a polygon as a little-endian WKB Polygon.
+ * @param polygon to write
+ * @param wkb bytes are appended
+ */
+inline void writeWkb(const Polygon &polygon, std::vector<uint8_t> &wkb) {
+  auto put = [&wkb](uint64_t value, std::size_t bytes) {
+    for(std::size_t i{0}; i < bytes; i++) {
+      wkb.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+  };
+  auto ring = [&put](const std::vector<std::array<double,2>> &vertices) {
+    put(vertices.size(), 4);
+    for(const auto &v : vertices) {
+      for(double c : v) {
+        uint64_t bits;
+        std::memcpy(&bits, &c, sizeof(bits));
+        put(bits, 8);
+      }
+    }
+  };
+  wkb.push_back(1);
+  put(3, 4);
+  put(polygon.outer.empty() ? 0 : 1 + polygon.holes.size(), 4);
+  if (!polygon.outer.empty()) {
+    ring(polygon.outer);
+    for(const auto &hole : polygon.holes) {
+      ring(hole);
+    }
+  }
+}
+
+/**
+ * Writes polygons as one little-endian WKB MultiPolygon.
+ * @param polygons to write
+ * @return WKB
+ */
+inline std::vector<uint8_t> writeWkb(const std::vector<Polygon> &polygons) {
+  std::vector<uint8_t> wkb{1, 6, 0, 0, 0};
+  for(std::size_t i{0}; i < 4; i++) {
+    wkb.push_back(static_cast<uint8_t>(polygons.size() >> (8 * i)));
+  }
+  for(const auto &polygon : polygons) {
+    writeWkb(polygon, wkb);
+  }
+  return wkb;
+}
+
+namespace detail {
+
+/**
+ * As walkRing, for a ring stored in WKB with the byte order given by LITTLE.
+ */
+template <typename FillRule, bool LITTLE>
+inline bool walkWkbRing(const WkbRing &ring, const std::array<double,2> &p, int32_t &counter) {
+  constexpr const uint8_t X{0};
+  constexpr const uint8_t Y{1};
+  std::array<double,2> j{ring.at<LITTLE>(ring.size() - 1)};
+  for(std::size_t k{0}; k < ring.size(); k++) {
+    const std::array<double,2> i{ring.at<LITTLE>(k)};
+    if ( isEqual(p[X], i[X]) && isEqual(p[Y], i[Y]) ) {
+      return true;
+    }
+    if ((i[Y] > p[Y]) != (j[Y] > p[Y])) {
+      FillRule::cross(counter, i, j, p);
+    }
+    j = i;
+  }
+  return false;
+}
+
+}
+
+/**
+ * @param polygon view of a WKB polygon; for oriented fill rules, holes must be oriented opposite to the outer ring
+ * @param p point to test whether inside or not
+ * @return true if p is inside the polygon according to FillRule OR when p is any vertex
+ */
+template <typename FillRule = EvenOddRule>
+inline bool isIn(const WkbPolygon &polygon, const std::array<double,2> &p) {
+  int32_t counter{0};
+  for(const auto &ring : polygon.rings) {
+    if ( (2 < ring.size()) && (ring.little() ? detail::walkWkbRing<FillRule, true>(ring, p, counter) : detail::walkWkbRing<FillRule, false>(ring, p, counter)) ) {
+      return true;
+    }
+  }
+  return FillRule::isInside(counter);
+}
+
+/**
+ * Polygon stored in a few bits per vertex: vertices are snapped to a grid
+ * spanning the polygon's bounding box, and the differences between
+ * consecutive grid vertices are zigzag-encoded and bit-packed in blocks of
+ * BLOCK vertices with one bit width per block and axis. Every block keeps its
+ * first vertex and the y-range of its edges, so a query skips blocks that do
+ * not straddle the point and unpacks the others into registers; the unpacking
+ * has no data-dependent branches. Queries are exact for the snapped polygon,
+ * which differs from the original by at most half a grid cell.
+ */
+template <typename T, typename FillRule = EvenOddRule>
+class CompressedPolygon {
+  static_assert(std::is_arithmetic<T>::value, "T must be an arithmetic type");
+
+  struct Block {
+    uint32_t first[2];   // first vertex on the grid
+    uint32_t minY;       // y-range of the block's edges, including the one to the next block
+    uint32_t maxY;
+    uint64_t offset;     // first bit of the packed differences
+    uint8_t width[2];    // bits per difference and axis
+  };
+
+ public:
+  static constexpr std::size_t BLOCK{64};
+
+ public:
+  /**
+   * @param polygon describing a geofenced area
+   * @param bits grid resolution; the longer side of the bounding box is divided into 2^bits - 1 cells (1 to 30)
+   */
+  explicit CompressedPolygon(const std::vector<std::array<T,2>> &polygon, uint32_t bits = 24)
+    : m_min{{0, 0}}
+    , m_scale{1}
+    , m_size{polygon.size()}
+    , m_blocks{}
+    , m_words{} {
+    constexpr const uint8_t X{0};
+    constexpr const uint8_t Y{1};
+    if (polygon.empty()) {
+      return;
+    }
+    const BoundingBox<T> box{BoundingBox<T>::of(polygon)};
+    m_min = {{static_cast<double>(box.min[X]), static_cast<double>(box.min[Y])}};
+    const double extent{(std::max)(static_cast<double>(box.max[X]) - m_min[X], static_cast<double>(box.max[Y]) - m_min[Y])};
+    const double cells{static_cast<double>((uint32_t{1} << (std::min)((std::max)(bits, 1u), 30u)) - 1)};
+    m_scale = (0 < extent) ? cells / extent : 1.0;
+
+    std::vector<std::array<uint32_t,2>> grid(polygon.size());
+    for(std::size_t i{0}; i < polygon.size(); i++) {
+      for(uint8_t a{X}; a <= Y; a++) {
+        grid[i][a] = static_cast<uint32_t>(std::llround((static_cast<double>(polygon[i][a]) - m_min[a]) * m_scale));
+      }
+    }
+
+    uint64_t bit{0};
+    std::vector<std::array<uint64_t,2>> zigzag;
+    for(std::size_t begin{0}; begin < grid.size(); begin += BLOCK) {
+      const std::size_t end{(std::min)(grid.size(), begin + BLOCK)};
+      Block block{{grid[begin][X], grid[begin][Y]}, grid[begin][Y], grid[begin][Y], bit, {0, 0}};
+      zigzag.clear();
+      for(std::size_t i{begin + 1}; i < end; i++) {
+        std::array<uint64_t,2> z;
+        for(uint8_t a{X}; a <= Y; a++) {
+          const int64_t d{static_cast<int64_t>(grid[i][a]) - static_cast<int64_t>(grid[i - 1][a])};
+          z[a] = (static_cast<uint64_t>(d) << 1) ^ static_cast<uint64_t>(d >> 63);
+          while ((uint64_t{1} << block.width[a]) <= z[a]) {
+            block.width[a]++;
+          }
+        }
+        zigzag.push_back(z);
+      }
+      for(std::size_t i{begin}; i <= end; i++) {
+        const uint32_t y{grid[i % grid.size()][Y]};
+        block.minY = (std::min)(block.minY, y);
+        block.maxY = (std::max)(block.maxY, y);
+      }
+      for(uint8_t a{X}; a <= Y; a++) {
+        for(const auto &z : zigzag) {
+          write(bit, block.width[a], z[a]);
+          bit += block.width[a];
+        }
+      }
+      m_blocks.push_back(block);
+    }
+    // A trailing word lets read() always load two words.
+    m_words.resize(bit / 64 + 2, 0);
+  }
+
+  /**
+   * @param p point to test whether inside or not
+   * @return true if p is inside the snapped polygon according to FillRule OR when p is any of its vertices
+   */
+  bool isIn(const std::array<T,2> &p) const {
+    constexpr const uint8_t X{0};
+    constexpr const uint8_t Y{1};
+    int32_t counter{0};
+    if (m_size < 3) {
+      return false;
+    }
+    const std::array<double,2> q{{(static_cast<double>(p[X]) - m_min[X]) * m_scale, (static_cast<double>(p[Y]) - m_min[Y]) * m_scale}};
+    std::array<double,2> vertices[BLOCK + 1];
+    for(std::size_t b{0}; b < m_blocks.size(); b++) {
+      const Block &block = m_blocks[b];
+      // One cell of slack keeps vertex hits within isEqual's tolerance.
+      if ( (q[Y] + 1 < static_cast<double>(block.minY)) || (static_cast<double>(block.maxY) + 1 < q[Y]) ) {
+        continue;
+      }
+      const std::size_t count{decode(b, vertices)};
+      for(std::size_t i{1}; i <= count; i++) {
+        if ( isEqual(q[X], vertices[i - 1][X]) && isEqual(q[Y], vertices[i - 1][Y]) ) {
+          return true;
+        }
+        if ((vertices[i][Y] > q[Y]) != (vertices[i - 1][Y] > q[Y])) {
+          FillRule::cross(counter, vertices[i], vertices[i - 1], q);
+        }
+      }
+    }
+    return FillRule::isInside(counter);
+  }
+
+  /**
+   * @return the snapped vertices in the original coordinate system
+   */
+  std::vector<std::array<T,2>> decode() const {
+    std::vector<std::array<T,2>> polygon;
+    std::array<double,2> vertices[BLOCK + 1];
+    for(std::size_t b{0}; b < m_blocks.size(); b++) {
+      const std::size_t count{decode(b, vertices)};
+      for(std::size_t i{0}; i < count; i++) {
+        polygon.push_back(std::array<T,2>{{static_cast<T>(vertices[i][0] / m_scale + m_min[0]), static_cast<T>(vertices[i][1] / m_scale + m_min[1])}});
+      }
+    }
+    return polygon;
+  }
+
+  /**
+   * @return number of vertices
+   */
+  std::size_t size() const {
+    return m_size;
+  }
+
+  /**
+   * @return bytes used by the blocks and the packed differences
+   */
+  std::size_t bytes() const {
+    return m_blocks.size() * sizeof(Block) + m_words.size() * sizeof(uint64_t);
+  }
+
+  /**
+   * @return edge length of a grid cell in polygon coordinates
+   */
+  double resolution() const {
+    return 1.0 / m_scale;
+  }
+
+ private:
+  void write(uint64_t bit, uint32_t width, uint64_t value) {
+    if (0 == width) {
+      return;
+    }
+    m_words.resize((bit + width) / 64 + 2, 0);
+    m_words[bit / 64] |= value << (bit % 64);
+    if (64 < bit % 64 + width) {
+      m_words[bit / 64 + 1] |= value >> (64 - bit % 64);
+    }
+  }
+
+  uint64_t read(uint64_t bit, uint32_t width) const {
+    const uint64_t *word{m_words.data() + bit / 64};
+    const uint32_t shift{static_cast<uint32_t>(bit % 64)};
+    // The second word contributes nothing when shift is 0; shifting twice avoids a shift by 64.
+    const uint64_t v{(word[0] >> shift) | ((word[1] << 1) << (63 - shift))};
+    return v & ((uint64_t{1} << width) - 1);
+  }
+
+  /**
+   * Unpacks a block's vertices on the grid followed by the first vertex of the next block.
+   * @return number of vertices in the block
+   */
+  std::size_t decode(std::size_t b, std::array<double,2> *vertices) const {
+    const Block &block = m_blocks[b];
+    const std::size_t count{(std::min)(BLOCK, m_size - b * BLOCK)};
+    uint64_t bit{block.offset};
+    for(uint8_t a{0}; a < 2; a++) {
+      int64_t v{block.first[a]};
+      vertices[0][a] = static_cast<double>(v);
+      for(std::size_t i{1}; i < count; i++, bit += block.width[a]) {
+        const uint64_t z{read(bit, block.width[a])};
+        v += static_cast<int64_t>(z >> 1) ^ -static_cast<int64_t>(z & 1);
+        vertices[i][a] = static_cast<double>(v);
+      }
+      vertices[count][a] = static_cast<double>(m_blocks[(b + 1) % m_blocks.size()].first[a]);
+    }
+    return count;
+  }
+
+ private:
+  std::array<double,2> m_min;
+  double m_scale;           // grid cells per unit
+  std::size_t m_size;
+  std::vector<Block> m_blocks;
+  std::vector<uint64_t> m_words;
+};
+
+template <typename T, typename FillRule>
+constexpr std::size_t CompressedPolygon<T, FillRule>::BLOCK;
+
+namespace detail {
+
+inline uint32_t popcount(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<uint32_t>(__builtin_popcountll(v));
+#else
+  v = v - ((v >> 1) & 0x5555555555555555ull);
+  v = (v & 0x3333333333333333ull) + ((v >> 2) & 0x3333333333333333ull);
+  v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+  return static_cast<uint32_t>((v * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+}
+
+/**
+ * Raster of a polygon's bounding box with 2 bits per pixel: outside, inside,
+ * boundary, or refined. Pixels without edges resolve with a single load from
+ * the bit array. Boundary pixels keep the indices of the edges touching them
+ * and an anchor with known inside/outside state, so that only those edges are
+ * tested; boundary pixels with too many edges are refined into TILE x TILE
+ * sub-rasters of the same layout, forming a pyramid that only grows along the
+ * boundary. Pixels are grouped in blocks of 256 with the number of boundary
+ * and refined pixels before each block, so that a pixel's edges are found by
+ * counting the non-simple pixels before it in its block.
+ */
+template <typename T, typename FillRule = EvenOddRule>
+class RasterIndex {
+  static_assert(std::is_arithmetic<T>::value, "T must be an arithmetic type");
+
+  struct Entry {
+    uint32_t first;            // index into edge indices, or the refined pixel's tile
+    uint32_t count;            // number of edges; ALL if the whole ring must be walked
+    std::array<double,2> anchor;
+    int32_t counter;           // FillRule's counter at the anchor
+  };
+
+  struct Pending {
+    uint32_t entry;
+    std::array<double,2> min;
+    std::vector<uint32_t> edges;
+  };
+
+ public:
+  static constexpr uint32_t TILE{16};
+  static constexpr uint32_t MAX_BITS{15};
+  static constexpr uint32_t MAX_DEPTH{3};
+
+  enum : uint32_t { OUTSIDE = 0, INSIDE = 1, BOUNDARY = 2, REFINED = 3 };
+
+ public:
+  /**
+   * @param polygon describing a geofenced area
+   * @param bits the longer side of the bounding box is divided into 2^bits pixels (at most MAX_BITS)
+   * @param depth number of times boundary pixels may be refined (at most MAX_DEPTH)
+   * @param maxEdgesPerPixel boundary pixels with more edges are refined until depth
+   */
+  explicit RasterIndex(const std::vector<std::array<T,2>> &polygon, uint32_t bits = 10, uint32_t depth = 1, uint32_t maxEdgesPerPixel = 8)
+    : m_vertices{}
+    , m_origin{{0, 0}}
+    , m_pixel{1}
+    , m_width{0}
+    , m_height{0}
+    , m_words{}
+    , m_bases{}
+    , m_entries{}
+    , m_edgeIndices{} {
+    constexpr const uint8_t X{0};
+    constexpr const uint8_t Y{1};
+    if (3 > polygon.size()) {
+      return;
+    }
+    for(const auto &v : polygon) {
+      m_vertices.push_back(std::array<double,2>{{static_cast<double>(v[X]), static_cast<double>(v[Y])}});
+    }
+    const auto box = BoundingBox<double>::of(m_vertices);
+    m_origin = box.min;
+    const double extent{(std::max)(box.max[X] - box.min[X], box.max[Y] - box.min[Y])};
+    m_pixel = (0 < extent) ? extent / static_cast<double>(1u << (std::min)(bits, MAX_BITS)) : 1;
+    m_width = static_cast<uint32_t>((box.max[X] - box.min[X]) / m_pixel) + 1;
+    m_height = static_cast<uint32_t>((box.max[Y] - box.min[Y]) / m_pixel) + 1;
+    depth = (std::min)(depth, MAX_DEPTH);
+
+    const std::size_t n{m_vertices.size()};
+    const std::size_t blocks{(static_cast<std::size_t>(m_width) * m_height + PIXELS - 1) / PIXELS};
+    m_words.assign(blocks * WORDS, 0);
+    m_bases.assign(blocks, 0);
+
+    // Edges touching each boundary pixel, and edges straddling each row's center line.
+    std::unordered_map<uint32_t, std::vector<uint32_t>> pixelEdges;
+    std::vector<std::vector<uint32_t>> rowEdges(m_height);
+    const double eps{m_pixel * 1e-9};
+    for(uint32_t k{0}; k < n; k++) {
+      const std::array<double,2> &u = m_vertices[k];
+      const std::array<double,2> &v = m_vertices[(k + 1) % n];
+      const double minY{(std::min)(u[Y], v[Y])};
+      const double maxY{(std::max)(u[Y], v[Y])};
+      const uint32_t first{row(minY - eps)};
+      const uint32_t last{row(maxY + eps)};
+      for(uint32_t r{first}; r <= last; r++) {
+        const double centerY{m_origin[Y] + (r + 0.5) * m_pixel};
+        if ((u[Y] > centerY) != (v[Y] > centerY)) {
+          rowEdges[r].push_back(k);
+        }
+        std::array<double,2> a{u};
+        std::array<double,2> b{v};
+        const std::array<double,2> min{{(std::min)(u[X], v[X]) - 1, m_origin[Y] + r * m_pixel - eps}};
+        const std::array<double,2> max{{(std::max)(u[X], v[X]) + 1, m_origin[Y] + (r + 1) * m_pixel + eps}};
+        if (detail::clip(a, b, min, max)) {
+          const uint32_t to{column((std::max)(a[X], b[X]) + eps)};
+          for(uint32_t c{column((std::min)(a[X], b[X]) - eps)}; c <= to; c++) {
+            pixelEdges[r * m_width + c].push_back(k);
+          }
+        }
+      }
+    }
+
+    // Sweeps every row's center line from right to left, accounting for each
+    // crossing once, to classify pixels without edges and to find anchors.
+    std::vector<std::pair<double, uint32_t>> crossings;
+    std::vector<Entry> rowEntries;
+    std::vector<Pending> rowRefined;
+    std::vector<Pending> pending;
+    for(uint32_t r{0}; r < m_height; r++) {
+      const double centerY{m_origin[Y] + (r + 0.5) * m_pixel};
+      crossings.clear();
+      for(uint32_t k : rowEdges[r]) {
+        const std::array<double,2> &i = m_vertices[(k + 1) % n];
+        const std::array<double,2> &j = m_vertices[k];
+        crossings.push_back(std::make_pair((j[X] - i[X]) * (centerY - i[Y]) / (j[Y] - i[Y]) + i[X], k));
+      }
+      std::sort(crossings.begin(), crossings.end(), std::greater<std::pair<double, uint32_t>>());
+      std::vector<uint32_t>().swap(rowEdges[r]);
+
+      int32_t counter{0};
+      std::size_t next{0};
+      auto advance = [&](const std::array<double,2> &p) {
+        for(; (next < crossings.size()) && (p[X] < crossings[next].first); next++) {
+          const uint32_t k{crossings[next].second};
+          FillRule::cross(counter, m_vertices[(k + 1) % n], m_vertices[k], p);
+        }
+      };
+      rowEntries.clear();
+      rowRefined.clear();
+      for(uint32_t c{m_width}; 0 < c--; ) {
+        const uint32_t index{r * m_width + c};
+        const double left{m_origin[X] + c * m_pixel};
+        const auto it = pixelEdges.find(index);
+        if (it == pixelEdges.end()) {
+          advance(std::array<double,2>{{left + m_pixel / 2, centerY}});
+          set(index / PIXELS, index % PIXELS, FillRule::isInside(counter) ? INSIDE : OUTSIDE);
+          continue;
+        }
+        // Anchor in the middle of the widest gap between the crossings inside the pixel.
+        double previous{left + m_pixel};
+        double anchorX{left + m_pixel / 2};
+        double widest{-1};
+        for(std::size_t s{next}; s <= crossings.size(); s++) {
+          const double x{(s < crossings.size()) ? (std::max)(left, crossings[s].first) : left};
+          if (x < previous) {
+            if (widest < previous - x) {
+              widest = previous - x;
+              anchorX = (previous + x) / 2;
+            }
+            previous = x;
+          }
+          if (!(left < x)) {
+            break;
+          }
+        }
+        const std::array<double,2> anchor{{anchorX, centerY}};
+        advance(anchor);
+        const std::vector<uint32_t> &edges = it->second;
+        Entry entry{static_cast<uint32_t>(m_edgeIndices.size()), static_cast<uint32_t>(edges.size()), anchor, counter};
+        uint32_t state{BOUNDARY};
+        if (!clear(anchor, edges)) {
+          entry.first = 0;
+          entry.count = ALL;
+        }
+        else if ((0 < depth) && (maxEdgesPerPixel < edges.size())) {
+          state = REFINED;
+          rowRefined.push_back(Pending{static_cast<uint32_t>(rowEntries.size()), {{left, m_origin[Y] + r * m_pixel}}, edges});
+        }
+        else {
+          m_edgeIndices.insert(m_edgeIndices.end(), edges.begin(), edges.end());
+        }
+        rowEntries.push_back(entry);
+        set(index / PIXELS, index % PIXELS, state);
+      }
+      // Entries follow the pixel order.
+      const uint32_t base{static_cast<uint32_t>(m_entries.size())};
+      m_entries.insert(m_entries.end(), rowEntries.rbegin(), rowEntries.rend());
+      for(auto &refined : rowRefined) {
+        refined.entry = static_cast<uint32_t>(base + rowEntries.size() - 1 - refined.entry);
+        pending.push_back(refined);
+      }
+    }
+    std::unordered_map<uint32_t, std::vector<uint32_t>>().swap(pixelEdges);
+
+    uint32_t count{0};
+    for(std::size_t b{0}; b < blocks; b++) {
+      m_bases[b] = count;
+      for(std::size_t w{0}; w < WORDS; w++) {
+        count += detail::popcount(m_words[b * WORDS + w] & HIGH);
+      }
+    }
+    for(const auto &p : pending) {
+      refine(p.entry, p.min, m_pixel, p.edges, 1, depth, maxEdgesPerPixel);
+    }
+  }
+
+  /**
+   * @param p point to test whether inside or not
+   * @return true if p is inside the polygon according to FillRule OR when p is any vertex
+   */
+  bool isIn(const std::array<T,2> &p) const {
+    constexpr const uint8_t X{0};
+    constexpr const uint8_t Y{1};
+    const std::array<double,2> q{{static_cast<double>(p[X]), static_cast<double>(p[Y])}};
+    double fx{(q[X] - m_origin[X]) / m_pixel};
+    double fy{(q[Y] - m_origin[Y]) / m_pixel};
+    if (m_words.empty() || fx < 0 || !(fx < m_width) || fy < 0 || !(fy < m_height)) {
+      return false;
+    }
+    uint32_t x{static_cast<uint32_t>(fx)};
+    uint32_t y{static_cast<uint32_t>(fy)};
+    uint32_t block{(y * m_width + x) / PIXELS};
+    uint32_t offset{(y * m_width + x) % PIXELS};
+    uint32_t state{this->state(block, offset)};
+    while (REFINED == state) {
+      const Entry &entry = m_entries[this->entry(block, offset)];
+      fx = (fx - x) * TILE;
+      fy = (fy - y) * TILE;
+      x = (std::min)(TILE - 1, static_cast<uint32_t>(fx));
+      y = (std::min)(TILE - 1, static_cast<uint32_t>(fy));
+      block = entry.first;
+      offset = y * TILE + x;
+      state = this->state(block, offset);
+    }
+    if (BOUNDARY != state) {
+      return INSIDE == state;
+    }
+    const Entry &entry = m_entries[this->entry(block, offset)];
+    int32_t counter{entry.counter};
+    if (ALL == entry.count) {
+      counter = 0;
+      return detail::walkRing<FillRule>(m_vertices.data(), m_vertices.size(), q, counter) || FillRule::isInside(counter);
+    }
+    if (detail::walkLocalEdges<FillRule>(m_vertices.data(), m_vertices.size(), m_edgeIndices.data() + entry.first, entry.count, entry.anchor, q, counter)) {
+      return true;
+    }
+    return FillRule::isInside(counter);
+  }
+
+  /**
+   * @param p point
+   * @return true if p is answered by a single load, i.e., its top-level pixel is inside or outside
+   */
+  bool isResolved(const std::array<T,2> &p) const {
+    constexpr const uint8_t X{0};
+    constexpr const uint8_t Y{1};
+    const double fx{(static_cast<double>(p[X]) - m_origin[X]) / m_pixel};
+    const double fy{(static_cast<double>(p[Y]) - m_origin[Y]) / m_pixel};
+    if (m_words.empty() || fx < 0 || !(fx < m_width) || fy < 0 || !(fy < m_height)) {
+      return true;
+    }
+    const uint32_t index{static_cast<uint32_t>(fy) * m_width + static_cast<uint32_t>(fx)};
+    return state(index / PIXELS, index % PIXELS) < BOUNDARY;
+  }
+
+  /**
+   * @return edge length of a top-level pixel in polygon coordinates
+   */
+  double resolution() const {
+    return m_pixel;
+  }
+
+  /**
+   * @return number of refined sub-rasters
+   */
+  std::size_t tiles() const {
+    return m_bases.size() - (static_cast<std::size_t>(m_width) * m_height + PIXELS - 1) / PIXELS;
+  }
+
+  /**
+   * @return bytes used by the rasters, the boundary pixels, and their edge indices
+   */
+  std::size_t bytes() const {
+    return m_words.size() * sizeof(uint64_t) + m_bases.size() * sizeof(uint32_t) +
+           m_entries.size() * sizeof(Entry) + m_edgeIndices.size() * sizeof(uint32_t);
+  }
+
+ private:
+  static constexpr uint32_t PIXELS{256};                     // per block
+  static constexpr uint32_t WORDS{PIXELS / 32};              // 64-bit words per block
+  static constexpr uint32_t ALL{0xFFFFFFFFu};
+  static constexpr uint64_t HIGH{0xAAAAAAAAAAAAAAAAull};     // high bit of every pixel: boundary or refined
+
+  uint32_t row(double y) const {
+    return (std::min)(m_height - 1, static_cast<uint32_t>((std::max)(0.0, (y - m_origin[1]) / m_pixel)));
+  }
+
+  uint32_t column(double x) const {
+    return (std::min)(m_width - 1, static_cast<uint32_t>((std::max)(0.0, (x - m_origin[0]) / m_pixel)));
+  }
+
+  uint32_t state(uint32_t block, uint32_t offset) const {
+    return static_cast<uint32_t>(m_words[block * WORDS + offset / 32] >> (2 * (offset % 32))) & 3;
+  }
+
+  void set(uint32_t block, uint32_t offset, uint32_t state) {
+    m_words[block * WORDS + offset / 32] |= static_cast<uint64_t>(state) << (2 * (offset % 32));
+  }
+
+  // Index of the entry of a boundary or refined pixel.
+  uint32_t entry(uint32_t block, uint32_t offset) const {
+    const uint64_t *words{m_words.data() + block * WORDS};
+    uint32_t rank{m_bases[block]};
+    for(uint32_t w{0}; w < offset / 32; w++) {
+      rank += detail::popcount(words[w] & HIGH);
+    }
+    return rank + detail::popcount(words[offset / 32] & HIGH & ((uint64_t{1} << (2 * (offset % 32))) - 1));
+  }
+
+  // True if the anchor is on none of the edges.
+  bool clear(const std::array<double,2> &anchor, const std::vector<uint32_t> &edges) const {
+    for(uint32_t k : edges) {
+      if (!(0 < detail::squaredDistance(anchor, m_vertices[k], m_vertices[(k + 1) % m_vertices.size()]))) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void refine(uint32_t e, const std::array<double,2> &min, double size, const std::vector<uint32_t> &edges, uint32_t level, uint32_t depth, uint32_t maxEdgesPerPixel) {
+    constexpr const uint8_t X{0};
+    constexpr const uint8_t Y{1};
+    const std::size_t n{m_vertices.size()};
+    const uint32_t tile{static_cast<uint32_t>(m_bases.size())};
+    const std::array<double,2> parent{m_entries[e].anchor};
+    const int32_t parentCounter{m_entries[e].counter};
+    m_entries[e].first = tile;
+    m_words.resize(m_words.size() + WORDS, 0);
+    m_bases.push_back(static_cast<uint32_t>(m_entries.size()));
+
+    const double sub{size / TILE};
+    std::vector<Pending> pending;
+    for(uint32_t offset{0}; offset < PIXELS; offset++) {
+      const std::array<double,2> subMin{{min[X] + (offset % TILE) * sub, min[Y] + (offset / TILE) * sub}};
+      const std::array<double,2> subMax{{subMin[X] + sub, subMin[Y] + sub}};
+      std::vector<uint32_t> subEdges;
+      for(uint32_t k : edges) {
+        if (detail::intersects(m_vertices[k], m_vertices[(k + 1) % n], subMin, subMax)) {
+          subEdges.push_back(k);
+        }
+      }
+      if (subEdges.empty()) {
+        int32_t counter{parentCounter};
+        detail::walkLocalEdges<FillRule>(m_vertices.data(), n, edges.data(), edges.size(), parent, std::array<double,2>{{subMin[X] + sub / 2, subMin[Y] + sub / 2}}, counter);
+        set(tile, offset, FillRule::isInside(counter) ? INSIDE : OUTSIDE);
+        continue;
+      }
+      // Anchor is the candidate farthest from all edges of this pixel.
+      std::array<double,2> anchor{subMin};
+      double best{-1};
+      for(int i{1}; i < 4; i++) {
+        for(int j{1}; j < 4; j++) {
+          const std::array<double,2> c{{subMin[X] + i * sub / 4, subMin[Y] + j * sub / 4}};
+          double nearest{(std::numeric_limits<double>::max)()};
+          for(uint32_t k : subEdges) {
+            nearest = (std::min)(nearest, detail::squaredDistance(c, m_vertices[k], m_vertices[(k + 1) % n]));
+          }
+          if (best < nearest) {
+            best = nearest;
+            anchor = c;
+          }
+        }
+      }
+      int32_t counter{parentCounter};
+      detail::walkLocalEdges<FillRule>(m_vertices.data(), n, edges.data(), edges.size(), parent, anchor, counter);
+      Entry entry{static_cast<uint32_t>(m_edgeIndices.size()), static_cast<uint32_t>(subEdges.size()), anchor, counter};
+      uint32_t state{BOUNDARY};
+      if (!(0 < best)) {
+        entry.first = 0;
+        entry.count = ALL;
+      }
+      else if ((level < depth) && (maxEdgesPerPixel < subEdges.size())) {
+        state = REFINED;
+        pending.push_back(Pending{static_cast<uint32_t>(m_entries.size()), subMin, subEdges});
+      }
+      else {
+        m_edgeIndices.insert(m_edgeIndices.end(), subEdges.begin(), subEdges.end());
+      }
+      m_entries.push_back(entry);
+      set(tile, offset, state);
+    }
+    for(const auto &p : pending) {
+      refine(p.entry, p.min, sub, p.edges, level + 1, depth, maxEdgesPerPixel);
+    }
+  }
+
+ private:
+  std::vector<std::array<double,2>> m_vertices;
+  std::array<double,2> m_origin;
+  double m_pixel;                      // edge length of a top-level pixel
+  uint32_t m_width;
+  uint32_t m_height;
+  std::vector<uint64_t> m_words;       // 2 bits per pixel; top-level blocks in row-major order, then one block per tile
+  std::vector<uint32_t> m_bases;       // entries before each block
+  std::vector<Entry> m_entries;
+  std::vector<uint32_t> m_edgeIndices;
+};
+
+template <typename T, typename FillRule>
+constexpr uint32_t RasterIndex<T, FillRule>::TILE;
+template <typename T, typename FillRule>
+constexpr uint32_t RasterIndex<T, FillRule>::MAX_BITS;
+template <typename T, typename FillRule>
+constexpr uint32_t RasterIndex<T, FillRule>::MAX_DEPTH;
+template <typename T, typename FillRule>
+constexpr uint32_t RasterIndex<T, FillRule>::PIXELS;
+template <typename T, typename FillRule>
+constexpr uint32_t RasterIndex<T, FillRule>::WORDS;
+template <typename T, typename FillRule>
+constexpr uint32_t RasterIndex<T, FillRule>::ALL;
+template <typename T, typename FillRule>
+constexpr uint64_t RasterIndex<T, FillRule>::HIGH;
 
 }
 #endif
@@ -24,9 +24,22 @@
 
 #include "catch.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <thread>
 
 #include "geofence.hpp"
+#include "geofence-mapped-file.hpp"
 
 TEST_CASE("equality checks") {
   CHECK(geofence::isEqual<uint16_t>(15, 15));
@@ -351,3 +364,1596 @@ TEST_CASE("multiple tests with convex hull") {
     CHECK(geofence::isIn<uint8_t>(convexHull, point));
   }
 } 
+
+///////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("monotone chain index agrees with isIn") {
+  std::vector<std::array<uint8_t,2>> polygon;
+  polygon.push_back(std::array<uint8_t,2>{1, 3});
+  polygon.push_back(std::array<uint8_t,2>{6, 14});
+  polygon.push_back(std::array<uint8_t,2>{9, 1});
+  polygon.push_back(std::array<uint8_t,2>{17, 3});
+  polygon.push_back(std::array<uint8_t,2>{12, 10});
+  polygon.push_back(std::array<uint8_t,2>{5, 7});
+  polygon.push_back(std::array<uint8_t,2>{12, 5});
+
+  geofence::MonotoneChainIndex<uint8_t> index(polygon);
+  CHECK(4 <= index.chains().size());
+  for(uint8_t x{0}; x < 20; x++) {
+    for(uint8_t y{0}; y < 20; y++) {
+      std::array<uint8_t,2> point{x, y};
+      CHECK(geofence::isIn<uint8_t>(polygon, point) == index.isIn(point));
+    }
+  }
+}
+
+TEST_CASE("monotone chain index on long coastline-like polygon") {
+  // Wavy ring with long runs of edges that are monotone in y.
+  std::vector<std::array<double,2>> polygon;
+  const double PI{3.14159265358979323846};
+  for(int i{0}; i < 720; i++) {
+    const double phi{2.0 * PI * i / 720.0};
+    const double r{10.0 + 2.0 * std::sin(7.0 * phi) + 0.5 * std::cos(31.0 * phi)};
+    polygon.push_back(std::array<double,2>{r * std::cos(phi), r * std::sin(phi)});
+  }
+  polygon.push_back(std::array<double,2>{0.0, 0.0});
+
+  geofence::MonotoneChainIndex<double> index(polygon);
+  CHECK(index.chains().size() < polygon.size() / 4);
+  for(int x{-140}; x <= 140; x += 3) {
+    for(int y{-140}; y <= 140; y += 3) {
+      std::array<double,2> point{x / 10.0 + 0.013, y / 10.0 - 0.007};
+      CHECK(geofence::isIn<double>(polygon, point) == index.isIn(point));
+    }
+  }
+  for(auto v : polygon) {
+    CHECK(index.isIn(v));
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("empty bounding boxes contain nothing and do not grow others") {
+  const auto empty = geofence::BoundingBox<int>::empty();
+  CHECK(empty.isEmpty());
+  CHECK(!empty.contains(std::array<int,2>{{0, 0}}));
+  CHECK(geofence::BoundingBox<int>::of(std::vector<std::array<int,2>>{}).isEmpty());
+
+  auto box = empty;
+  box.extend(std::array<int,2>{{10, 20}});
+  CHECK(!box.isEmpty());
+  CHECK(10 == box.min[0]);
+  CHECK(20 == box.max[1]);
+  box.extend(empty);
+  CHECK(10 == box.min[0]);
+  CHECK(20 == box.min[1]);
+  CHECK(10 == box.max[0]);
+  CHECK(20 == box.max[1]);
+
+  // A fence without vertices must not stretch the nodes of a tree over the origin.
+  geofence::detail::PackedBoxTree<int> tree;
+  tree.build(std::vector<geofence::BoundingBox<int>>{empty, box});
+  const auto &root = tree.levels().back().front();
+  CHECK(10 == root.min[0]);
+  CHECK(20 == root.min[1]);
+  CHECK(!root.contains(std::array<int,2>{{0, 0}}));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("ear clipping triangulates square and concave polygon") {
+  std::vector<std::array<int,2>> square;
+  square.push_back(std::array<int,2>{0, 0});
+  square.push_back(std::array<int,2>{10, 0});
+  square.push_back(std::array<int,2>{10, 10});
+  square.push_back(std::array<int,2>{0, 10});
+  CHECK(2 == geofence::triangulate(square).size());
+  // Collinear and repeated vertices add no degenerate triangles.
+  square.insert(square.begin() + 1, std::array<int,2>{5, 0});
+  square.insert(square.begin() + 1, std::array<int,2>{0, 0});
+  int squareArea{0};
+  for(auto t : geofence::triangulate(square)) {
+    auto a = square[t[0]];
+    auto b = square[t[1]];
+    auto c = square[t[2]];
+    const int twice{(b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0])};
+    CHECK(0 < twice);
+    squareArea += twice;
+  }
+  CHECK(200 == squareArea);
+
+  // Clockwise, U-shaped polygon.
+  std::vector<std::array<int,2>> polygon;
+  polygon.push_back(std::array<int,2>{0, 10});
+  polygon.push_back(std::array<int,2>{4, 10});
+  polygon.push_back(std::array<int,2>{4, 4});
+  polygon.push_back(std::array<int,2>{6, 4});
+  polygon.push_back(std::array<int,2>{6, 10});
+  polygon.push_back(std::array<int,2>{10, 10});
+  polygon.push_back(std::array<int,2>{10, 0});
+  polygon.push_back(std::array<int,2>{0, 0});
+  auto triangles = geofence::triangulate(polygon);
+  CHECK(6 == triangles.size());
+
+  int area{0};
+  for(std::size_t i{0}, j{polygon.size() - 1}; i < polygon.size(); j = i++) {
+    area += polygon[j][0] * polygon[i][1] - polygon[i][0] * polygon[j][1];
+  }
+  int sum{0};
+  for(auto t : triangles) {
+    auto a = polygon[t[0]];
+    auto b = polygon[t[1]];
+    auto c = polygon[t[2]];
+    const int twice{(b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0])};
+    CHECK(0 < twice);
+    sum += twice;
+  }
+  CHECK(std::abs(area) == sum);
+}
+
+TEST_CASE("triangle index agrees with isIn away from the boundary") {
+  std::vector<std::array<double,2>> polygon;
+  const double PI{3.14159265358979323846};
+  for(int i{0}; i < 500; i++) {
+    const double phi{2.0 * PI * i / 500.0};
+    const double r{10.0 + 2.0 * std::sin(7.0 * phi) + 0.5 * std::cos(31.0 * phi)};
+    polygon.push_back(std::array<double,2>{r * std::cos(phi), r * std::sin(phi)});
+  }
+
+  geofence::TriangleIndex<double> index(polygon);
+  CHECK(498 == index.size());
+  for(int x{-140}; x <= 140; x += 3) {
+    for(int y{-140}; y <= 140; y += 3) {
+      std::array<double,2> point{x / 10.0 + 0.013, y / 10.0 - 0.007};
+      CHECK(geofence::isIn<double>(polygon, point) == index.isIn(point));
+    }
+  }
+  for(auto v : polygon) {
+    CHECK(index.isIn(v));
+  }
+}
+
+TEST_CASE("triangle index falls back to isIn for rings that are not simple") {
+  std::vector<std::array<double,2>> bowtie;
+  bowtie.push_back(std::array<double,2>{0.0, 0.0});
+  bowtie.push_back(std::array<double,2>{100.0, 100.0});
+  bowtie.push_back(std::array<double,2>{100.0, 0.0});
+  bowtie.push_back(std::array<double,2>{0.0, 100.0});
+
+  // No ear is left after clipping the outer corners.
+  std::vector<std::array<double,2>> twisted;
+  twisted.push_back(std::array<double,2>{0.0, 0.0});
+  twisted.push_back(std::array<double,2>{100.0, 0.0});
+  twisted.push_back(std::array<double,2>{100.0, 100.0});
+  twisted.push_back(std::array<double,2>{60.0, 100.0});
+  twisted.push_back(std::array<double,2>{60.0, -10.0});
+  twisted.push_back(std::array<double,2>{40.0, -10.0});
+  twisted.push_back(std::array<double,2>{40.0, 100.0});
+  twisted.push_back(std::array<double,2>{0.0, 100.0});
+
+  std::vector<std::array<double,2>> star;
+  const double PI{3.14159265358979323846};
+  for(int i{0}; i < 5; i++) {
+    const double phi{PI / 2 + 4.0 * PI * i / 5.0};
+    star.push_back(std::array<double,2>{50.0 + 50.0 * std::cos(phi), 50.0 + 50.0 * std::sin(phi)});
+  }
+
+  for(const auto &ring : {bowtie, twisted, star}) {
+    CHECK(geofence::triangulate(ring).empty());
+    geofence::TriangleIndex<double> index(ring);
+    CHECK(0 == index.size());
+    auto reference = ring;
+    for(int x{-20}; x <= 120; x += 3) {
+      for(int y{-20}; y <= 120; y += 3) {
+        std::array<double,2> point{x + 0.013, y - 0.007};
+        CHECK(geofence::isIn<double>(reference, point) == index.isIn(point));
+      }
+    }
+    for(auto v : ring) {
+      CHECK(index.isIn(v));
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("multipolygon with holes") {
+  std::vector<std::array<int,2>> airport;
+  airport.push_back(std::array<int,2>{0, 0});
+  airport.push_back(std::array<int,2>{100, 0});
+  airport.push_back(std::array<int,2>{100, 50});
+  airport.push_back(std::array<int,2>{0, 50});
+
+  std::vector<std::array<int,2>> terminal;
+  terminal.push_back(std::array<int,2>{40, 10});
+  terminal.push_back(std::array<int,2>{60, 10});
+  terminal.push_back(std::array<int,2>{60, 20});
+  terminal.push_back(std::array<int,2>{40, 20});
+
+  std::vector<std::array<int,2>> parking;
+  parking.push_back(std::array<int,2>{200, 0});
+  parking.push_back(std::array<int,2>{220, 0});
+  parking.push_back(std::array<int,2>{210, 30});
+
+  geofence::MultiPolygon<int> fence;
+  fence.add(airport, std::vector<std::vector<std::array<int,2>>>{terminal});
+  fence.add(parking);
+  CHECK(2 == fence.size());
+  CHECK(3 == fence.rings().size());
+
+  CHECK(fence.isIn(std::array<int,2>{10, 10}));
+  CHECK(!fence.isIn(std::array<int,2>{50, 15}));
+  CHECK(fence.isIn(std::array<int,2>{40, 10}));
+  CHECK(fence.isIn(std::array<int,2>{70, 15}));
+  CHECK(fence.isIn(std::array<int,2>{210, 10}));
+  CHECK(!fence.isIn(std::array<int,2>{150, 10}));
+  CHECK(!fence.isIn(std::array<int,2>{210, 40}));
+
+  // Grid avoids the boundary of the hole where the vertex rule of isIn applies.
+  for(int x{-4}; x < 230; x += 3) {
+    for(int y{-3}; y < 60; y += 3) {
+      std::array<int,2> p{x, y};
+      const bool expected{(geofence::isIn<int>(airport, p) && !geofence::isIn<int>(terminal, p)) || geofence::isIn<int>(parking, p)};
+      CHECK(expected == fence.isIn(p));
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("nonzero fill rule covers self-intersecting pentagram") {
+  std::vector<std::array<double,2>> pentagram;
+  const double PI{3.14159265358979323846};
+  for(int i{0}; i < 5; i++) {
+    const double phi{PI / 2.0 + 4.0 * PI * i / 5.0};
+    pentagram.push_back(std::array<double,2>{10.0 * std::cos(phi), 10.0 * std::sin(phi)});
+  }
+
+  std::array<double,2> center{0.1, 0.2};
+  CHECK(!geofence::isIn<double>(pentagram, center));
+  CHECK(geofence::isIn<double, geofence::NonZeroRule>(pentagram, center));
+  CHECK(geofence::isIn<double, geofence::EvenOddRule>(pentagram, pentagram[2]));
+
+  std::array<double,2> tip{0.0, 8.0};
+  CHECK(geofence::isIn<double>(pentagram, tip));
+  CHECK(geofence::isIn<double, geofence::NonZeroRule>(pentagram, tip));
+
+  std::array<double,2> outside{8.0, 8.0};
+  CHECK(!geofence::isIn<double, geofence::NonZeroRule>(pentagram, outside));
+
+  geofence::MonotoneChainIndex<double, geofence::NonZeroRule> index(pentagram);
+  for(int x{-120}; x <= 120; x += 3) {
+    for(int y{-120}; y <= 120; y += 3) {
+      std::array<double,2> point{x / 10.0 + 0.013, y / 10.0 - 0.007};
+      CHECK(geofence::isIn<double, geofence::NonZeroRule>(pentagram, point) == index.isIn(point));
+    }
+  }
+}
+
+TEST_CASE("nonzero fill rule keeps holes of a multipolygon regardless of ring orientation") {
+  // Both rings are counter-clockwise.
+  std::vector<std::array<int,2>> outer;
+  outer.push_back(std::array<int,2>{0, 0});
+  outer.push_back(std::array<int,2>{100, 0});
+  outer.push_back(std::array<int,2>{100, 50});
+  outer.push_back(std::array<int,2>{0, 50});
+  std::vector<std::array<int,2>> hole;
+  hole.push_back(std::array<int,2>{40, 10});
+  hole.push_back(std::array<int,2>{60, 10});
+  hole.push_back(std::array<int,2>{60, 20});
+  hole.push_back(std::array<int,2>{40, 20});
+
+  geofence::MultiPolygon<int, geofence::NonZeroRule> fence;
+  fence.add(outer, std::vector<std::vector<std::array<int,2>>>{hole});
+  CHECK(fence.isIn(std::array<int,2>{10, 10}));
+  CHECK(!fence.isIn(std::array<int,2>{50, 15}));
+  CHECK(!fence.isIn(std::array<int,2>{150, 15}));
+
+  // Overlapping second copy of the outer ring does not cancel out.
+  std::vector<std::array<int,2>> twice{outer};
+  twice.insert(twice.end(), outer.begin(), outer.end());
+  std::array<int,2> p{10, 10};
+  CHECK(!geofence::isIn<int>(twice, p));
+  CHECK(geofence::isIn<int, geofence::NonZeroRule>(twice, p));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("fixed-size fences agree with isIn") {
+  const std::array<std::array<int,2>,4> rectangle{{{{0, 0}}, {{10, 0}}, {{10, 5}}, {{0, 5}}}};
+  std::vector<std::array<int,2>> dynamicRectangle(rectangle.begin(), rectangle.end());
+  CHECK(geofence::isValid(rectangle));
+  for(int x{-2}; x < 13; x++) {
+    for(int y{-2}; y < 8; y++) {
+      std::array<int,2> p{x, y};
+      CHECK(geofence::isIn<int>(dynamicRectangle, p) == geofence::isIn<int>(rectangle, p));
+    }
+  }
+
+  std::array<std::array<double,2>,8> octagon{};
+  const double PI{3.14159265358979323846};
+  for(std::size_t i{0}; i < octagon.size(); i++) {
+    octagon[i] = std::array<double,2>{5.0 * std::cos(PI * i / 4.0), 5.0 * std::sin(PI * i / 4.0)};
+  }
+  std::vector<std::array<double,2>> dynamicOctagon(octagon.begin(), octagon.end());
+  CHECK(geofence::isValid(octagon));
+  for(int x{-60}; x <= 60; x += 3) {
+    for(int y{-60}; y <= 60; y += 3) {
+      std::array<double,2> p{x / 10.0, y / 10.0};
+      CHECK(geofence::isIn<double>(dynamicOctagon, p) == geofence::isIn<double>(octagon, p));
+      CHECK(geofence::isIn<double, geofence::NonZeroRule>(dynamicOctagon, p) == geofence::isIn<double, geofence::NonZeroRule>(octagon, p));
+    }
+  }
+
+  const std::array<std::array<int,2>,3> degenerate{{{{0, 0}}, {{5, 5}}, {{10, 10}}}};
+  CHECK(!geofence::isValid(degenerate));
+  const std::array<std::array<int,2>,4> repeated{{{{0, 0}}, {{10, 0}}, {{10, 0}}, {{0, 5}}}};
+  CHECK(!geofence::isValid(repeated));
+}
+
+#if (__cplusplus >= 201402L)
+TEST_CASE("fixed-size fences in constant expressions") {
+  constexpr std::array<std::array<int,2>,3> triangle{{{{0, 0}}, {{10, 0}}, {{10, 10}}}};
+  static_assert(geofence::isValid(triangle), "triangle must be a valid fence");
+  static_assert(geofence::isIn<int>(triangle, std::array<int,2>{{5, 1}}), "point must be inside");
+  static_assert(!geofence::isIn<int>(triangle, std::array<int,2>{{5, 50}}), "point must be outside");
+  static_assert(geofence::isIn<int>(triangle, std::array<int,2>{{10, 10}}), "vertex must be inside");
+  CHECK(geofence::isIn<int>(triangle, std::array<int,2>{{5, 1}}));
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("quadtree cell covering agrees with isIn") {
+  std::vector<std::array<double,2>> polygon;
+  const double PI{3.14159265358979323846};
+  for(int i{0}; i < 720; i++) {
+    const double phi{2.0 * PI * i / 720.0};
+    const double r{10.0 + 2.0 * std::sin(7.0 * phi) + 0.5 * std::cos(31.0 * phi)};
+    polygon.push_back(std::array<double,2>{r * std::cos(phi), r * std::sin(phi)});
+  }
+
+  geofence::CellCovering<double> covering(polygon, 12, 8);
+  CHECK(0 < covering.boundaryCells());
+  CHECK(covering.boundaryCells() < covering.size());
+  for(int x{-140}; x <= 140; x += 3) {
+    for(int y{-140}; y <= 140; y += 3) {
+      std::array<double,2> point{x / 10.0 + 0.013, y / 10.0 - 0.007};
+      CHECK(geofence::isIn<double>(polygon, point) == covering.isIn(point));
+    }
+  }
+  for(auto v : polygon) {
+    CHECK(covering.isIn(v));
+  }
+}
+
+TEST_CASE("quadtree cell covering with integer polygon and nonzero rule") {
+  std::vector<std::array<int,2>> polygon;
+  polygon.push_back(std::array<int,2>{10, 30});
+  polygon.push_back(std::array<int,2>{60, 140});
+  polygon.push_back(std::array<int,2>{90, 10});
+  polygon.push_back(std::array<int,2>{170, 30});
+  polygon.push_back(std::array<int,2>{120, 100});
+  polygon.push_back(std::array<int,2>{50, 70});
+  polygon.push_back(std::array<int,2>{120, 50});
+
+  // Cells are evaluated in double precision whereas isIn<int> truncates the intersection;
+  // the grid of points avoids the boundary.
+  std::vector<std::array<double,2>> reference;
+  for(auto v : polygon) {
+    reference.push_back(std::array<double,2>{static_cast<double>(v[0]), static_cast<double>(v[1])});
+  }
+
+  geofence::CellCovering<int> evenOdd(polygon, 6, 2);
+  geofence::CellCovering<int, geofence::NonZeroRule> nonZero(polygon, 6, 2);
+  for(int x{0}; x < 20; x++) {
+    for(int y{0}; y < 16; y++) {
+      std::array<int,2> p{x * 10 + 3, y * 10 + 4};
+      std::array<double,2> q{static_cast<double>(p[0]), static_cast<double>(p[1])};
+      CHECK(geofence::isIn<double>(reference, q) == evenOdd.isIn(p));
+      CHECK(geofence::isIn<double, geofence::NonZeroRule>(reference, q) == nonZero.isIn(p));
+    }
+  }
+  for(auto v : polygon) {
+    CHECK(evenOdd.isIn(v));
+    CHECK(nonZero.isIn(v));
+  }
+}
+
+TEST_CASE("quadtree cell covering without a usable anchor walks the whole ring") {
+  // Serpentine whose vertical edges pass through all anchor candidates of the
+  // root cell; the root cell is at the finest level and cannot be subdivided.
+  const double size{100 * (1 + 1e-9)};
+  std::vector<std::array<double,2>> polygon;
+  polygon.push_back(std::array<double,2>{0.0, 0.0});
+  polygon.push_back(std::array<double,2>{size / 4, 0.0});
+  polygon.push_back(std::array<double,2>{size / 4, 90.0});
+  polygon.push_back(std::array<double,2>{2 * size / 4, 90.0});
+  polygon.push_back(std::array<double,2>{2 * size / 4, 0.0});
+  polygon.push_back(std::array<double,2>{3 * size / 4, 0.0});
+  polygon.push_back(std::array<double,2>{3 * size / 4, 90.0});
+  polygon.push_back(std::array<double,2>{100.0, 90.0});
+  polygon.push_back(std::array<double,2>{100.0, 100.0});
+  polygon.push_back(std::array<double,2>{0.0, 100.0});
+
+  geofence::CellCovering<double> evenOdd(polygon, 0, 1);
+  geofence::CellCovering<double, geofence::NonZeroRule> nonZero(polygon, 0, 1);
+  CHECK(1 == evenOdd.size());
+  CHECK(0 == evenOdd.quantizedCells());
+  for(int x{1}; x < 100; x += 2) {
+    for(int y{1}; y < 100; y += 2) {
+      std::array<double,2> point{x + 0.013, y - 0.007};
+      CHECK(geofence::isIn<double>(polygon, point) == evenOdd.isIn(point));
+      CHECK(geofence::isIn<double, geofence::NonZeroRule>(polygon, point) == nonZero.isIn(point));
+    }
+  }
+  for(auto v : polygon) {
+    CHECK(evenOdd.isIn(v));
+    CHECK(nonZero.isIn(v));
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("planar arrangement returns all containing fences") {
+  std::vector<std::vector<std::array<double,2>>> fences;
+  const double PI{3.14159265358979323846};
+  for(int f{0}; f < 12; f++) {
+    // Overlapping wavy rings with different centers and radii.
+    std::vector<std::array<double,2>> ring;
+    const double cx{(f % 4) * 4.0};
+    const double cy{(f / 4) * 3.0};
+    for(int i{0}; i < 40; i++) {
+      const double phi{2.0 * PI * i / 40.0};
+      const double r{3.0 + f * 0.2 + 0.5 * std::sin(5.0 * phi + f)};
+      ring.push_back(std::array<double,2>{cx + r * std::cos(phi), cy + r * std::sin(phi)});
+    }
+    fences.push_back(ring);
+  }
+  std::vector<std::array<double,2>> square;
+  square.push_back(std::array<double,2>{0.0, 0.0});
+  square.push_back(std::array<double,2>{8.0, 0.0});
+  square.push_back(std::array<double,2>{8.0, 6.0});
+  square.push_back(std::array<double,2>{0.0, 6.0});
+  fences.push_back(square);
+
+  geofence::ArrangementIndex<double> index(fences);
+  CHECK(0 < index.slabs());
+  CHECK(2 < index.sets());
+  for(int x{-80}; x <= 200; x += 3) {
+    for(int y{-80}; y <= 160; y += 3) {
+      std::array<double,2> p{x / 10.0 + 0.0013, y / 10.0 - 0.0007};
+      std::vector<uint32_t> expected;
+      for(uint32_t f{0}; f < fences.size(); f++) {
+        if (geofence::isIn<double>(fences[f], p)) {
+          expected.push_back(f);
+        }
+      }
+      CHECK(expected == index.query(p));
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("partition index resolves points to a single zone") {
+  // 4x3 tessellation of squares with mixed ring orientation plus a detached triangle.
+  std::vector<std::vector<std::array<double,2>>> zones;
+  for(int y{0}; y < 3; y++) {
+    for(int x{0}; x < 4; x++) {
+      std::vector<std::array<double,2>> square;
+      square.push_back(std::array<double,2>{x * 10.0, y * 10.0});
+      square.push_back(std::array<double,2>{x * 10.0 + 10, y * 10.0});
+      square.push_back(std::array<double,2>{x * 10.0 + 10, y * 10.0 + 10});
+      square.push_back(std::array<double,2>{x * 10.0, y * 10.0 + 10});
+      if (1 == (x + y) % 2) {
+        std::reverse(square.begin(), square.end());
+      }
+      zones.push_back(square);
+    }
+  }
+  std::vector<std::array<double,2>> triangle;
+  triangle.push_back(std::array<double,2>{50.0, 0.0});
+  triangle.push_back(std::array<double,2>{70.0, 0.0});
+  triangle.push_back(std::array<double,2>{60.0, 25.0});
+  zones.push_back(triangle);
+
+  geofence::PartitionIndex<double> index(zones, 3);
+  CHECK(23 == index.vertices());
+  CHECK((3 * 5 + 4 * 4 + 3) == index.edges());
+
+  for(int x{-5}; x < 80; x += 2) {
+    for(int y{-5}; y < 40; y += 2) {
+      std::array<double,2> p{x + 0.25, y + 0.5};
+      int32_t expected{geofence::PartitionIndex<double>::NONE};
+      for(int32_t z{0}; z < static_cast<int32_t>(zones.size()); z++) {
+        if (geofence::isIn<double>(zones[static_cast<std::size_t>(z)], p)) {
+          expected = z;
+        }
+      }
+      CHECK(expected == index.zone(p));
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("topology stores shared borders once and agrees with isIn") {
+  // Adjacent 4x3 tessellation with wiggly borders; every second ring is clockwise and explicitly closed.
+  auto wiggle = [](int a, int b) {
+    return (a * 7 + b * 3) % 3 - 1;
+  };
+  std::vector<std::vector<std::array<int,2>>> polygons;
+  std::size_t inputVertices{0};
+  for(int y{0}; y < 3; y++) {
+    for(int x{0}; x < 4; x++) {
+      const int x0{x * 10};
+      const int y0{y * 10};
+      const int x1{x0 + 10};
+      const int y1{y0 + 10};
+      std::vector<std::array<int,2>> ring;
+      ring.push_back(std::array<int,2>{x0, y0});
+      for(int k{1}; k < 5; k++) {
+        ring.push_back(std::array<int,2>{x0 + 2 * k, y0 + wiggle(x0 + 2 * k, y0)});
+      }
+      ring.push_back(std::array<int,2>{x1, y0});
+      for(int k{1}; k < 5; k++) {
+        ring.push_back(std::array<int,2>{x1 + wiggle(x1, y0 + 2 * k), y0 + 2 * k});
+      }
+      ring.push_back(std::array<int,2>{x1, y1});
+      for(int k{1}; k < 5; k++) {
+        ring.push_back(std::array<int,2>{x1 - 2 * k, y1 + wiggle(x1 - 2 * k, y1)});
+      }
+      ring.push_back(std::array<int,2>{x0, y1});
+      for(int k{1}; k < 5; k++) {
+        ring.push_back(std::array<int,2>{x0 + wiggle(x0, y1 - 2 * k), y1 - 2 * k});
+      }
+      if (1 == (x + y) % 2) {
+        std::reverse(ring.begin(), ring.end());
+        ring.push_back(ring.front());
+      }
+      inputVertices += ring.size();
+      polygons.push_back(ring);
+    }
+  }
+  std::vector<std::array<int,2>> island;
+  island.push_back(std::array<int,2>{60, 60});
+  island.push_back(std::array<int,2>{70, 60});
+  island.push_back(std::array<int,2>{65, 70});
+  polygons.push_back(island);
+  polygons.push_back(std::vector<std::array<int,2>>(island.rbegin(), island.rend()));
+
+  geofence::Topology<int> topology(polygons);
+  CHECK(polygons.size() == topology.size());
+  // 31 borders of which the two outer ones at each corner of the tessellation merge; one island arc.
+  CHECK(31 - 4 + 1 == topology.arcs().size());
+  CHECK(topology.vertices() < inputVertices);
+  CHECK(topology.references(12).size() == 1);
+  CHECK(topology.references(12).front() == ~topology.references(13).front());
+
+  for(std::size_t polygon{0}; polygon < polygons.size(); polygon++) {
+    for(int x{-3}; x < 75; x++) {
+      for(int y{-3}; y < 75; y++) {
+        std::array<int,2> p{x, y};
+        CHECK(geofence::isIn<int>(polygons[polygon], p) == topology.isIn(polygon, p));
+      }
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("hilbert order visits neighbouring cells consecutively") {
+  std::vector<std::array<int,2>> points;
+  for(int x{0}; x < 16; x++) {
+    for(int y{0}; y < 16; y++) {
+      points.push_back(std::array<int,2>{x, y});
+    }
+  }
+  const auto order = geofence::hilbertOrder(points, 4);
+  REQUIRE(points.size() == order.size());
+  std::vector<bool> seen(points.size(), false);
+  for(std::size_t i{0}; i < order.size(); i++) {
+    seen[order[i]] = true;
+    if (0 < i) {
+      const auto &a = points[order[i - 1]];
+      const auto &b = points[order[i]];
+      CHECK(1 == std::abs(a[0] - b[0]) + std::abs(a[1] - b[1]));
+    }
+  }
+  CHECK(std::find(seen.begin(), seen.end(), false) == seen.end());
+}
+
+TEST_CASE("hilbert-ordered batch query returns results in original order") {
+  std::vector<std::array<double,2>> polygon;
+  const double PI{3.14159265358979323846};
+  for(int i{0}; i < 360; i++) {
+    const double phi{2.0 * PI * i / 360.0};
+    const double r{10.0 + 2.0 * std::sin(7.0 * phi)};
+    polygon.push_back(std::array<double,2>{r * std::cos(phi), r * std::sin(phi)});
+  }
+  geofence::MonotoneChainIndex<double> index(polygon);
+
+  std::vector<std::array<double,2>> points;
+  uint32_t seed{12345};
+  for(int i{0}; i < 5000; i++) {
+    seed = seed * 1664525u + 1013904223u;
+    const double x{(seed >> 8) % 28000 / 1000.0 - 14.0};
+    seed = seed * 1664525u + 1013904223u;
+    const double y{(seed >> 8) % 28000 / 1000.0 - 14.0};
+    points.push_back(std::array<double,2>{x, y});
+  }
+
+  std::vector<uint8_t> results;
+  geofence::queryBatch(points, [&index](const std::array<double,2> &p) {
+    return index.isIn(p);
+  }, results);
+  REQUIRE(points.size() == results.size());
+  for(std::size_t i{0}; i < points.size(); i++) {
+    CHECK(index.isIn(points[i]) == (1 == results[i]));
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("sweep classification matches isIn for both fill rules") {
+  // Comb with many vertices sharing y coordinates.
+  std::vector<std::array<int,2>> polygon{{0, 0}, {40, 0}, {40, 30}};
+  for(int tooth{9}; tooth >= 0; tooth--) {
+    polygon.push_back(std::array<int,2>{4 * tooth + 3, 30});
+    polygon.push_back(std::array<int,2>{4 * tooth + 2, 10 + tooth});
+    polygon.push_back(std::array<int,2>{4 * tooth + 1, 30});
+  }
+  polygon.push_back(std::array<int,2>{0, 30});
+
+  std::vector<std::array<int,2>> points;
+  for(int x{-2}; x < 43; x++) {
+    for(int y{-2}; y < 33; y++) {
+      points.push_back(std::array<int,2>{x, y});
+    }
+  }
+
+  geofence::SweepClassifier<int> evenOdd(polygon);
+  geofence::SweepClassifier<int, geofence::NonZeroRule> nonZero(polygon);
+  REQUIRE(22 == evenOdd.edges());
+  std::vector<bool> evenOddResults;
+  std::vector<bool> nonZeroResults;
+  evenOdd.classify(points, evenOddResults);
+  nonZero.classify(points, nonZeroResults);
+  REQUIRE(points.size() == evenOddResults.size());
+  for(std::size_t i{0}; i < points.size(); i++) {
+    CHECK(geofence::isIn<int>(polygon, points[i]) == evenOddResults[i]);
+    CHECK(geofence::isIn<int, geofence::NonZeroRule>(polygon, points[i]) == nonZeroResults[i]);
+  }
+
+  // As isIn, rings with less than three vertices do not contain their vertices.
+  std::vector<std::array<int,2>> segment{{0, 0}, {10, 10}};
+  std::vector<std::array<int,2>> vertices{{0, 0}, {10, 10}, {5, 5}};
+  geofence::SweepClassifier<int>(segment).classify(vertices, evenOddResults);
+  geofence::SweepClassifier<int, geofence::NonZeroRule>(segment).classify(vertices, nonZeroResults);
+  for(std::size_t i{0}; i < vertices.size(); i++) {
+    CHECK(geofence::isIn<int>(segment, vertices[i]) == evenOddResults[i]);
+    CHECK_FALSE(evenOddResults[i]);
+    CHECK_FALSE(nonZeroResults[i]);
+  }
+}
+
+TEST_CASE("sweep streams sorted points in chunks") {
+  std::vector<std::array<double,2>> polygon;
+  const double PI{3.14159265358979323846};
+  for(int i{0}; i < 1000; i++) {
+    const double phi{2.0 * PI * i / 1000.0};
+    const double r{10.0 + 3.0 * std::sin(23.0 * phi)};
+    polygon.push_back(std::array<double,2>{r * std::cos(phi), r * std::sin(phi)});
+  }
+  geofence::SweepClassifier<double> classifier(polygon);
+  geofence::SweepClassifier<double>::Sweep sweep(classifier);
+
+  // Rows of points arrive one chunk at a time in increasing y.
+  for(int row{0}; row < 300; row++) {
+    std::vector<std::array<double,2>> chunk;
+    for(int column{0}; column < 300; column++) {
+      chunk.push_back(std::array<double,2>{column * 0.1 - 15.0 + 0.013, row * 0.1 - 15.0 + 0.007});
+    }
+    for(auto &p : chunk) {
+      CHECK(geofence::isIn<double>(polygon, p) == sweep.isIn(p));
+    }
+  }
+}
+
+TEST_CASE("sweep classifies an externally sorted stream chunk by chunk") {
+  std::vector<std::array<double,2>> polygon;
+  const double PI{3.14159265358979323846};
+  for(int i{0}; i < 1000; i++) {
+    const double phi{2.0 * PI * i / 1000.0};
+    const double r{10.0 + 3.0 * std::sin(23.0 * phi)};
+    polygon.push_back(std::array<double,2>{r * std::cos(phi), r * std::sin(phi)});
+  }
+
+  // Unsorted points are sorted in runs that fit into memory...
+  std::vector<std::vector<std::array<double,2>>> runs(8);
+  uint64_t seed{7};
+  for(auto &run : runs) {
+    for(int i{0}; i < 2000; i++) {
+      seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+      const double x{static_cast<double>((seed >> 11) % 30000) / 1000.0 - 15.0};
+      seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+      const double y{static_cast<double>((seed >> 11) % 30000) / 1000.0 - 15.0};
+      run.push_back(std::array<double,2>{x, y});
+    }
+    std::sort(run.begin(), run.end(), [](const std::array<double,2> &lhs, const std::array<double,2> &rhs) {
+      return lhs[1] < rhs[1];
+    });
+  }
+
+  // ...and merged into one stream that a single sweep consumes in chunks.
+  geofence::SweepClassifier<double> classifier(polygon);
+  geofence::SweepClassifier<double>::Sweep sweep(classifier);
+  typedef std::pair<double, std::size_t> Head; // y and run
+  std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+  std::vector<std::size_t> next(runs.size(), 0);
+  for(std::size_t r{0}; r < runs.size(); r++) {
+    heads.push(Head{runs[r][0][1], r});
+  }
+  std::vector<std::array<double,2>> chunk;
+  std::size_t streamed{0};
+  std::size_t chunks{0};
+  while (!heads.empty()) {
+    const std::size_t r{heads.top().second};
+    heads.pop();
+    chunk.push_back(runs[r][next[r]++]);
+    if (next[r] < runs[r].size()) {
+      heads.push(Head{runs[r][next[r]][1], r});
+    }
+    if ((500 == chunk.size()) || heads.empty()) {
+      for(auto &p : chunk) {
+        CHECK(geofence::isIn<double>(polygon, p) == sweep.isIn(p));
+      }
+      streamed += chunk.size();
+      chunks++;
+      chunk.clear();
+    }
+  }
+  CHECK(16000 == streamed);
+  CHECK(32 == chunks);
+
+  // A point going back in y would miss edges that the sweep has already dropped.
+  CHECK_THROWS_AS(sweep.isIn(std::array<double,2>{{0.0, 0.0}}), std::invalid_argument);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("thread pool runs every index exactly once and rethrows errors") {
+  geofence::ThreadPool pool(4);
+  REQUIRE(4 == pool.size());
+
+  // Skewed work: the first indices are far more expensive than the rest.
+  std::vector<std::atomic<int>> visits(10000);
+  for(auto &v : visits) {
+    v = 0;
+  }
+  std::vector<std::atomic<int>> workers(pool.size());
+  for(auto &w : workers) {
+    w = 0;
+  }
+  pool.parallelFor(visits.size(), 16, [&visits, &workers](std::size_t begin, std::size_t end, std::size_t worker) {
+    for(std::size_t i{begin}; i < end; i++) {
+      if (i < 64) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      visits[i]++;
+    }
+    workers[worker]++;
+  });
+  for(const auto &v : visits) {
+    CHECK(1 == v);
+  }
+  int ranges{0};
+  for(const auto &w : workers) {
+    ranges += w;
+  }
+  CHECK((10000 + 15) / 16 == ranges);
+
+  CHECK_THROWS_AS(pool.parallelFor(100, 10, [](std::size_t begin, std::size_t, std::size_t) {
+    if (50 == begin) {
+      throw std::runtime_error("failed");
+    }
+  }), std::runtime_error);
+
+  // The pool remains usable after an error.
+  std::atomic<std::size_t> sum{0};
+  pool.parallelFor(1000, 7, [&sum](std::size_t begin, std::size_t end, std::size_t) {
+    for(std::size_t i{begin}; i < end; i++) {
+      sum += i;
+    }
+  });
+  CHECK(999 * 1000 / 2 == sum);
+}
+
+TEST_CASE("parallel batch and join match serial isIn") {
+  std::vector<std::vector<std::array<double,2>>> fences;
+  for(int f{0}; f < 20; f++) {
+    const double x0{f % 5 * 4.0};
+    const double y0{f / 5 * 4.0};
+    fences.push_back(std::vector<std::array<double,2>>{{x0, y0}, {x0 + 6.0, y0}, {x0 + 3.0, y0 + 6.0}});
+  }
+  std::vector<std::array<double,2>> points;
+  for(int x{0}; x < 100; x++) {
+    for(int y{0}; y < 100; y++) {
+      points.push_back(std::array<double,2>{x * 0.25 - 1.0 + 0.01, y * 0.25 - 1.0 + 0.02});
+    }
+  }
+
+  geofence::ThreadPool pool(3);
+  std::vector<uint8_t> results;
+  geofence::queryBatch(pool, points, [&fences](const std::array<double,2> &p) {
+    std::array<double,2> q{p};
+    return geofence::isIn<double>(fences.front(), q);
+  }, results, 64);
+  REQUIRE(points.size() == results.size());
+
+  std::vector<std::array<uint32_t,2>> expected;
+  for(uint32_t i{0}; i < points.size(); i++) {
+    std::array<double,2> p{points[i]};
+    CHECK(geofence::isIn<double>(fences.front(), p) == (1 == results[i]));
+    for(uint32_t f{0}; f < fences.size(); f++) {
+      if (geofence::isIn<double>(fences[f], p)) {
+        expected.push_back(std::array<uint32_t,2>{i, f});
+      }
+    }
+  }
+  REQUIRE(!expected.empty());
+  CHECK(expected == geofence::join(pool, points, fences, 100));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("tiled spatial join reports every pair once with every engine") {
+  // Overlapping fences of different sizes; the large ones span many tiles.
+  std::vector<std::vector<std::array<double,2>>> fences;
+  for(int f{0}; f < 60; f++) {
+    const double x0{(f * 37) % 50 * 1.0};
+    const double y0{(f * 17) % 50 * 1.0};
+    const double size{(0 == f % 10) ? 30.0 : 4.0 + f % 5};
+    fences.push_back(std::vector<std::array<double,2>>{{x0, y0}, {x0 + size, y0 + size / 3}, {x0 + size / 2, y0 + size}, {x0 - size / 4, y0 + size / 2}});
+  }
+  std::vector<std::array<double,2>> points;
+  for(int x{0}; x < 120; x++) {
+    for(int y{0}; y < 120; y++) {
+      points.push_back(std::array<double,2>{x * 0.7 - 5.0 + 0.013, y * 0.7 - 5.0 + 0.029});
+    }
+  }
+
+  std::vector<std::array<uint64_t,2>> expected;
+  for(uint64_t i{0}; i < points.size(); i++) {
+    std::array<double,2> p{points[i]};
+    for(uint64_t f{0}; f < fences.size(); f++) {
+      if (geofence::isIn<double>(fences[f], p)) {
+        expected.push_back(std::array<uint64_t,2>{i, f});
+      }
+    }
+  }
+  REQUIRE(!expected.empty());
+
+  geofence::ThreadPool pool(3);
+  using Join = geofence::SpatialJoin<double>;
+  for(auto engine : {Join::Engine::BOXES, Join::Engine::TREE, Join::Engine::SWEEP}) {
+    Join join(fences, engine, 6);
+    CHECK(36 == join.tiles());
+
+    // Stream the points table in two chunks into the same buffer.
+    const std::size_t HALF{points.size() / 2};
+    geofence::JoinPairs pairs;
+    join.join(pool, std::vector<std::array<double,2>>(points.begin(), points.begin() + HALF), pairs);
+    join.join(pool, std::vector<std::array<double,2>>(points.begin() + HALF, points.end()), pairs, HALF);
+    REQUIRE(pairs.points.size() == pairs.fences.size());
+
+    std::vector<std::array<uint64_t,2>> actual;
+    for(std::size_t k{0}; k < pairs.size(); k++) {
+      actual.push_back(std::array<uint64_t,2>{pairs.points[k], pairs.fences[k]});
+    }
+    std::sort(actual.begin(), actual.end());
+    CHECK(expected == actual);
+  }
+}
+
+TEST_CASE("spatial join counts points per fence and bucket without pairs") {
+  std::vector<std::vector<std::array<int,2>>> fences{
+    {{0, 0}, {40, 0}, {40, 40}, {0, 40}},
+    {{20, 20}, {60, 20}, {60, 60}, {20, 60}},
+    {{100, 100}, {110, 100}, {105, 110}},
+    {{5, 5}, {15, 5}, {10, 30}}};
+  std::vector<std::array<int,2>> points;
+  std::vector<uint32_t> hours;
+  for(int x{-5}; x < 70; x++) {
+    for(int y{-5}; y < 70; y++) {
+      points.push_back(std::array<int,2>{x, y});
+      hours.push_back(static_cast<uint32_t>(x * 7 + y) % 24);
+    }
+  }
+
+  std::vector<uint64_t> expected(fences.size() * 24, 0);
+  for(std::size_t i{0}; i < points.size(); i++) {
+    for(std::size_t f{0}; f < fences.size(); f++) {
+      if (geofence::isIn<int>(fences[f], points[i])) {
+        expected[f * 24 + hours[i]]++;
+      }
+    }
+  }
+
+  geofence::ThreadPool pool(2);
+  geofence::SpatialJoin<int> join(fences, geofence::SpatialJoin<int>::Engine::TREE, 4);
+  std::vector<uint64_t> perHour;
+  join.count(pool, points, hours, 24, perHour);
+  CHECK(expected == perHour);
+
+  // Buckets are validated before any worker indexes its counters.
+  std::vector<uint32_t> outOfRange{hours};
+  outOfRange.back() = 24;
+  CHECK_THROWS_AS(join.count(pool, points, outOfRange, 24, perHour), std::invalid_argument);
+  CHECK_THROWS_AS(join.count(pool, points, std::vector<uint32_t>(hours.begin(), hours.end() - 1), 24, perHour), std::invalid_argument);
+  CHECK_THROWS_AS(join.count(pool, points, std::vector<uint32_t>(), 0, perHour), std::invalid_argument);
+  CHECK(expected == perHour);
+
+  // Totals accumulate over chunks.
+  std::vector<uint64_t> totals;
+  join.count(pool, points, totals);
+  join.count(pool, points, totals);
+  REQUIRE(fences.size() == totals.size());
+  for(std::size_t f{0}; f < fences.size(); f++) {
+    uint64_t sum{0};
+    for(std::size_t h{0}; h < 24; h++) {
+      sum += expected[f * 24 + h];
+    }
+    CHECK(2 * sum == totals[f]);
+  }
+  CHECK(0 == totals[2]);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+std::unique_ptr<const geofence::ArrangementIndex<double>> makeArrangement(double x0) {
+  std::vector<std::vector<std::array<double,2>>> fences{{{x0, 0}, {x0 + 1, 0}, {x0 + 1, 1}, {x0, 1}}};
+  return std::unique_ptr<const geofence::ArrangementIndex<double>>(new geofence::ArrangementIndex<double>(fences));
+}
+}
+
+TEST_CASE("registry keeps pinned snapshots alive until released") {
+  geofence::Registry<geofence::ArrangementIndex<double>> registry(makeArrangement(0), 2);
+  auto reader = registry.reader();
+  auto second = registry.reader();
+  CHECK_THROWS_AS(registry.reader(), std::runtime_error);
+
+  {
+    auto pinned = reader.pin();
+    CHECK(1 == pinned.version());
+    CHECK(2 == registry.publish(makeArrangement(10)));
+    CHECK(1 == registry.reclaim());
+    // The old snapshot is still usable while pinned.
+    CHECK(1 == pinned->query(std::array<double,2>{0.5, 0.5}).size());
+    auto current = second.pin();
+    CHECK(2 == current.version());
+    CHECK(1 == current->query(std::array<double,2>{10.5, 0.5}).size());
+  }
+  CHECK(0 == registry.reclaim());
+
+  auto rebuilt = registry.rebuild([]() {
+    std::vector<std::vector<std::array<double,2>>> fences{{{20, 0}, {21, 0}, {21, 1}, {20, 1}}};
+    return geofence::ArrangementIndex<double>(fences);
+  });
+  CHECK(3 == rebuilt.get());
+  CHECK(3 == registry.version());
+  CHECK(1 == reader.pin()->query(std::array<double,2>{20.5, 0.5}).size());
+}
+
+TEST_CASE("registry readers see consistent snapshots during updates") {
+  geofence::Registry<geofence::ArrangementIndex<double>> registry(makeArrangement(0), 8);
+  std::atomic<bool> done{false};
+  std::atomic<int> errors{0};
+  std::vector<std::thread> readers;
+  for(int r{0}; r < 3; r++) {
+    readers.push_back(std::thread([&registry, &done, &errors]() {
+      auto reader = registry.reader();
+      while (!done) {
+        auto snapshot = reader.pin();
+        // Version v holds the unit square starting at x = v - 1.
+        const double x{static_cast<double>(snapshot.version()) - 0.5};
+        if (1 != snapshot->query(std::array<double,2>{x, 0.5}).size()) {
+          errors++;
+        }
+      }
+    }));
+  }
+  for(int v{1}; v < 50; v++) {
+    registry.rebuild([v]() {
+      std::vector<std::vector<std::array<double,2>>> fences{{{1.0 * v, 0}, {v + 1.0, 0}, {v + 1.0, 1}, {1.0 * v, 1}}};
+      return geofence::ArrangementIndex<double>(fences);
+    }).get();
+  }
+  done = true;
+  for(auto &t : readers) {
+    t.join();
+  }
+  CHECK(0 == errors);
+  CHECK(50 == registry.version());
+  CHECK(0 == registry.reclaim());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("dynamic fence index matches isIn after inserts and removals") {
+  geofence::DynamicFenceIndex<int> index;
+  std::vector<std::vector<std::array<int,2>>> fences;
+  std::vector<bool> alive;
+  uint32_t seed{4711};
+  auto next = [&seed](uint32_t range) {
+    seed = seed * 1664525u + 1013904223u;
+    return static_cast<int>((seed >> 8) % range);
+  };
+
+  auto check = [&index, &fences, &alive]() {
+    for(int x{-1}; x < 101; x += 3) {
+      for(int y{-1}; y < 101; y += 3) {
+        std::array<int,2> p{x, y};
+        std::vector<uint32_t> expected;
+        for(uint32_t f{0}; f < fences.size(); f++) {
+          if (alive[f] && geofence::isIn<int>(fences[f], p)) {
+            expected.push_back(f);
+          }
+        }
+        CHECK(expected == index.query(p));
+      }
+    }
+  };
+
+  for(int round{0}; round < 3; round++) {
+    for(int i{0}; i < 300; i++) {
+      const int x{next(90)};
+      const int y{next(90)};
+      const int size{2 + next(10)};
+      fences.push_back(std::vector<std::array<int,2>>{{x, y}, {x + size, y + 1}, {x + size / 2, y + size}});
+      alive.push_back(true);
+      CHECK(fences.size() - 1 == index.insert(fences.back()));
+    }
+    for(int i{0}; i < 150; i++) {
+      const uint32_t f{static_cast<uint32_t>(next(static_cast<uint32_t>(fences.size())))};
+      CHECK(alive[f] == index.remove(f));
+      alive[f] = false;
+    }
+    check();
+  }
+  CHECK(static_cast<std::size_t>(std::count(alive.begin(), alive.end(), true)) == index.size());
+  // 900 inserted fences need at most log2(900 / 64) + 1 trees.
+  CHECK(index.levels() <= 4);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("fence store answers queries in place and rejects corrupt buffers") {
+  std::vector<std::vector<std::array<double,2>>> fences;
+  const double PI{3.14159265358979323846};
+  for(int f{0}; f < 100; f++) {
+    std::vector<std::array<double,2>> fence;
+    const double cx{(f % 10) * 3.0};
+    const double cy{(f / 10) * 3.0};
+    for(int i{0}; i < 40; i++) {
+      const double phi{2.0 * PI * i / 40.0};
+      const double r{2.0 + 0.5 * std::sin(5.0 * phi)};
+      fence.push_back(std::array<double,2>{cx + r * std::cos(phi), cy + r * std::sin(phi)});
+    }
+    fences.push_back(fence);
+  }
+  fences.push_back(std::vector<std::array<double,2>>{});
+
+  const std::vector<uint8_t> buffer{geofence::FenceStore::build(fences)};
+  const geofence::FenceStore store(buffer.data(), buffer.size());
+  REQUIRE(fences.size() == store.size());
+  for(int x{0}; x < 120; x++) {
+    for(int y{0}; y < 120; y++) {
+      std::array<double,2> p{x * 0.25 - 2.5 + 0.01, y * 0.25 - 2.5 + 0.02};
+      std::vector<uint32_t> expected;
+      for(uint32_t f{0}; f < fences.size(); f++) {
+        if (geofence::isIn<double>(fences[f], p)) {
+          expected.push_back(f);
+        }
+      }
+      CHECK(expected == store.query(p));
+      CHECK(expected == store.query<geofence::NonZeroRule>(p));
+    }
+  }
+
+  std::vector<uint8_t> corrupt{buffer};
+  corrupt[0] = 'X';
+  CHECK_THROWS_AS(geofence::FenceStore(corrupt.data(), corrupt.size()), std::runtime_error);
+  CHECK_THROWS_AS(geofence::FenceStore(buffer.data(), buffer.size() - 8), std::runtime_error);
+
+  // Records pointing outside their sections are rejected when loading.
+  geofence::FenceStore::Header header;
+  std::memcpy(&header, buffer.data(), sizeof(header));
+  const uint64_t huge{0xFFFFFFFFFFFF0000ull};
+  for(uint64_t offset : {header.fenceOffset + offsetof(geofence::FenceStore::Fence, firstVertex),
+                         header.fenceOffset + offsetof(geofence::FenceStore::Fence, chains),
+                         header.chainOffset + offsetof(geofence::FenceStore::Chain, first),
+                         header.levelOffset + offsetof(geofence::FenceStore::Level, count)}) {
+    corrupt = buffer;
+    std::memcpy(corrupt.data() + offset, &huge, sizeof(huge));
+    CHECK_THROWS_AS(geofence::FenceStore(corrupt.data(), corrupt.size()), std::runtime_error);
+  }
+
+  const std::string path{"geofence-store-test.bin"};
+  {
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+  }
+  {
+    geofence::MappedFile mapped(path);
+    const geofence::FenceStore view(mapped.data(), mapped.size());
+    CHECK(store.query(std::array<double,2>{0.0, 0.0}) == view.query(std::array<double,2>{0.0, 0.0}));
+    CHECK(1 == view.query(std::array<double,2>{27.0, 27.0}).size());
+  }
+  std::remove(path.c_str());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("normalize closes, deduplicates, and orients rings") {
+  std::vector<std::array<double,2>> ring{{0, 0}, {0, 4}, {0, 4}, {4, 4}, {4, 0}, {0, 0}};
+  REQUIRE(geofence::normalize(ring));
+  CHECK(4 == ring.size());
+  CHECK(0 < geofence::detail::signedArea2(ring));
+
+  std::vector<std::array<double,2>> line{{0, 0}, {1, 1}, {2, 2}, {0, 0}};
+  CHECK(!geofence::normalize(line));
+  std::vector<std::array<double,2>> point{{1, 1}, {1, 1}, {1, 1}};
+  CHECK(!geofence::normalize(point));
+  std::vector<std::array<double,2>> broken{{0, 0}, {1, std::nan("")}, {1, 1}};
+  CHECK(!geofence::normalize(broken));
+}
+
+TEST_CASE("WKT and GeoJSON readers return the same polygons") {
+  const std::string wkt{
+    "POLYGON ((0 0, 10 0, 10 10, 0 10, 0 0), (2 2, 4 2, 4 4, 2 2))\n"
+    "multipolygon Z (((20 0 1, 30 0 1, 25 5 1, 20 0 1)), ((40 0, 50 0, 45 5, 40 0)))\n"
+    "POLYGON EMPTY\n"};
+  const std::string json{
+    "{\"type\": \"FeatureCollection\", \"features\": ["
+    "  {\"type\": \"Feature\", \"properties\": {\"name\": \"a \\\"quoted\\\" name\", \"ok\": true, \"n\": null},"
+    "   \"geometry\": {\"coordinates\": [[[0, 0], [10, 0], [10, 10], [0, 10], [0, 0]], [[2, 2], [4, 2], [4, 4], [2, 2]]], \"type\": \"Polygon\"}},"
+    "  {\"type\": \"Feature\", \"properties\": {},"
+    "   \"geometry\": {\"type\": \"MultiPolygon\", \"coordinates\": [[[[20, 0, 1], [30, 0, 1], [25, 5, 1], [20, 0, 1]]], [[[40, 0], [50, 0], [45, 5], [40, 0]]]]}},"
+    "  {\"type\": \"Feature\", \"geometry\": {\"type\": \"Point\", \"coordinates\": [1.5e1, -2]}}"
+    "]}"};
+
+  const auto fromWkt = geofence::readWkt(wkt);
+  const auto fromJson = geofence::readGeoJson(json);
+  REQUIRE(3 == fromWkt.size());
+  REQUIRE(3 == fromJson.size());
+  for(std::size_t i{0}; i < fromWkt.size(); i++) {
+    CHECK(fromWkt[i].outer == fromJson[i].outer);
+    CHECK(fromWkt[i].holes == fromJson[i].holes);
+  }
+  CHECK(1 == fromWkt[0].holes.size());
+  CHECK((std::array<double,2>{45, 5}) == fromJson[2].outer[2]);
+
+  CHECK_THROWS_AS(geofence::readWkt("LINESTRING (0 0, 1 1)"), std::runtime_error);
+  CHECK_THROWS_AS(geofence::readWkt("POLYGON ((0 0, 1 1"), std::runtime_error);
+  CHECK_THROWS_AS(geofence::readGeoJson("{\"type\": \"Polygon\", \"coordinates\": [[[0, 0], [1 1]]]}"), std::runtime_error);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("parseNumber matches strtod") {
+  const std::vector<std::string> numbers{"0", "-0", "7", "-73.9857123", "40.748817", "1e3", "2.5E-3", "1.7976931348623157e308",
+                                         "123456789012345678901234", "0.000000000000000000000000001", "4.9e-324", "9007199254740993",
+                                         "3.141592653589793238462643383279", "-12.5e+2", "12345678.87654321", "-0.0000000012345678",
+                                         "11.974532180999999", "-179.99999999999999999", "9007199254740993.000000000000000000001",
+                                         "2.2250738585072011e-308", "2.2250738585072012e-308", "2.4703282292062327e-324",
+                                         "2.4703282292062328e-324", "1.7976931348623158e308", "1.7976931348623159e308", "1e400",
+                                         "-1e-400", "0.00000000000000000000000000000000000000000000000000001e-290",
+                                         "7.0e-10", "1e23", "8.988465674311579539e307", "123456789012345678.9e-300"};
+  for(const auto &n : numbers) {
+    const char *s{n.data()};
+    double v{0};
+    REQUIRE(geofence::detail::parseNumber(s, n.data() + n.size(), v));
+    CHECK(n.data() + n.size() == s);
+    CHECK(0 == std::memcmp(&v, &static_cast<const double&>(std::strtod(n.c_str(), nullptr)), sizeof(double)));
+  }
+
+  uint64_t seed{12345};
+  for(uint32_t i{0}; i < 100000; i++) {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    const std::string n{std::to_string(static_cast<int64_t>(seed >> 40) - (int64_t{1} << 23)) + "." + std::to_string((seed >> 8) % 10000000)};
+    const char *s{n.data()};
+    double v{0};
+    geofence::detail::parseNumber(s, n.data() + n.size(), v);
+    REQUIRE(std::strtod(n.c_str(), nullptr) == Approx(v).epsilon(0));
+  }
+
+  // Coordinates as written with full double precision, 17 to 19 significant digits, and longer mantissas.
+  for(uint32_t i{0}; i < 100000; i++) {
+    std::string n{(0 == i % 2) ? "-" : ""};
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    n += std::to_string((seed >> 33) % 181) + ".";
+    const std::size_t length{n.size() - ((0 == i % 2) ? 2 : 1) + 17 + i % 3 + ((0 == i % 7) ? i % 23 : 0)};
+    while (n.size() < length) {
+      seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+      n += static_cast<char>('0' + (seed >> 40) % 10);
+    }
+    if (0 == i % 5) {
+      seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+      n += "e" + std::to_string(static_cast<int32_t>((seed >> 33) % 640) - 330);
+    }
+    const char *s{n.data()};
+    double v{0};
+    geofence::detail::parseNumber(s, n.data() + n.size(), v);
+    CHECK(n.data() + n.size() == s);
+    REQUIRE(0 == std::memcmp(&v, &static_cast<const double&>(std::strtod(n.c_str(), nullptr)), sizeof(double)));
+  }
+
+  // Exact halfway points need all their digits; the digits after the first 800 only break the tie.
+  const std::string tie{"9007199254740993." + std::string(900, '0')};
+  // 5^1075 * 10^-1075 == 2^-1075, halfway between 0 and the smallest subnormal
+  const std::string halfway{"2470328229206232720882843964341106861825299013071623822127928412503377536351043759326499181808179961"
+                            "8989828234772285886546332835517796989819938739800539093906315035659515570226392290858392449105184435"
+                            "9318028499365361525003193704576782492193656236698636584807570015857692699037063119282795585513329278"
+                            "3433840935197801553124659726357957462276646527282722005637400648549997709659947045402082816622623785"
+                            "7393450736339007967761930577506740176324673600968951340535537458516661134223766678604162159680461914"
+                            "4672918403005300575308490487653917113865916462395249126236538818796362393732804238910186723484976682"
+                            "3508986338858792562830275599565752445550725518931369083625477918694866799496832404970582102851318545"
+                            "1396213837722826145437693412532098591327667236328125"};
+  for(const auto &n : {tie, tie + "1", halfway + "e-1075", halfway + "1e-1076", halfway.substr(0, halfway.size() - 1) + "4e-1075"}) {
+    const char *s{n.data()};
+    double v{0};
+    REQUIRE(geofence::detail::parseNumber(s, n.data() + n.size(), v));
+    CHECK(0 == std::memcmp(&v, &static_cast<const double&>(std::strtod(n.c_str(), nullptr)), sizeof(double)));
+  }
+}
+
+TEST_CASE("streaming GeoJSON reader fills a reusable arena") {
+  const std::string json{
+    "{\"type\": \"FeatureCollection\", \"bbox\": [0, 0, 50, 10], \"features\": ["
+    "  {\"type\": \"Feature\", \"properties\": {\"geometry\": {\"type\": \"Polygon\", \"coordinates\": [[[9, 9], [9, 8], [8, 8]]]}, \"s\": \"]}\\\"\"},"
+    "   \"geometry\": {\"type\": \"Polygon\", \"coordinates\": [[[0, 0], [10, 0], [10, 10], [0, 10], [0, 0]], [[2, 2], [4, 2], [4, 4], [2, 2]]]}},"
+    "  {\"type\": \"Feature\", \"geometry\": {\"type\": \"LineString\", \"coordinates\": [[0, 0], [1, 1]]}},"
+    "  {\"type\": \"Feature\", \"geometry\": {\"coordinates\": [[0, 0], [1, 1]], \"type\": \"LineString\"}},"
+    "  {\"type\": \"Feature\", \"geometry\": {\"type\": \"Polygon\", \"coordinates\": []}},"
+    "  {\"type\": \"Feature\", \"geometry\": {\"type\": \"MultiPolygon\", \"coordinates\": [[[[20, 0], [30, 0], [25, 5]]], [[[40, 0], [50, 0], [45, 5]]]]}}"
+    "]}"};
+
+  geofence::RingArena<float> arena;
+  geofence::readGeoJson(json.data(), json.size(), arena);
+  REQUIRE(3 == arena.polygons());
+  CHECK(4 == arena.rings());
+  CHECK(2 == arena.firstRing(1) - arena.firstRing(0));
+  CHECK(5 == arena.ringSize(0));
+  CHECK(3 == arena.ringSize(3));
+  CHECK((std::array<float,2>{45, 5}) == arena.ring(3)[2]);
+  CHECK(15 == arena.vertices().size());
+
+  std::array<float,2> inside{{5, 5}};
+  auto outer = arena.copy(0);
+  CHECK(geofence::isIn<float>(outer, inside));
+
+  // Consuming every geometry in the visitor keeps the arena small.
+  std::vector<std::size_t> rings;
+  std::size_t capacity{0};
+  arena.clear();
+  geofence::readGeoJson(json.data(), json.size(), arena, [&rings, &capacity](geofence::RingArena<float> &a) {
+    rings.push_back(a.rings());
+    capacity = (std::max)(capacity, a.vertices().size());
+    a.clear();
+  });
+  CHECK((std::vector<std::size_t>{2, 0, 2}) == rings);
+  CHECK(9 == capacity);
+
+  // The reader does not rely on a terminating character.
+  const std::string truncated{json.substr(0, json.find("[[[0, 0]") + 6)};
+  CHECK_THROWS_AS(geofence::readGeoJson(truncated.data(), truncated.size(), arena), std::runtime_error);
+  CHECK_THROWS_AS(geofence::readGeoJson(std::string{"{\"a\": \"unterminated}"}), std::runtime_error);
+
+  // Coordinates deeper than a multipolygon fail before exhausting the stack.
+  const std::string deep{"{\"type\": \"Polygon\", \"coordinates\": " + std::string(100000, '[')};
+  CHECK_THROWS_AS(geofence::readGeoJson(deep), std::runtime_error);
+  CHECK_THROWS_AS(geofence::readGeoJson(std::string{"{\"type\": \"MultiPolygon\", \"coordinates\": [[[[[0, 0]]]]]}"}), std::runtime_error);
+  const std::string deepMember{"{\"x\": " + std::string(2000000, '[')};
+  CHECK_THROWS_AS(geofence::readGeoJson(deepMember), std::runtime_error);
+  std::string deepObjects;
+  for(int i{0}; i < 100000; i++) {
+    deepObjects += "{\"a\": ";
+  }
+  CHECK_THROWS_AS(geofence::readGeoJson(deepObjects), std::runtime_error);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("WKB round trip and views in both byte orders") {
+  const auto polygons = geofence::readWkt("POLYGON ((0 0, 10 0, 10 10, 0 10, 0 0), (2 2, 2 4, 4 4, 4 2, 2 2))\n"
+                                          "POLYGON ((20 0, 30 0, 25 5, 20 0))");
+  const std::vector<uint8_t> wkb{geofence::writeWkb(polygons)};
+  CHECK(9 + 2 * 9 + 3 * 4 + (5 + 5 + 4) * 16 == wkb.size());
+
+  const auto views = geofence::readWkb(wkb.data(), wkb.size());
+  REQUIRE(2 == views.size());
+  REQUIRE(2 == views[0].rings.size());
+  CHECK(polygons[0].outer == views[0].rings[0].copy());
+  CHECK(polygons[0].holes[0] == views[0].rings[1].copy());
+  CHECK(polygons[1].outer == views[1].rings[0].copy());
+
+  geofence::MultiPolygon<double> reference;
+  reference.add(polygons[0].outer, polygons[0].holes);
+  for(double y{-1}; y < 12; y += 0.5) {
+    for(double x{-1}; x < 32; x += 0.5) {
+      std::array<double,2> p{{x, y}};
+      auto triangle = polygons[1].outer;
+      CHECK(reference.isIn(p) == geofence::isIn(views[0], p));
+      CHECK(geofence::isIn<double>(triangle, p) == geofence::isIn(views[1], p));
+    }
+  }
+
+  // Big-endian PostGIS EWKB with SRID and Z: POLYGON Z ((0 0 1, 1 0 1, 0 1 1, 0 0 1)).
+  std::vector<uint8_t> ewkb{0, 0xA0, 0, 0, 3, 0, 0, 0x10, 0xE6, 0, 0, 0, 1, 0, 0, 0, 4};
+  const double coordinates[]{0, 0, 1, 1, 0, 1, 0, 1, 1, 0, 0, 1};
+  for(double c : coordinates) {
+    uint64_t bits;
+    std::memcpy(&bits, &c, sizeof(bits));
+    for(int shift{56}; 0 <= shift; shift -= 8) {
+      ewkb.push_back(static_cast<uint8_t>(bits >> shift));
+    }
+  }
+  const auto big = geofence::readWkb(ewkb.data(), ewkb.size());
+  REQUIRE(1 == big.size());
+  CHECK((std::vector<std::array<double,2>>{{0, 0}, {1, 0}, {0, 1}, {0, 0}}) == big[0].rings[0].copy());
+  CHECK(geofence::isIn(big[0], std::array<double,2>{{0.25, 0.25}}));
+
+  CHECK_THROWS_AS(geofence::readWkb(ewkb.data(), ewkb.size() - 1), std::runtime_error);
+  ewkb[4] = 2;
+  CHECK_THROWS_AS(geofence::readWkb(ewkb.data(), ewkb.size()), std::runtime_error);
+  ewkb[0] = 7;
+  CHECK_THROWS_AS(geofence::readWkb(ewkb.data(), ewkb.size()), std::runtime_error);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("monotonic arena packs fence sets") {
+  geofence::MonotonicArena arena(1024);
+  std::vector<geofence::ArenaRing<double>> fences;
+  for(uint32_t f{0}; f < 100; f++) {
+    geofence::ArenaRing<double> ring(&arena);
+    ring.reserve(4);
+    const double x{static_cast<double>(f) * 10};
+    ring.push_back({x, 0});
+    ring.push_back({x + 5, 0});
+    ring.push_back({x + 5, 5});
+    ring.push_back({x, 5});
+    fences.push_back(std::move(ring));
+  }
+  CHECK(100 * 4 * sizeof(std::array<double,2>) == arena.used());
+  CHECK(arena.chunks() <= 4);
+  // Consecutive fences are adjacent in memory.
+  CHECK(fences[1].data() == fences[0].data() + 4);
+
+  std::array<double,2> inside{{502, 2}};
+  std::array<double,2> between{{507, 2}};
+  CHECK(geofence::isIn<double>(fences[50], inside));
+  CHECK(!geofence::isIn<double>(fences[50], between));
+
+  // Hull temporaries come from a scratch arena; the hull uses the fence's allocator.
+  geofence::MonotonicArena scratch;
+  geofence::ArenaRing<double> square(&arena);
+  square.assign({{0, 0}, {2, 1}, {4, 0}, {3, 2}, {4, 4}, {2, 3}, {0, 4}, {1, 2}});
+  const auto hull = geofence::getConvexHull(square, &scratch);
+  CHECK((geofence::ArenaRing<double>{{0, 0}, {0, 4}, {4, 4}, {4, 0}}) == hull);
+  CHECK(&arena == hull.get_allocator().resource());
+  CHECK(0 < scratch.used());
+  std::vector<std::array<double,2>> plain(square.begin(), square.end());
+  CHECK(std::vector<std::array<double,2>>(hull.begin(), hull.end()) == geofence::getConvexHull(plain));
+
+  fences.clear();
+  arena.release();
+  CHECK(0 == arena.used());
+  CHECK(0 == arena.chunks());
+
+  // Alignment is honored across chunk boundaries.
+  for(std::size_t bytes : {1, 3, 200, 5000, 7}) {
+    CHECK(0 == reinterpret_cast<std::uintptr_t>(arena.allocate(bytes, 16)) % 16);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("compressed polygon answers as its snapped vertices") {
+  // Wavy ring with 10000 vertices and a few spikes, so that blocks have differing bit widths and the last one is partial.
+  std::vector<std::array<double,2>> star;
+  for(uint32_t k{0}; k < 10000; k++) {
+    const double angle{static_cast<double>(k) * 2 * 3.14159265358979 / 10000};
+    const double radius{(0 == k % 997) ? 2.0 : 9.0 + 0.5 * std::sin(static_cast<double>(k) * 0.01)};
+    star.push_back({{11.5 + radius * std::cos(angle), 57.7 + radius * std::sin(angle)}});
+  }
+  const geofence::CompressedPolygon<double> compressed(star, 20);
+  CHECK(10000 == compressed.size());
+  CHECK(compressed.bytes() * 4 < star.size() * sizeof(std::array<double,2>));
+
+  auto snapped = compressed.decode();
+  REQUIRE(star.size() == snapped.size());
+  for(std::size_t i{0}; i < star.size(); i++) {
+    CHECK(std::abs(star[i][0] - snapped[i][0]) <= compressed.resolution() / 2 + 1e-12);
+    CHECK(std::abs(star[i][1] - snapped[i][1]) <= compressed.resolution() / 2 + 1e-12);
+  }
+  for(double y{47.25}; y < 68; y += 0.37) {
+    for(double x{1.25}; x < 22; x += 0.41) {
+      std::array<double,2> p{{x, y}};
+      CHECK(geofence::isIn<double>(snapped, p) == compressed.isIn(p));
+    }
+  }
+  CHECK(compressed.isIn(snapped[123]));
+
+  const geofence::CompressedPolygon<double, geofence::NonZeroRule> nonZero(star, 30);
+  std::array<double,2> center{{11.5, 57.7}};
+  CHECK(nonZero.isIn(center));
+  CHECK(!geofence::CompressedPolygon<double>(std::vector<std::array<double,2>>{{0, 0}, {1, 1}}).isIn(center));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("quantized cell edges answer as isIn next to the boundary") {
+  std::vector<std::array<double,2>> polygon;
+  const double PI{3.14159265358979323846};
+  for(int i{0}; i < 720; i++) {
+    const double phi{2.0 * PI * i / 720.0};
+    const double r{10.0 + 2.0 * std::sin(7.0 * phi) + 0.5 * std::cos(31.0 * phi)};
+    polygon.push_back(std::array<double,2>{r * std::cos(phi), r * std::sin(phi)});
+  }
+
+  for(uint32_t maxLevel : {4u, 12u}) {
+    geofence::CellCovering<double> covering(polygon, maxLevel, 8);
+    CHECK(0 < covering.quantizedCells());
+    CHECK(covering.quantizedCells() <= covering.boundaryCells());
+    // Points left and right of every edge's midpoint, from far beyond to well within the quantization error.
+    for(std::size_t k{0}; k < polygon.size(); k++) {
+      const auto &u = polygon[k];
+      const auto &v = polygon[(k + 1) % polygon.size()];
+      const double length{std::hypot(v[0] - u[0], v[1] - u[1])};
+      for(double offset : {-1e-2, -1e-5, -1e-6, -1e-7, 1e-7, 1e-6, 1e-5, 1e-2}) {
+        std::array<double,2> p{{(u[0] + v[0]) / 2 - offset * (v[1] - u[1]) / length, (u[1] + v[1]) / 2 + offset * (v[0] - u[0]) / length}};
+        CHECK(geofence::isIn<double>(polygon, p) == covering.isIn(p));
+      }
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("raster index answers as isIn with and without refinement") {
+  std::vector<std::array<double,2>> polygon;
+  const double PI{3.14159265358979323846};
+  for(int i{0}; i < 2000; i++) {
+    const double phi{2.0 * PI * i / 2000.0};
+    const double r{10.0 + 2.0 * std::sin(7.0 * phi) + 0.5 * std::cos(301.0 * phi)};
+    polygon.push_back(std::array<double,2>{r * std::cos(phi), r * std::sin(phi)});
+  }
+  // Axis-aligned ring with edges on pixel borders and center lines; probes avoid the edges, where conventions differ.
+  std::vector<std::array<double,2>> square{{0, 0}, {16, 0}, {16, 8.5}, {8, 8.5}, {8, 16}, {0, 16}};
+
+  uint32_t seed{42};
+  auto random = [&seed](double min, double max) {
+    seed = seed * 1664525u + 1013904223u;
+    return min + (max - min) * static_cast<double>(seed >> 8) / static_cast<double>(1u << 24);
+  };
+  for(uint32_t depth : {0u, 1u, 2u}) {
+    geofence::RasterIndex<double> raster(polygon, 8, depth, 2);
+    CHECK((0 == depth) == (0 == raster.tiles()));
+    for(int i{0}; i < 20000; i++) {
+      std::array<double,2> p{{random(-13, 13), random(-13, 13)}};
+      CHECK(geofence::isIn<double>(polygon, p) == raster.isIn(p));
+    }
+    for(std::size_t k{0}; k < polygon.size(); k++) {
+      const auto &u = polygon[k];
+      const auto &v = polygon[(k + 1) % polygon.size()];
+      CHECK(raster.isIn(u));
+      for(double offset : {-1e-3, -1e-9, 1e-9, 1e-3}) {
+        std::array<double,2> p{{(u[0] + v[0]) / 2 - offset * (v[1] - u[1]), (u[1] + v[1]) / 2 + offset * (v[0] - u[0])}};
+        CHECK(geofence::isIn<double>(polygon, p) == raster.isIn(p));
+      }
+    }
+
+    geofence::RasterIndex<double, geofence::NonZeroRule> nonZero(square, 4, depth, 1);
+    for(double y{-0.4}; y < 17; y += 0.25) {
+      for(double x{-0.4}; x < 17; x += 0.25) {
+        std::array<double,2> p{{x, y}};
+        CHECK(geofence::isIn<double, geofence::NonZeroRule>(square, p) == nonZero.isIn(p));
+      }
+    }
+  }
+
+  // Almost all queries in the bounding box of a fine raster are a single load.
+  geofence::RasterIndex<double> fine(polygon, 12, 1);
+  std::size_t resolved{0};
+  for(int i{0}; i < 10000; i++) {
+    resolved += fine.isResolved(std::array<double,2>{{random(-13, 13), random(-13, 13)}}) ? 1 : 0;
+  }
+  CHECK(9900 < resolved);
+  CHECK(!geofence::RasterIndex<double>(std::vector<std::array<double,2>>{{0, 0}, {1, 1}}).isIn(std::array<double,2>{{0, 0}}));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TEST_CASE("signed distance agrees with isIn and the nearest edge") {
+  std::vector<std::array<double,2>> polygon;
+  const double PI{3.14159265358979323846};
+  for(int i{0}; i < 500; i++) {
+    const double phi{2.0 * PI * i / 500.0};
+    const double r{10.0 + 2.0 * std::sin(7.0 * phi) + 0.5 * std::cos(31.0 * phi)};
+    polygon.push_back(std::array<double,2>{r * std::cos(phi), r * std::sin(phi)});
+  }
+  // Self-overlapping ring where the fill rules differ.
+  std::vector<std::array<double,2>> twice{{0, 0}, {4, 0}, {4, 4}, {0, 4}, {0, 0}, {4, 0}, {4, 4}, {0, 4}};
+
+  std::vector<double> xs;
+  std::vector<double> ys;
+  uint32_t seed{7};
+  auto random = [&seed](double min, double max) {
+    seed = seed * 1664525u + 1013904223u;
+    return min + (max - min) * static_cast<double>(seed >> 8) / static_cast<double>(1u << 24);
+  };
+  for(int i{0}; i < 1000; i++) {
+    xs.push_back(random(-14, 14));
+    ys.push_back(random(-14, 14));
+  }
+  xs.push_back(polygon[17][0]);
+  ys.push_back(polygon[17][1]);
+
+  std::vector<double> batch(xs.size());
+  geofence::signedDistances(polygon, xs.data(), ys.data(), xs.size(), batch.data());
+  geofence::MonotoneChainIndex<double> chains(polygon);
+  for(std::size_t i{0}; i < xs.size(); i++) {
+    std::array<double,2> p{{xs[i], ys[i]}};
+    double nearest{std::numeric_limits<double>::infinity()};
+    for(std::size_t k{0}; k < polygon.size(); k++) {
+      nearest = (std::min)(nearest, std::sqrt(geofence::detail::squaredDistance(p, polygon[k], polygon[(k + 1) % polygon.size()])));
+    }
+    const double d{geofence::signedDistance(polygon, p)};
+    CHECK(geofence::isIn<double>(polygon, p) == std::signbit(d));
+    CHECK(std::abs(std::abs(d) - nearest) < 1e-12);
+    CHECK(d == Approx(batch[i]).epsilon(0));
+    CHECK(d == Approx(chains.signedDistance(p)).epsilon(0));
+  }
+  CHECK(std::signbit(batch.back()));
+  CHECK(0 == Approx(batch.back()).epsilon(0));
+
+  std::vector<double> gx;
+  std::vector<double> gy;
+  for(double y{-1.1}; y < 5; y += 0.5) {
+    for(double x{-1.1}; x < 5; x += 0.5) {
+      gx.push_back(x);
+      gy.push_back(y);
+    }
+  }
+  std::vector<double> evenOdd(gx.size());
+  std::vector<double> nonZero(gx.size());
+  geofence::signedDistances(twice, gx.data(), gy.data(), gx.size(), evenOdd.data());
+  geofence::signedDistances<double, geofence::NonZeroRule>(twice, gx.data(), gy.data(), gx.size(), nonZero.data());
+  geofence::MonotoneChainIndex<double, geofence::NonZeroRule> twiceChains(twice);
+  for(std::size_t i{0}; i < gx.size(); i++) {
+    std::array<double,2> p{{gx[i], gy[i]}};
+    CHECK(geofence::isIn<double>(twice, p) == std::signbit(evenOdd[i]));
+    CHECK(geofence::isIn<double, geofence::NonZeroRule>(twice, p) == std::signbit(nonZero[i]));
+    CHECK(nonZero[i] == Approx(twiceChains.signedDistance(p)).epsilon(0));
+  }
+  CHECK(std::isinf(geofence::signedDistance(std::vector<std::array<double,2>>{{0, 0}, {1, 1}}, std::array<double,2>{{0, 1}})));
+
+  // Integer coordinates use the same crossing arithmetic as isIn.
+  std::vector<std::array<int32_t,2>> square{{0, 0}, {10, 0}, {10, 10}, {0, 10}};
+  const int32_t ix[]{5, 15, 0, 3};
+  const int32_t iy[]{5, 5, 0, 10};
+  double integer[4];
+  geofence::signedDistances(square, ix, iy, 4, integer);
+  CHECK(-5.0 == Approx(integer[0]).epsilon(0));
+  CHECK(5.0 == Approx(integer[1]).epsilon(0));
+  CHECK(std::signbit(integer[2]));
+  for(std::size_t i{0}; i < 4; i++) {
+    std::array<int32_t,2> p{{ix[i], iy[i]}};
+    CHECK(geofence::signedDistance(square, p) == Approx(integer[i]).epsilon(0));
+    CHECK(geofence::isIn<int32_t>(square, p) == std::signbit(integer[i]));
+  }
+}
@@ -0,0 +1,158 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020  Christian Berger
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Compiles polygons from GeoJSON, WKT, or WKB files into a FenceStore that nodes
+// memory-map at startup. Fence IDs follow the order of the polygons in the
+// inputs; invalid polygons keep their ID as empty fences.
+
+#include "geofence.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static void usage() {
+  std::cerr << "Usage: geofence-compile [--threads N] [--format geojson|wkt|wkb] -o OUTPUT INPUT..." << std::endl
+            << "  Reads Polygon and MultiPolygon geometries, normalizes their outer rings," << std::endl
+            << "  and writes a memory-mappable geofence::FenceStore to OUTPUT." << std::endl
+            << "  The format is derived from the file extension unless given." << std::endl;
+}
+
+static bool endsWith(const std::string &s, const std::string &suffix) {
+  return (suffix.size() <= s.size()) && (0 == s.compare(s.size() - suffix.size(), suffix.size(), suffix));
+}
+
+static std::vector<geofence::Polygon> read(const std::string &path, std::string format) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    throw std::runtime_error("cannot open " + path);
+  }
+  std::stringstream content;
+  content << file.rdbuf();
+  if (format.empty()) {
+    format = endsWith(path, ".wkt") ? "wkt" : (endsWith(path, ".wkb") ? "wkb" : "geojson");
+  }
+  if ("wkt" == format) {
+    return geofence::readWkt(content.str());
+  }
+  if ("wkb" == format) {
+    // Concatenated WKB geometries, e.g., exported with ST_AsBinary.
+    const std::string wkb{content.str()};
+    std::vector<geofence::Polygon> polygons;
+    for(const auto &view : geofence::readWkb(wkb.data(), wkb.size())) {
+      geofence::Polygon polygon;
+      for(std::size_t r{0}; r < view.rings.size(); r++) {
+        if (0 == r) {
+          polygon.outer = view.rings[r].copy();
+        }
+        else {
+          polygon.holes.push_back(view.rings[r].copy());
+        }
+      }
+      polygons.push_back(polygon);
+    }
+    return polygons;
+  }
+  if ("geojson" == format) {
+    return geofence::readGeoJson(content.str());
+  }
+  throw std::runtime_error("unknown format " + format);
+}
+
+int main(int argc, char **argv) {
+  std::size_t threads{0};
+  std::string format;
+  std::string output;
+  std::vector<std::string> inputs;
+  for(int i{1}; i < argc; i++) {
+    const std::string arg{argv[i]};
+    if (("--threads" == arg) && (i + 1 < argc)) {
+      threads = static_cast<std::size_t>(std::stoul(argv[++i]));
+    }
+    else if (("--format" == arg) && (i + 1 < argc)) {
+      format = argv[++i];
+    }
+    else if (("-o" == arg) && (i + 1 < argc)) {
+      output = argv[++i];
+    }
+    else if (("-h" == arg) || ("--help" == arg)) {
+      usage();
+      return 0;
+    }
+    else if ('-' == arg[0]) {
+      usage();
+      return 1;
+    }
+    else {
+      inputs.push_back(arg);
+    }
+  }
+  if (output.empty() || inputs.empty()) {
+    usage();
+    return 1;
+  }
+
+  try {
+    std::vector<std::vector<std::array<double,2>>> fences;
+    std::size_t invalid{0};
+    std::size_t holes{0};
+    std::size_t removed{0};
+    for(const auto &input : inputs) {
+      for(auto &polygon : read(input, format)) {
+        const std::size_t before{polygon.outer.size()};
+        if (geofence::normalize(polygon.outer)) {
+          removed += before - polygon.outer.size();
+        }
+        else {
+          std::cerr << "geofence-compile: " << input << ": polygon " << fences.size() << " is invalid and stored empty" << std::endl;
+          polygon.outer.clear();
+          invalid++;
+        }
+        holes += polygon.holes.size();
+        fences.push_back(polygon.outer);
+      }
+    }
+    if (0 < holes) {
+      std::cerr << "geofence-compile: " << holes << " holes ignored; fences are stored as single rings" << std::endl;
+    }
+
+    geofence::ThreadPool pool(threads);
+    const std::vector<uint8_t> store{geofence::FenceStore::build(fences, &pool)};
+    std::ofstream file(output, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(store.data()), static_cast<std::streamsize>(store.size()));
+    if (!file) {
+      throw std::runtime_error("cannot write " + output);
+    }
+    std::cout << output << ": " << fences.size() << " fences (" << invalid << " invalid), "
+              << removed << " repeated vertices removed, " << store.size() << " bytes" << std::endl;
+  }
+  catch(const std::exception &e) {
+    std::cerr << "geofence-compile: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}